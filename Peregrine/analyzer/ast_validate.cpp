@@ -1,11 +1,14 @@
 #include "errors/error.hpp"
 #include "lexer/tokens.hpp"
 #include "ast_validate.hpp"
+#include "tail_call.hpp"
+#include <algorithm>
 #include <map>
 #include <filesystem>
 #include <iostream>
 namespace astValidator{
-std::map<AstKind, std::string> keyword={
+//shared by every validator, nothing changes it once it is built
+static const std::map<AstKind, std::string> keyword={
                                             {KAstPassStatement,"'...'"},
                                             {KAstIfStmt,"'if'"},
                                             {KAstReturnStatement,"'return'"},
@@ -18,7 +21,9 @@ std::map<AstKind, std::string> keyword={
                                             {KAstBreakStatement,"'break'"},
                                             {KAstContinueStatement,"'continue'"},
                                             {KAstRaiseStmt,"'raise'"},
-                                            {KAstTryExcept,"'try"}
+                                            {KAstTryExcept,"'try"},
+                                            {KAstYield,"'yield'"},
+                                            {KAstSpawn,"'spawn'"}
                                             };
 Validator::Validator(AstNodePtr ast,std::string filename,bool is_js,bool should_contain_main){
     m_is_js=is_js;
@@ -26,18 +31,67 @@ Validator::Validator(AstNodePtr ast,std::string filename,bool is_js,bool should_
     m_should_contain_main=should_contain_main;
     ast->accept(*this);
     if(m_errors.size()>0||(m_should_contain_main && !m_has_main)){
-        for(auto& e:m_errors){
-            display(e);
-        }
-        if(m_should_contain_main){
-            if(!m_has_main){
-                std::cout<<"\e[91m"<<"Error: "<<m_filename<<" does not contain a main function"<<"\e[0m"<<std::endl;
-            }
+        throw CompileError(m_errors,m_should_contain_main&&!m_has_main?m_filename+" does not contain a main function":"");
+    }
+}
+//a in a.b.c
+static std::string root_name(AstNodePtr name){
+    while(name->type()==KAstDotExpression){
+        name=std::dynamic_pointer_cast<DotExpression>(name)->owner();
+    }
+    return name->stringify();
+}
+
+//the name of @pure or @const if one of the decorators is it
+static std::string purity(std::vector<AstNodePtr> decorators){
+    for(auto& x:decorators){
+        if(x->type()==KAstIdentifier&&(x->stringify()=="pure"||x->stringify()=="const")){
+            return x->stringify();
         }
-        exit(1);
     }
+    return "";
 }
+
 bool Validator::visit(const Program& node){
+    for (auto& stmt : node.statements()) {
+        if(stmt->type()==KAstVariableStmt){
+            m_globals.push_back(std::dynamic_pointer_cast<VariableStatement>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==KAstFunctionDef){
+            m_functions[std::dynamic_pointer_cast<FunctionDefinition>(stmt)->name()->stringify()]="";
+        }
+        else if(stmt->type()==KAstEnum){
+            m_enums.push_back(std::dynamic_pointer_cast<EnumLiteral>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==KAstClassDef){
+            m_types.push_back(std::dynamic_pointer_cast<ClassDefinition>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==KAstUnion){
+            m_types.push_back(std::dynamic_pointer_cast<UnionLiteral>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==KAstTypeDefinition){
+            m_types.push_back(std::dynamic_pointer_cast<TypeDefinition>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==KAstExternFuncDef){
+            m_extern_owners.push_back(std::dynamic_pointer_cast<ExternFuncDef>(stmt)->owner());
+        }
+        else if(stmt->type()==KAstImportStmt){
+            //import a.b is used as a.b.f(), import a.b as m as m.f()
+            auto import=std::dynamic_pointer_cast<ImportStatement>(stmt);
+            if(import->moduleName()->type()==KAstNoLiteral){
+                for(auto& module:import->importedSymbols()){
+                    m_modules.push_back(root_name(module.second->type()!=KAstNoLiteral?module.second:module.first));
+                }
+            }
+        }
+        else if(stmt->type()==KAstDecorator){
+            auto decorated=std::dynamic_pointer_cast<DecoratorStatement>(stmt);
+            if(decorated->body()->type()==KAstFunctionDef){
+                auto name=std::dynamic_pointer_cast<FunctionDefinition>(decorated->body())->name()->stringify();
+                m_functions[name]=purity(decorated->decoratorItem());
+            }
+        }
+    }
     for (auto& stmt : node.statements()) {
         switch(stmt->type()){
             case KAstTryExcept:
@@ -50,10 +104,12 @@ bool Validator::visit(const Program& node){
             case KAstForStatement:
             case KAstWhileStmt:
             case KAstReturnStatement:
+            case KAstYield:
+            case KAstSpawn:
             case KAstIfStmt:
             case KAstBreakStatement:
             case KAstPassStatement:{
-                add_error(stmt->token(),"SyntaxError: "+keyword[stmt->type()]+" statement outside function",
+                add_error(stmt->token(),"SyntaxError: "+keyword.at(stmt->type())+" statement outside function",
                                         "In Peregrine the program stars executing from the main function and not from the global scope",
                                         "Defining this inside a function");
                 break;
@@ -86,6 +142,18 @@ bool Validator::visit(const Program& node){
                 add_error(stmt->token(), "SyntaxError: Reassignment outside function", "Use it inside a function because data can't be mutated outside a function");
                 break;
             }
+            case KAstDecorator:{
+                auto body=std::dynamic_pointer_cast<DecoratorStatement>(stmt)->body();
+                if(body->type()==KAstForStatement||body->type()==KAstIfStmt){
+                    add_error(body->token(),"SyntaxError: "+keyword.at(body->type())+" statement outside function",
+                                            "In Peregrine the program stars executing from the main function and not from the global scope",
+                                            "Defining this inside a function");
+                }
+                else{
+                    stmt->accept(*this);
+                }
+                break;
+            }
             default:{
                 stmt->accept(*this);
             }
@@ -122,6 +190,11 @@ bool Validator::visit(const BlockStatement& node){
                 add_error(stmt->token(), "SyntaxError: Import statement cant be inside function");
                 break;
             }
+            case KAstAsync:{
+                add_error(stmt->token(), "SyntaxError: Async functions can't be nested",
+                                         "Define it outside the function");
+                break;
+            }
             case KAstStatic:{
                 std::shared_ptr<StaticStatement> x =std::dynamic_pointer_cast<StaticStatement>(stmt);
                 if(x->body()->type()==KAstInline){
@@ -171,7 +244,7 @@ bool Validator::visit(const BlockStatement& node){
             case KAstReturnStatement:{
                 //it is not the last statement
                 if(i<(statements.size()-1)){
-                    add_error(statements[i+1]->token(), "SyntaxError: Anything after "+keyword[stmt->type()]+" statement is not executed","Remove it");
+                    add_error(statements[i+1]->token(), "SyntaxError: Anything after "+keyword.at(stmt->type())+" statement is not executed","Remove it");
                     break;
                 }
             }
@@ -211,8 +284,16 @@ bool Validator::visit(const ClassDefinition& node){
         }
     }
     for (auto& x : node.attributes()){
+        if(x->type()==KAstDecorator){
+            auto field=std::dynamic_pointer_cast<DecoratorStatement>(x);
+            validate_layout(field->decoratorItem(),true);
+            field->body()->accept(*this);
+            continue;
+        }
         x->accept(*this);
     }
+    auto in_class=m_in_class;
+    m_in_class=true;
     for (auto& x : node.methods()){
         auto type=x->type();
         switch (x->type()) {
@@ -253,6 +334,7 @@ bool Validator::visit(const ClassDefinition& node){
             }
         }
     }
+    m_in_class=in_class;
     return true;
 }
 bool Validator::visit(const ImportStatement& node){
@@ -279,7 +361,85 @@ bool Validator::visit(const FunctionDefinition& node){
         m_has_main=true;
     }
     node.name()->accept(*this);
+    bool is_generator=containsYield(node.body());
+    if(is_generator){
+        if(m_async_function){
+            add_error(node.name()->token(),"Error: Async functions can't yield");
+        }
+        else if(name=="main"){
+            add_error(node.name()->token(),"Error: The main function can't yield");
+        }
+        else if(is_static_class_member||(m_in_function&&!m_is_js)){
+            add_error(node.name()->token(),"Error: Only functions defined at the global scope can yield",
+                                            "The generator is compiled to a struct that keeps its locals between the values");
+        }
+        if(node.returnType()->stringify()=="void"){
+            add_error(node.name()->token(),"Error: Generators must declare the type of the values they yield",
+                                            "",
+                                            "def "+name+"(...)->int:");
+        }
+        else if(node.returnType()->type()==KAstTypeTuple){
+            add_error(node.returnType()->token(),"Error: Generators can't yield multiple values");
+        }
+        for(auto& param:node.parameters()){
+            if(!m_is_js && (param.p_type->type()==KAstNoLiteral||param.p_paramType!=Normal)){
+                add_error(param.p_name->token(),"Error: Parameters of a generator need a type",
+                                                "They are kept as members of the generator");
+            }
+        }
+    }
+    else if(m_is_generator&&!m_is_js){
+        add_error(node.name()->token(),"Error: Functions can't be defined inside a generator",
+                                        "Define it at the global scope");
+    }
+    //a function defined inside a parallel loop has its own locals
+    auto parallel_locals=m_parallel_locals;
+    auto parallel_loop_depth=m_parallel_loop_depth;
+    auto is_async=m_is_async;
+    auto in_function=m_in_function;
+    auto generator=m_is_generator;
+    auto scopes=m_scopes;
+    //a function nested in a pure one is held to the same rules
+    auto purity=m_purity;
+    auto pure_locals=m_pure_locals;
+    if(m_next_purity!=""){
+        m_purity=m_next_purity;
+        m_next_purity="";
+    }
+    auto runtime_objects=m_runtime_objects;
+    for(auto& param:node.parameters()){
+        m_pure_locals.push_back(param.p_name->stringify());
+        m_runtime_objects.erase(param.p_name->stringify());
+        declare_runtime_object(param.p_name,param.p_type,param.p_default);
+    }
+    auto tailrec=m_tailrec;
+    auto tail_calls=m_tail_calls;
+    if(m_next_tailrec){
+        m_next_tailrec=false;
+        validate_tailrec(node);
+    }
+    m_parallel_locals.clear();
+    m_is_async=m_async_function;
+    m_async_function=false;
+    m_in_function=true;
+    m_is_generator=is_generator;
+    m_scopes=0;
     node.body()->accept(*this);
+    m_purity=purity;
+    m_pure_locals=pure_locals;
+    if(m_purity!=""&&in_function){
+        //it is held to the same rules, so it can be called
+        m_pure_locals.push_back(name);
+    }
+    m_runtime_objects=runtime_objects;
+    m_tailrec=tailrec;
+    m_tail_calls=tail_calls;
+    m_parallel_locals=parallel_locals;
+    m_parallel_loop_depth=parallel_loop_depth;
+    m_is_async=is_async;
+    m_in_function=in_function;
+    m_is_generator=generator;
+    m_scopes=scopes;
     if(is_static_class_member){
         if(node.parameters().size()==0){
             add_error(node.name()->token(),"Error: Non static Methods defined in a class must have atleast one parameter to take in the instance of the object");
@@ -298,9 +458,26 @@ bool Validator::visit(const FunctionDefinition& node){
     return true;
 }
 bool Validator::visit(const VariableStatement& node){
+    if(m_purity!=""){
+        if(node.varType()->type()!=KAstNoLiteral&&node.name()->type()==KAstIdentifier){
+            m_pure_locals.push_back(node.name()->stringify());
+        }
+        else{
+            check_pure_write(node.name(),true);
+        }
+    }
+    if(m_parallel_locals.size()>0){
+        if(node.varType()->type()==KAstNoLiteral){
+            check_parallel_write(node.name());
+        }
+        else if(node.name()->type()==KAstIdentifier){
+            m_parallel_locals.back().push_back(std::dynamic_pointer_cast<IdentifierExpression>(node.name())->value());
+        }
+    }
     node.name()->accept(*this);
     node.value()->accept(*this);
     node.varType()->accept(*this);
+    declare_runtime_object(node.name(),node.varType(),node.value());
     return true;
 }
 bool Validator::visit(const ConstDeclaration& node){
@@ -327,6 +504,10 @@ bool Validator::visit(const IfStatement& node){
     return true;
 }
 bool Validator::visit(const AssertStatement& node){
+    if(m_purity!=""){
+        add_error(node.token(),"Error: A @"+m_purity+" function can't assert",
+                               "A failed assert raises, calls of it may be left out or merged");
+    }
     node.condition()->accept(*this);
     return true;
 }
@@ -371,18 +552,34 @@ bool Validator::visit(const ExportStatement& node){
     return true;
 }
 bool Validator::visit(const RaiseStatement& node){
+    if(m_purity!=""){
+        add_error(node.token(),"Error: A @"+m_purity+" function can't raise",
+                               "Calls of it may be left out or merged, so the error would not always be raised");
+    }
     node.value()->accept(*this);
     return true;
 }
 bool Validator::visit(const WhileStatement& node){
     node.condition()->accept(*this);
+    m_parallel_loop_depth++;
     node.body()->accept(*this);
+    m_parallel_loop_depth--;
     return true;
 }
 bool Validator::visit(const ForStatement& node){
     node.sequence()->accept(*this);
-    node.body()->accept(*this);
     auto var=node.variable();
+    for(auto& x:var){
+        m_pure_locals.push_back(x->stringify());
+    }
+    if(m_parallel_locals.size()>0){
+        for(auto& x:var){
+            m_parallel_locals.back().push_back(std::dynamic_pointer_cast<IdentifierExpression>(x)->value());
+        }
+    }
+    m_parallel_loop_depth++;
+    node.body()->accept(*this);
+    m_parallel_loop_depth--;
     for(auto& x:var){
         x->accept(*this);
     }
@@ -403,17 +600,213 @@ bool Validator::visit(const MatchStatement& node){
     return true;
 }
 bool Validator::visit(const ScopeStatement& node){
+    m_scopes++;
     node.body()->accept(*this);
+    m_scopes--;
     return true;
 }
 bool Validator::visit(const ReturnStatement& node){
+    if(m_parallel_locals.size()>0){
+        add_error(node.token(),"Error: Can't return from a parallel loop",
+                                "The iterations run on different threads, so there is no single iteration that could return");
+    }
+    if(m_is_generator && node.returnValue()->type()!=KAstNoLiteral){
+        add_error(node.token(),"Error: 'return' with a value inside a generator",
+                               "A generator hands out its values with yield, return only ends it",
+                               "Use yield followed by return");
+    }
     node.returnValue()->accept(*this);
     return true;
 }
 bool Validator::visit(const ContinueStatement& node){return true;}
-bool Validator::visit(const BreakStatement& node){return true;}
+bool Validator::visit(const BreakStatement& node){
+    if(m_parallel_locals.size()>0 && m_parallel_loop_depth==0){
+        add_error(node.token(),"Error: Can't break out of a parallel loop",
+                                "The iterations run at the same time, so the ones after this have already started");
+    }
+    return true;
+}
+void Validator::check_parallel_write(AstNodePtr name){
+    //writes through a subscript or a member are the usual way of storing
+    //the result of an iteration, only plain names are checked
+    if(name->type()!=KAstIdentifier){
+        return;
+    }
+    auto x=std::dynamic_pointer_cast<IdentifierExpression>(name)->value();
+    auto& locals=m_parallel_locals.back();
+    if(std::find(locals.begin(),locals.end(),x)==locals.end()){
+        add_error(name->token(),"Error: Data race on '"+x+"' in a parallel loop",
+                                "It is defined outside the loop and every iteration writes to it at the same time",
+                                "Define it inside the loop or use a reduction like @parallel(sum="+x+")");
+    }
+}
+//a pure function can only change its own locals and parameters, which are
+//copies. declares is true for name=value, which defines name if it is new
+void Validator::check_pure_write(AstNodePtr name,bool declares){
+    switch(name->type()){
+        case KAstIdentifier:{
+            auto x=std::dynamic_pointer_cast<IdentifierExpression>(name)->value();
+            if(std::count(m_pure_locals.begin(),m_pure_locals.end(),x)){
+                return;
+            }
+            if(std::count(m_globals.begin(),m_globals.end(),x)){
+                add_error(name->token(),"Error: A @"+m_purity+" function can't change the global variable '"+x+"'",
+                                        "Calls of it may be left out or merged, so the change would not always happen");
+            }
+            else if(declares){
+                m_pure_locals.push_back(x);
+            }
+            return;
+        }
+        case KAstDotExpression:{
+            check_pure_write(std::dynamic_pointer_cast<DotExpression>(name)->owner());
+            return;
+        }
+        case KAstListOrDictAccess:{
+            check_pure_write(std::dynamic_pointer_cast<ListOrDictAccess>(name)->container());
+            return;
+        }
+        case KAstArrowExpression:
+        case KAstPrefixExpr:{
+            add_error(name->token(),"Error: A @"+m_purity+" function can't write through a pointer",
+                                    "What it points to is outside of the function");
+            return;
+        }
+        default:{}
+    }
+}
+
+//the lazy iterators of lib/iter.hpp and the branch hints
+static const char* pure_builtins[]={"range","span","map","filter","take","enumerate","zip","reduce","sum","count",
+                                    "likely","unlikely"};
+
+//only functions that are at least as pure can be called
+void Validator::check_pure_call(const FunctionCall& node){
+    if(node.name()->type()!=KAstIdentifier){
+        return;
+    }
+    auto name=node.name()->stringify();
+    if(name=="print"||name=="printf"){
+        add_error(node.name()->token(),"Error: A @"+m_purity+" function can't print",
+                                       "Calls of it may be left out or merged, so the output would not always be written");
+        return;
+    }
+    if(std::count(m_pure_locals.begin(),m_pure_locals.end(),name)||std::count(m_types.begin(),m_types.end(),name)||
+        std::count(std::begin(pure_builtins),std::end(pure_builtins),name)){
+        return;
+    }
+    auto function=m_functions.find(name);
+    if(function==m_functions.end()){
+        add_error(node.name()->token(),"Error: A @"+m_purity+" function can't call '"+name+"'",
+                                       "It is not defined in this file, so nothing is known about what it does");
+        return;
+    }
+    if(function->second==""||(m_purity=="const"&&function->second=="pure")){
+        add_error(node.name()->token(),"Error: A @"+m_purity+" function can't call '"+name+"'",
+                                       "",
+                                       m_purity=="const"?"Decorate "+name+" with @const":"Decorate "+name+" with @pure or @const");
+    }
+}
+
+void Validator::validate_parallel_loop(const DecoratorStatement& node){
+    auto loop=std::dynamic_pointer_cast<ForStatement>(node.body());
+    auto decorators=node.decoratorItem();
+    std::vector<std::string> owned;
+    AstNodePtr decorator=decorators[0];
+    if(m_is_js){
+        add_error(node.token(),"SyntaxError: Parallel loops are not allowed in javascript");
+    }
+    if(decorator->type()==KAstFunctionCall){
+        auto call=std::dynamic_pointer_cast<FunctionCall>(decorator);
+        decorator=call->name();
+        for(auto& arg:call->arguments()){
+            if(arg->type()!=KAstDefaultArg){
+                add_error(arg->token(),"Error: Options of @parallel must be given by name",
+                                        "","@parallel(chunk=64,sum=total)");
+                continue;
+            }
+            auto option=std::dynamic_pointer_cast<DefaultArg>(arg);
+            auto name=option->name()->stringify();
+            option->value()->accept(*this);
+            if(name=="chunk"){
+                continue;
+            }
+            if(name!="sum"&&name!="product"&&name!="min"&&name!="max"){
+                add_error(option->name()->token(),"Error: Unknown option '"+name+"' of @parallel",
+                                                  "It takes chunk=<iterations per task> and reductions as sum=, product=, min= or max=");
+            }
+            else if(option->value()->type()!=KAstIdentifier){
+                add_error(option->value()->token(),"Error: Only variables can be reduced");
+            }
+            else{
+                owned.push_back(std::dynamic_pointer_cast<IdentifierExpression>(option->value())->value());
+            }
+        }
+    }
+    if(decorators.size()!=1||decorator->type()!=KAstIdentifier||
+        std::dynamic_pointer_cast<IdentifierExpression>(decorator)->value()!="parallel"){
+        add_error(node.token(),"Error: A for loop can only be decorated with @parallel");
+        return;
+    }
+    if(loop->variable().size()!=1){
+        add_error(loop->token(),"Error: A parallel loop takes a single loop variable");
+    }
+    auto sequence=loop->sequence();
+    if(sequence->type()==KAstFunctionCall){
+        auto call=std::dynamic_pointer_cast<FunctionCall>(sequence);
+        if(call->name()->stringify()=="range"&&(call->arguments().size()<1||call->arguments().size()>2)){
+            add_error(sequence->token(),"Error: range() of a parallel loop takes a stop or a start and a stop");
+        }
+    }
+    sequence->accept(*this);
+    for(auto& x:loop->variable()){
+        owned.push_back(std::dynamic_pointer_cast<IdentifierExpression>(x)->value());
+        x->accept(*this);
+    }
+    auto parallel_loop_depth=m_parallel_loop_depth;
+    auto is_async=m_is_async;
+    auto scopes=m_scopes;
+    m_parallel_loop_depth=0;
+    m_is_async=false;//the iterations run in a lambda, it can't be suspended
+    m_scopes=0;//and they can't spawn into a scope of another thread
+    m_parallel_locals.push_back(owned);
+    loop->body()->accept(*this);
+    m_parallel_locals.pop_back();
+    m_parallel_loop_depth=parallel_loop_depth;
+    m_is_async=is_async;
+    m_scopes=scopes;
+}
 bool Validator::visit(const DecoratorStatement& node){
+    if(node.body()->type()==KAstForStatement){
+        validate_parallel_loop(node);
+        return true;
+    }
     switch (node.body()->type()){
+        case KAstIfStmt:{
+            auto decorators=node.decoratorItem();
+            if(decorators.size()!=1||decorators[0]->type()!=KAstIdentifier||
+                (decorators[0]->stringify()!="likely"&&decorators[0]->stringify()!="unlikely")){
+                add_error(decorators[0]->token(),"Error: An if can only be decorated with @likely or @unlikely",
+                                                 "Use likely(...) or unlikely(...) on the condition of an elif");
+            }
+            node.body()->accept(*this);
+            return true;
+        }
+        case KAstClassDef:{
+            validate_layout(node.decoratorItem());
+            node.body()->accept(*this);
+            return true;
+        }
+        case KAstExternStruct:{
+            add_error(node.body()->token(),"Error: The layout of an external struct can't be changed",
+                                            "It has to match the definition in the library");
+            return true;
+        }
+        case KAstVariableStmt:
+        case KAstConstDecl:{
+            add_error(node.body()->token(),"Error: Only the fields of a class can be decorated");
+            return true;
+        }
         case KAstMethodDef:{
             add_error(node.body()->token(),"Error: Method that is modifying a type can't be decorated",
                                             "Define a regular function instead");
@@ -425,15 +818,230 @@ bool Validator::visit(const DecoratorStatement& node){
             break;
         }
         default:{
+            auto decorators=node.decoratorItem();
+            m_next_purity=purity(decorators);
+            m_next_tailrec=std::any_of(decorators.begin(),decorators.end(),[](AstNodePtr x){
+                return x->type()==KAstIdentifier&&x->stringify()=="tailrec";
+            });
             node.body()->accept(*this);
+            m_next_purity="";
+            m_next_tailrec=false;
         }
     }
+    validate_function_attributes(node);
     auto x=node.decoratorItem();
     for (auto& y:x){
+        auto name=y->type()==KAstFunctionCall?std::dynamic_pointer_cast<FunctionCall>(y)->name():y;
+        if(name->type()==KAstIdentifier&&(name->stringify()=="align"||name->stringify()=="padded")){
+            add_error(y->token(),"Error: @"+name->stringify()+" can only be used on classes and their fields");
+        }
         y->accept(*this);
     }
     return true;
 }
+
+//@align(N) aligns a class or a field to N bytes, @padded gives it a cache
+//line of its own so that threads writing next to it dont share the line
+//@hot only tells -reorder-fields which fields to put first
+void Validator::validate_layout(std::vector<AstNodePtr> decorators,bool is_field){
+    for(auto& x:decorators){
+        if(m_is_js){
+            add_error(x->token(),"SyntaxError: Alignment is not available in javascript");
+            return;
+        }
+        if(x->type()==KAstIdentifier && x->stringify()=="padded"){
+            continue;
+        }
+        if(is_field && x->type()==KAstIdentifier && x->stringify()=="hot"){
+            continue;
+        }
+        if(x->type()==KAstFunctionCall){
+            auto call=std::dynamic_pointer_cast<FunctionCall>(x);
+            if(call->name()->type()==KAstIdentifier && call->name()->stringify()=="align"){
+                auto args=call->arguments();
+                if(args.size()!=1||args[0]->type()!=KAstInteger){
+                    add_error(x->token(),"SyntaxError: @align takes the alignment in bytes","","@align(64)");
+                    continue;
+                }
+                auto literal=std::dynamic_pointer_cast<IntegerLiteral>(args[0])->value();
+                auto value=literal.size()<10?std::stoll(literal,nullptr,0):0;
+                if(value<=0||(value&(value-1))!=0){
+                    add_error(args[0]->token(),"Error: The alignment has to be a power of 2");
+                }
+                continue;
+            }
+            if(call->name()->type()==KAstIdentifier && call->name()->stringify()=="padded"){
+                add_error(x->token(),"SyntaxError: @padded takes no arguments","","@padded");
+                continue;
+            }
+        }
+        if(is_field){
+            add_error(x->token(),"Error: Fields can only be decorated with @align, @padded or @hot");
+        }
+        else{
+            add_error(x->token(),"Error: Classes can only be decorated with @align or @padded");
+        }
+    }
+}
+//@target_clones("avx2","default"), @pure, @const, @hot, @cold and @tailrec
+//change how a function is compiled instead of wrapping it, so they need a
+//function that the backends keep as one
+void Validator::validate_function_attributes(const DecoratorStatement& node){
+    auto decorators=node.decoratorItem();
+    std::string attribute;
+    size_t attributes=0;
+    for(auto& x:decorators){
+        auto name=x->type()==KAstFunctionCall?std::dynamic_pointer_cast<FunctionCall>(x)->name():x;
+        if(name->type()!=KAstIdentifier){
+            continue;
+        }
+        if(node.body()->type()!=KAstIfStmt&&(name->stringify()=="likely"||name->stringify()=="unlikely")){
+            add_error(x->token(),"Error: @"+name->stringify()+" can only decorate an if",
+                                 "Use @hot or @cold to say how often a function is called");
+            continue;
+        }
+        if(name->stringify()=="pure"||name->stringify()=="const"||name->stringify()=="hot"||name->stringify()=="cold"||
+           name->stringify()=="tailrec"){
+            attribute=name->stringify();
+            attributes++;
+            if(x->type()==KAstFunctionCall){
+                add_error(x->token(),"SyntaxError: @"+attribute+" takes no arguments","","@"+attribute);
+            }
+            continue;
+        }
+        if(name->stringify()=="cache"){
+            attribute="cache";
+            attributes++;
+            continue;
+        }
+        if(name->stringify()!="target_clones"){
+            continue;
+        }
+        attribute="target_clones";
+        attributes++;
+        if(x->type()!=KAstFunctionCall||std::dynamic_pointer_cast<FunctionCall>(x)->arguments().size()==0){
+            add_error(x->token(),"SyntaxError: @target_clones takes the instruction sets to compile the function for",
+                                 "","@target_clones(\"avx2\",\"avx512f\",\"default\")");
+            continue;
+        }
+        for(auto& arg:std::dynamic_pointer_cast<FunctionCall>(x)->arguments()){
+            if(arg->type()!=KAstString){
+                add_error(arg->token(),"SyntaxError: The instruction sets of @target_clones are strings",
+                                       "","@target_clones(\"avx2\",\"avx512f\",\"default\")");
+            }
+        }
+    }
+    if(attributes==0){
+        return;
+    }
+    if(attributes!=decorators.size()){
+        add_error(node.token(),"Error: @"+attribute+" can't be combined with decorators that wrap the function");
+    }
+    if(purity(decorators)!=""&&std::count_if(decorators.begin(),decorators.end(),[](AstNodePtr x){
+        return x->type()==KAstIdentifier&&(x->stringify()=="pure"||x->stringify()=="const");
+    })>1){
+        add_error(node.token(),"Error: A function is either @pure or @const","@const already implies @pure");
+    }
+    if(std::count_if(decorators.begin(),decorators.end(),[](AstNodePtr x){
+        return x->type()==KAstIdentifier&&(x->stringify()=="hot"||x->stringify()=="cold");
+    })>1){
+        add_error(node.token(),"Error: A function is either @hot or @cold");
+    }
+    auto cache=std::find_if(decorators.begin(),decorators.end(),[](AstNodePtr x){
+        auto name=x->type()==KAstFunctionCall?std::dynamic_pointer_cast<FunctionCall>(x)->name():x;
+        return name->type()==KAstIdentifier&&name->stringify()=="cache";
+    });
+    auto body=node.body();
+    if(body->type()!=KAstFunctionDef||m_in_function||m_in_class){
+        add_error(node.token(),"Error: @"+attribute+" can only be used on functions defined at the global scope",
+                               m_in_class&&!m_in_function?"Methods are not compiled with it":"",
+                               m_in_class&&!m_in_function?"Move the work into a global function that the method calls":"");
+        return;
+    }
+    auto function=std::dynamic_pointer_cast<FunctionDefinition>(body);
+    if(function->name()->stringify()=="main"){
+        add_error(function->name()->token(),"Error: The main function can't be decorated with @"+attribute);
+    }
+    else if(containsYield(function->body())){
+        add_error(function->name()->token(),"Error: Generators can't be decorated with @"+attribute);
+    }
+    if(cache!=decorators.end()){
+        validate_cache(*cache,*function);
+        if(std::any_of(decorators.begin(),decorators.end(),[](AstNodePtr x){
+            return x->type()==KAstIdentifier&&x->stringify()=="tailrec";
+        })){
+            add_error(node.token(),"Error: A @cache function can't be @tailrec",
+                                   "Its calls to itself have to go through the cache");
+        }
+    }
+    if(purity(decorators)==""){
+        return;
+    }
+    if(function->returnType()->stringify()=="void"){
+        add_error(function->name()->token(),"Error: A @"+purity(decorators)+" function has to return a value",
+                                            "Calling it has no effect otherwise");
+    }
+    if(purity(decorators)=="const"){
+        for(auto& param:function->parameters()){
+            if(param.p_type->type()==KAstPointerTypeExpr){
+                add_error(param.p_name->token(),"Error: A @const function can't take pointers",
+                                                "Its result may only depend on the values of its arguments","Use @pure instead");
+            }
+        }
+    }
+}
+//@cache keeps a table from the arguments to the result, so the function needs
+//one result and arguments that can be hashed as they are
+void Validator::validate_cache(AstNodePtr decorator,const FunctionDefinition& function){
+    if(decorator->type()==KAstFunctionCall){
+        auto args=std::dynamic_pointer_cast<FunctionCall>(decorator)->arguments();
+        auto size=args.size()==1?args[0]:nullptr;
+        if(size&&size->type()==KAstDefaultArg&&std::dynamic_pointer_cast<DefaultArg>(size)->name()->stringify()=="maxsize"){
+            size=std::dynamic_pointer_cast<DefaultArg>(size)->value();
+        }
+        if(!size||size->type()!=KAstInteger){
+            add_error(decorator->token(),"SyntaxError: @cache takes the number of results it keeps",
+                                         "Without it every result is kept","@cache(maxsize=128)");
+        }
+        else if(std::stoll(std::dynamic_pointer_cast<IntegerLiteral>(size)->value(),nullptr,0)<=0){
+            add_error(size->token(),"Error: The maxsize of a @cache has to be positive");
+        }
+    }
+    if(function.returnType()->stringify()=="void"||function.returnType()->type()==KAstTypeTuple){
+        add_error(function.name()->token(),"Error: A @cache function has to return one value");
+    }
+    static const std::vector<std::string> hashable={"int","i8","i16","i32","i64","uint","u8","u16","u32","u64",
+                                                    "float","f32","f64","bool","char"};
+    for(auto& param:function.parameters()){
+        auto type=param.p_type;
+        bool valid=param.p_paramType==Normal&&type->type()==KAstTypeExpr;
+        if(valid){
+            auto value=std::dynamic_pointer_cast<TypeExpression>(type)->value();
+            valid=std::find(hashable.begin(),hashable.end(),value)!=hashable.end()||
+                  std::find(m_enums.begin(),m_enums.end(),value)!=m_enums.end();
+        }
+        if(!valid){
+            add_error(param.p_name->token(),"TypeError: The parameter "+param.p_name->stringify()+" of a @cache function can't be hashed",
+                                            "The arguments of a cached function are the key of its table, they can be numbers, bools, chars and enums");
+        }
+    }
+}
+//a @tailrec function has to become a loop, so every call of it to itself
+//has to be a tail call
+void Validator::validate_tailrec(const FunctionDefinition& node){
+    auto name=node.name()->stringify();
+    auto reason=tailCall::ineligible(node);
+    if(reason!=""){
+        add_error(node.name()->token(),"Error: The @tailrec function "+name+" can't become a loop because "+reason);
+        return;
+    }
+    m_tailrec=name;
+    m_tail_calls=tailCall::tailCalls(node);
+    if(m_tail_calls.size()==0){
+        add_error(node.name()->token(),"Error: The @tailrec function "+name+" has no tail call of itself",
+                                       "","return "+name+"(...)");
+    }
+}
 bool Validator::visit(const ListLiteral& node){
     for (auto& x:node.elements()){
         x->accept(*this);
@@ -460,6 +1068,16 @@ bool Validator::visit(const BinaryOperation& node){
     return true;
 }
 bool Validator::visit(const PrefixExpression& node){
+    if(m_parallel_locals.size()>0&&(node.prefix().tkType==tk_increment||node.prefix().tkType==tk_decrement)){
+        check_parallel_write(node.right());
+    }
+    if(m_purity!=""&&(node.prefix().tkType==tk_increment||node.prefix().tkType==tk_decrement)){
+        check_pure_write(node.right());
+    }
+    if(m_purity=="const"&&node.prefix().tkType==tk_multiply){
+        add_error(node.prefix(),"Error: A @const function can't read through a pointer",
+                                "Its result may only depend on the values of its arguments","Use @pure instead");
+    }
     node.right()->accept(*this);
     if(m_is_js){ 
         if(node.prefix().tkType==tk_ampersand||node.prefix().tkType==tk_multiply){
@@ -469,10 +1087,34 @@ bool Validator::visit(const PrefixExpression& node){
     return true;
 }
 bool Validator::visit(const PostfixExpression& node){
+    if(m_parallel_locals.size()>0){
+        check_parallel_write(node.left());
+    }
+    if(m_purity!=""){
+        check_pure_write(node.left());
+    }
     node.left()->accept(*this);
     return true;
 }
 bool Validator::visit(const FunctionCall& node){
+    if(m_purity!=""&&&node!=m_method_call){
+        check_pure_call(node);
+    }
+    if(m_tailrec!=""&&node.name()->type()==KAstIdentifier&&node.name()->stringify()==m_tailrec&&
+        std::find(m_tail_calls.begin(),m_tail_calls.end(),&node)==m_tail_calls.end()){
+        add_error(node.token(),"Error: This call of the @tailrec function "+m_tailrec+" is not a tail call",
+                               "Only a call that is returned right away, with its arguments in order, becomes a jump",
+                               "return "+node.stringify());
+    }
+    //likely(x) and unlikely(x) become __builtin_expect, unless a function of
+    //the same name hides them
+    auto name=node.name()->stringify();
+    if(node.name()->type()==KAstIdentifier&&(name=="likely"||name=="unlikely")&&!m_functions.contains(name)&&
+        node.arguments().size()!=1){
+        add_error(node.token(),"Error: "+name+" takes exactly one argument, "+std::to_string(node.arguments().size())+" were given",
+                               "It is the condition that "+(name=="likely"?std::string("usually holds"):"rarely holds"),
+                               name+"(x>0)");
+    }
     node.name()->accept(*this);
     for (auto& x:node.arguments()){
         x->accept(*this);
@@ -480,13 +1122,34 @@ bool Validator::visit(const FunctionCall& node){
     return true;
 }
 bool Validator::visit(const DotExpression& node){
+    if(m_purity!=""&&node.referenced()->type()==KAstFunctionCall){
+        //a local or parameter hides an extern owner or a module
+        auto owner=root_name(node.owner());
+        bool local=std::count(m_pure_locals.begin(),m_pure_locals.end(),owner);
+        if(!local&&node.owner()->type()==KAstIdentifier&&std::count(m_extern_owners.begin(),m_extern_owners.end(),owner)){
+            add_error(node.token(),"Error: A @"+m_purity+" function can't call the extern function '"+node.stringify()+"'",
+                                   "Nothing is known about what it does");
+        }
+        else if(!local&&std::count(m_modules.begin(),m_modules.end(),owner)){
+            add_error(node.token(),"Error: A @"+m_purity+" function can't call '"+node.stringify()+"'",
+                                   "It is not defined in this file, so nothing is known about what it does");
+        }
+        else{
+            //the method may change the object it is called on
+            check_pure_write(node.owner());
+        }
+    }
+    check_runtime_method(node.owner(),node.referenced());
     node.owner()->accept(*this);
     switch(node.referenced()->type()){
         case KAstIdentifier:
         case KAstCompileTimeExpression:
         case KAstFunctionCall:
+        case KAstListOrDictAccess://ps.x[i]
         case KAstArrowExpression:
         case KAstDotExpression:{
+            //the call in obj.method() is not one of the global functions
+            m_method_call=node.referenced().get();
             node.referenced()->accept(*this);
             break;
         }
@@ -498,6 +1161,11 @@ bool Validator::visit(const DotExpression& node){
     return true;
 }
 bool Validator::visit(const ArrowExpression& node){
+    if(m_purity=="const"){
+        add_error(node.token(),"Error: A @const function can't read through a pointer",
+                               "Its result may only depend on the values of its arguments","Use @pure instead");
+    }
+    check_runtime_method(node.owner(),node.referenced());
     node.owner()->accept(*this);
     switch(node.referenced()->type()){
         case KAstIdentifier:
@@ -515,13 +1183,173 @@ bool Validator::visit(const ArrowExpression& node){
     }
     return true;
 }
-bool Validator::visit(const IdentifierExpression& node){return true;}
+bool Validator::visit(const IdentifierExpression& node){
+    auto name=node.value();
+    if(m_purity=="const"&&std::count(m_globals.begin(),m_globals.end(),name)&&
+        !std::count(m_pure_locals.begin(),m_pure_locals.end(),name)){
+        add_error(node.token(),"Error: A @const function can't read the global variable '"+name+"'",
+                               "Its result may only depend on the values of its arguments","Use @pure instead");
+    }
+    return true;
+}
 bool Validator::visit(const TypeExpression& node){
+    validate_generic_types(node.token(),node.value(),node.generic_types());
     for (auto& x:node.generic_types()){
         x->accept(*this);
     }
     return true;
 }
+
+//channel{T}, spsc_channel{T} and atomic{T} of lib/channel.hpp,
+//soa_list{T} of lib/soa.hpp and vec{T,N} of lib/simd.hpp
+void Validator::validate_generic_types(Token tok,std::string name,std::vector<AstNodePtr> types){
+    if(name=="vec"){
+        validate_vector_type(tok,types);
+        return;
+    }
+    if(name!="channel"&&name!="spsc_channel"&&name!="atomic"&&name!="soa_list"){
+        return;
+    }
+    if(m_is_js){
+        add_error(tok, "SyntaxError: "+name+" is not available in javascript");
+        return;
+    }
+    if(types.size()!=1){
+        add_error(tok, "SyntaxError: "+name+" takes exactly one type","",name+"{int}");
+        return;
+    }
+    if(name=="soa_list"){
+        if(types[0]->type()!=KAstTypeExpr){
+            add_error(types[0]->token(), "TypeError: soa_list only holds classes","",name+"{Particle}");
+        }
+        return;
+    }
+    if(name!="atomic"){
+        return;
+    }
+    static const std::vector<std::string> integers={"int","i8","i16","i32","i64","uint","u8","u16","u32","u64","bool"};
+    auto type=types[0];
+    bool valid=type->type()==KAstPointerTypeExpr;
+    if(type->type()==KAstTypeExpr){
+        auto value=std::dynamic_pointer_cast<TypeExpression>(type)->value();
+        valid=std::find(integers.begin(),integers.end(),value)!=integers.end();
+    }
+    if(!valid){
+        add_error(type->token(), "TypeError: atomic only holds integers and pointers","",name+"{int} or "+name+"{*T}");
+    }
+}
+//a name declared as a channel or atomic, or as anything else that hides one
+void Validator::declare_runtime_object(AstNodePtr name,AstNodePtr type,AstNodePtr value){
+    if(name->type()!=KAstIdentifier){
+        return;
+    }
+    auto x=name->stringify();
+    if(type->type()==KAstRefTypeExpr){
+        type=std::dynamic_pointer_cast<RefTypeExpr>(type)->baseType();
+    }
+    else if(type->type()==KAstPointerTypeExpr){
+        type=std::dynamic_pointer_cast<PointerTypeExpr>(type)->baseType();
+    }
+    if(value->type()==KAstFunctionCall){
+        value=std::dynamic_pointer_cast<FunctionCall>(value)->name();
+    }
+    if(type->type()==KAstNoLiteral&&value->type()==KAstGenericCall){
+        //ch=channel{int}(16)
+        auto call=std::dynamic_pointer_cast<GenericCall>(value);
+        type=std::make_shared<TypeExpression>(call->token(),call->identifier()->stringify(),call->generic_types());
+    }
+    auto runtime_type=std::dynamic_pointer_cast<TypeExpression>(type);
+    if(runtime_type&&runtime_type->generic_types().size()==1&&(runtime_type->value()=="channel"||
+        runtime_type->value()=="spsc_channel"||runtime_type->value()=="atomic")){
+        m_runtime_objects[x]=runtime_type;
+    }
+    else if(type->type()!=KAstNoLiteral||value->type()==KAstNoLiteral){
+        m_runtime_objects.erase(x);
+    }
+}
+
+//whether a literal argument can be converted to the element type, anything
+//else is left to the c++ compiler
+static bool fits(AstNodePtr arg,AstNodePtr elem){
+    static const std::vector<std::string> integers={"int","i8","i16","i32","i64","uint","u8","u16","u32","u64"};
+    static const std::vector<std::string> decimals={"float","f32","f64","f128"};
+    auto kind=arg->type();
+    if(kind!=KAstInteger&&kind!=KAstDecimal&&kind!=KAstString&&kind!=KAstBool){
+        return true;
+    }
+    if(elem->type()!=KAstTypeExpr){
+        return false;
+    }
+    auto name=std::dynamic_pointer_cast<TypeExpression>(elem)->value();
+    bool integer=std::count(integers.begin(),integers.end(),name);
+    bool decimal=std::count(decimals.begin(),decimals.end(),name);
+    switch(kind){
+        case KAstInteger:return integer||decimal;
+        case KAstDecimal:return decimal;
+        case KAstString:return name=="str";
+        default:return name=="bool";
+    }
+}
+
+//the methods of lib/channel.hpp and what their arguments are, T is the
+//element type and n a number
+void Validator::check_runtime_method(AstNodePtr owner,AstNodePtr referenced){
+    static const std::map<std::string,std::vector<std::string>> channel_methods={
+        {"send",{"T"}},{"try_send",{"T"}},{"receive",{}},{"try_receive",{"*T"}},
+        {"close",{}},{"closed",{}},{"capacity",{}},
+    };
+    static const std::map<std::string,std::vector<std::string>> atomic_methods={
+        {"load",{}},{"store",{"T"}},{"exchange",{"T"}},{"compare_exchange",{"T","T"}},
+        {"fetch_add",{"n"}},{"fetch_sub",{"n"}},
+    };
+    if(owner->type()!=KAstIdentifier||!m_runtime_objects.count(owner->stringify())){
+        return;
+    }
+    auto type=m_runtime_objects[owner->stringify()];
+    auto& methods=type->value()=="atomic"?atomic_methods:channel_methods;
+    auto call=std::dynamic_pointer_cast<FunctionCall>(referenced);
+    auto name=call?call->name()->stringify():referenced->stringify();
+    auto method=methods.find(name);
+    if(!call||method==methods.end()){
+        add_error(referenced->token(),"TypeError: "+name+" is not a method of "+type->stringify());
+        return;
+    }
+    auto args=call->arguments();
+    if(args.size()!=method->second.size()){
+        add_error(call->token(),"TypeError: "+name+" takes "+std::to_string(method->second.size())+" arguments, "+
+                                std::to_string(args.size())+" were given");
+        return;
+    }
+    auto elem=type->generic_types()[0];
+    for(size_t i=0;i<args.size();i++){
+        auto param=method->second[i];
+        bool valid=param=="T"?fits(args[i],elem):
+                   param=="n"?fits(args[i],elem->type()==KAstPointerTypeExpr?std::make_shared<TypeExpression>(Token{},"int"):elem):
+                   args[i]->type()!=KAstInteger&&args[i]->type()!=KAstDecimal&&args[i]->type()!=KAstString&&args[i]->type()!=KAstBool;
+        if(!valid){
+            add_error(args[i]->token(),"TypeError: "+name+" of "+type->stringify()+" can't take "+args[i]->stringify(),
+                                       "",param=="*T"?name+"(&x) with x:"+elem->stringify():"");
+        }
+    }
+}
+
+//vec{T,N} holds N numbers, javascript gets arrays of them
+void Validator::validate_vector_type(Token tok,std::vector<AstNodePtr> types){
+    static const std::vector<std::string> lanes={"i8","i16","i32","int","u8","u16","u32","uint","f32","float"};
+    if(types.size()!=2||types[1]->type()!=KAstInteger){
+        add_error(tok, "SyntaxError: vec takes the type and the number of lanes","","vec{f32,8}");
+        return;
+    }
+    auto type=types[0];
+    if(type->type()!=KAstTypeExpr||std::find(lanes.begin(),lanes.end(),std::dynamic_pointer_cast<TypeExpression>(type)->value())==lanes.end()){
+        add_error(type->token(), "TypeError: the lanes of a vec have to be integers or floats");
+    }
+    auto literal=std::dynamic_pointer_cast<IntegerLiteral>(types[1])->value();
+    auto count=literal.size()<4?std::stoll(literal,nullptr,0):0;
+    if(count<2||count>64||(count&(count-1))!=0){
+        add_error(types[1]->token(), "Error: The number of lanes has to be a power of 2 from 2 to 64");
+    }
+}
 bool Validator::visit(const ListTypeExpr& node){
     node.elemType()->accept(*this);
     node.size()->accept(*this);
@@ -561,6 +1389,10 @@ bool Validator::visit(const EnumLiteral& node){
     return true;
 }
 bool Validator::visit(const WithStatement& node){
+    if(m_is_generator && !m_is_js && containsYield(node.body())){
+        add_error(node.token(),"Error: Can't yield inside a with statement",
+                               "The generator can stop at the yield and never reach the end of the with statement");
+    }
     node.body()->accept(*this);
     for(auto& x:node.values()){
         x->accept(*this);
@@ -625,6 +1457,21 @@ bool Validator::visit(const TernaryIf& node){
     return true;
 }
 bool Validator::visit(const TryExcept& node){
+    if(m_is_async && !m_is_js){
+        add_error(node.token(),"Error: try/except can't be used in an async function",
+                               "An exception can't jump back into a coroutine that was suspended",
+                               "Return an error value instead");
+    }
+    if(m_is_generator && !m_is_js){
+        bool yields=containsYield(node.body())||containsYield(node.else_body());
+        for(auto& x:node.except_clauses()){
+            yields=yields||containsYield(x.second);
+        }
+        if(yields){
+            add_error(node.token(),"Error: Can't yield inside try/except",
+                                   "An exception can't jump back into a generator that was suspended");
+        }
+    }
     node.body()->accept(*this);
     for(auto& x:node.except_clauses()){
         for(auto& y:x.first.first){
@@ -658,6 +1505,16 @@ bool Validator::visit(const MultipleAssign& node){
     for(auto& x:node.values()){
         x->accept(*this);
     }
+    if(m_parallel_locals.size()>0){
+        for(auto& x:node.names()){
+            check_parallel_write(x);
+        }
+    }
+    if(m_purity!=""){
+        for(auto& x:node.names()){
+            check_pure_write(x,true);
+        }
+    }
     for(auto& x:node.names()){
         x->accept(*this);
     }
@@ -672,6 +1529,12 @@ bool Validator::visit(const MultipleAssign& node){
     return true;
 }
 bool Validator::visit(const AugAssign& node){
+    if(m_parallel_locals.size()>0){
+        check_parallel_write(node.name());
+    }
+    if(m_purity!=""){
+        check_pure_write(node.name());
+    }
     node.name()->accept(*this);
     node.value()->accept(*this);
     return true;
@@ -704,6 +1567,19 @@ void Validator::validate_parameters(std::vector<parameter> param){
                 add_error(x.p_type->token(),"'...' has to be the last parameter of the function");
             }
         }
+        if(x.p_type->type()==KAstTypeExpr){
+            auto type=std::dynamic_pointer_cast<TypeExpression>(x.p_type);
+            if(type->value()=="channel"||type->value()=="spsc_channel"||type->value()=="atomic"){
+                add_error(x.p_name->token(),"TypeError: The "+type->value()+" "+x.p_name->stringify()+" can't be passed by value",
+                                            "It can't be copied, the caller and the function have to share it",
+                                            x.p_name->stringify()+":*"+type->stringify());
+            }
+        }
+        if(x.is_noalias&&x.p_type->type()!=KAstPointerTypeExpr){
+            add_error(x.p_name->token(),"Error: Only pointer parameters can be @noalias",
+                                        "It tells the compiler that no other pointer reaches what the parameter points to",
+                                        "@noalias "+x.p_name->stringify()+":*int");
+        }
         x.p_type->accept(*this);
     }
 }
@@ -929,7 +1805,19 @@ bool Validator::visit(const TernaryFor& node){
 }
 
 bool Validator::visit(const LambdaDefinition& node){
+    auto parallel_locals=m_parallel_locals;
+    auto is_async=m_is_async;
+    auto generator=m_is_generator;
+    auto scopes=m_scopes;
+    m_parallel_locals.clear();
+    m_is_async=false;
+    m_is_generator=false;
+    m_scopes=0;
     node.body()->accept(*this);
+    m_parallel_locals=parallel_locals;
+    m_is_async=is_async;
+    m_is_generator=generator;
+    m_scopes=scopes;
     auto param=node.parameters();
     for(auto& x:param){
         if(x.p_default->type()!=KAstNoLiteral){
@@ -947,6 +1835,7 @@ bool Validator::visit(const LambdaDefinition& node){
 }
 
 bool Validator::visit(const GenericCall& node){
+    validate_generic_types(node.token(),node.identifier()->stringify(),node.generic_types());
     node.identifier()->accept(*this);
     auto types=node.generic_types();
     for(auto& x:types){
@@ -963,6 +1852,68 @@ bool Validator::visit(const FormatedStr& node){
     return true;
 }
 
+bool Validator::visit(const AsyncStatement& node){
+    auto function=std::dynamic_pointer_cast<FunctionDefinition>(node.body());
+    if(function->returnType()->type()==KAstTypeTuple){
+        add_error(function->returnType()->token(),"Error: Async functions can't return multiple values");
+    }
+    m_async_function=true;
+    node.body()->accept(*this);
+    return true;
+}
+
+bool Validator::visit(const AwaitExpression& node){
+    if(!m_is_async){
+        add_error(node.token(),"SyntaxError: 'await' outside async function",
+                               "Only async functions can wait for other async functions",
+                               "Declare the function with async def");
+    }
+    node.value()->accept(*this);
+    return true;
+}
+
+bool Validator::visit(const YieldStatement& node){
+    if(m_parallel_locals.size()>0){
+        add_error(node.token(),"Error: Can't yield from a parallel loop",
+                               "The iterations run on different threads, there is no order in which their values could be handed out");
+    }
+    else if(!m_is_generator){
+        add_error(node.token(),"SyntaxError: 'yield' outside a function");
+    }
+    if(node.value()->type()==KAstNoLiteral){
+        add_error(node.token(),"SyntaxError: yield needs a value");
+    }
+    node.value()->accept(*this);
+    return true;
+}
+
+bool Validator::visit(const SpawnStatement& node){
+    if(m_scopes==0){
+        //outside a scope spawn starts a coroutine that nobody awaits
+        if(!m_is_async){
+            add_error(node.token(),"SyntaxError: 'spawn' outside a scope",
+                                   "The scope waits for the spawned task before it is left",
+                                   "Put it in a scope: block");
+        }
+    }
+    else if(m_is_js){
+        add_error(node.token(),"SyntaxError: Can't spawn threads in javascript");
+    }
+    else if(m_is_async){
+        add_error(node.token(),"Error: Can't spawn threads from an async function",
+                               "The scope would block the event loop until they are done",
+                               "Spawn it outside the scope to run it as a coroutine");
+    }
+    else if(m_is_generator){
+        add_error(node.token(),"Error: Can't spawn threads from a generator");
+    }
+    else if(node.value()->type()!=KAstFunctionCall){
+        add_error(node.token(),"SyntaxError: spawn takes a function call","","spawn func(args)");
+    }
+    node.value()->accept(*this);
+    return true;
+}
+
 void Validator::add_error(Token tok, std::string msg,
                 std::string submsg,std::string hint,
                 std::string ecode){
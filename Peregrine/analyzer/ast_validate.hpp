@@ -4,6 +4,7 @@
 #include "ast/ast.hpp"
 #include "ast/visitor.hpp"
 #include "lexer/tokens.hpp"
+#include <map>
 #include <string>
 #include <vector>
 namespace astValidator{
@@ -15,9 +16,47 @@ class Validator: public AstVisitor {
         bool m_should_contain_main=false;
         bool m_has_main=false;
         bool is_static_class_member=false;
+        //names that each iteration of the enclosing @parallel loops owns, the
+        //innermost loop is at the back
+        std::vector<std::vector<std::string>> m_parallel_locals;
+        size_t m_parallel_loop_depth=0;//loops nested in the innermost @parallel loop
+        bool m_is_async=false;//inside an async function
+        bool m_async_function=false;//the function definition being visited is async
+        bool m_in_function=false;
+        bool m_in_class=false;//visiting the methods of a class
+        bool m_is_generator=false;//inside a function that yields
+        size_t m_scopes=0;//scope blocks around the statement, in the current function
+        //global variables and the @pure or @const of every global function
+        std::vector<std::string> m_globals;
+        std::map<std::string,std::string> m_functions;
+        std::vector<std::string> m_enums;//which can be keys of a @cache
+        std::vector<std::string> m_types;//classes, unions and type aliases, called to make a value
+        std::vector<std::string> m_extern_owners;//c in def c.func()
+        std::vector<std::string> m_modules;//what imported modules are called in the file
+        const AstNode* m_method_call=nullptr;//the call in obj.method(), which is not a global function
+        std::string m_next_purity;//of the function definition that is visited next
+        std::string m_purity;//"pure" or "const" inside such a function
+        std::vector<std::string> m_pure_locals;//names it can write to
+        bool m_next_tailrec=false;//the function definition that is visited next is @tailrec
+        std::string m_tailrec;//name of the @tailrec function around the statement
+        std::vector<const AstNode*> m_tail_calls;//its calls to itself that become a loop
+        //the channels and atomics in scope, to their channel{T}, spsc_channel{T} or atomic{T}
+        std::map<std::string,std::shared_ptr<TypeExpression>> m_runtime_objects;
         void add_error(Token tok, std::string msg,std::string submsg="",std::string hint="",std::string ecode="");
         void validate_parameters(std::vector<parameter> param);
         void validate_parameters(std::vector<AstNodePtr> param);
+        void validate_parallel_loop(const DecoratorStatement& node);
+        void check_parallel_write(AstNodePtr name);
+        void check_pure_write(AstNodePtr name,bool declares=false);
+        void check_pure_call(const FunctionCall& node);
+        void validate_tailrec(const FunctionDefinition& node);
+        void validate_cache(AstNodePtr decorator,const FunctionDefinition& function);
+        void validate_vector_type(Token tok,std::vector<AstNodePtr> types);
+        void validate_layout(std::vector<AstNodePtr> decorators,bool is_field=false);
+        void validate_function_attributes(const DecoratorStatement& node);
+        void validate_generic_types(Token tok,std::string name,std::vector<AstNodePtr> types);
+        void declare_runtime_object(AstNodePtr name,AstNodePtr type,AstNodePtr value);
+        void check_runtime_method(AstNodePtr owner,AstNodePtr referenced);
         bool visit(const Program& node);
         bool visit(const BlockStatement& node);
         bool visit(const ClassDefinition& node);
@@ -90,6 +129,10 @@ class Validator: public AstVisitor {
         bool visit(const LambdaDefinition& node);
         bool visit(const GenericCall& node);
         bool visit(const FormatedStr& node);
+        bool visit(const AsyncStatement& node);
+        bool visit(const AwaitExpression& node);
+        bool visit(const YieldStatement& node);
+        bool visit(const SpawnStatement& node);
     public:
         Validator(AstNodePtr ast,std::string filename,bool is_js=false,bool should_contain_main=false);
 };
@@ -0,0 +1,218 @@
+#include "tail_call.hpp"
+#include <algorithm>
+#include <memory>
+namespace tailCall{
+namespace{
+//decorators that change how a function is compiled instead of wrapping it,
+//a function wrapped by anything else calls the wrapper when it calls itself
+bool isAttribute(AstNodePtr decorator){
+    auto name=decorator->type()==KAstFunctionCall?std::dynamic_pointer_cast<FunctionCall>(decorator)->name():decorator;
+    if(name->type()!=KAstIdentifier){
+        return false;
+    }
+    auto value=name->stringify();
+    return value=="tailrec"||value=="target_clones"||value=="pure"||value=="const"||value=="hot"||value=="cold";
+}
+
+class Rewriter{
+    const FunctionDefinition& m_function;
+    std::string m_name;
+    bool m_is_void;
+    std::vector<const AstNode*> m_calls;
+
+    //a call of the function to itself, values are the new values of its
+    //parameters. defaults are filled in, calls with named arguments are left alone
+    bool selfCall(AstNodePtr node,std::vector<AstNodePtr>& values){
+        if(node->type()!=KAstFunctionCall){
+            return false;
+        }
+        auto call=std::dynamic_pointer_cast<FunctionCall>(node);
+        if(call->name()->type()!=KAstIdentifier||call->name()->stringify()!=m_name){
+            return false;
+        }
+        auto params=m_function.parameters();
+        auto args=call->arguments();
+        if(args.size()>params.size()){
+            return false;
+        }
+        values.clear();
+        for(size_t i=0;i<params.size();++i){
+            if(i<args.size()&&args[i]->type()!=KAstDefaultArg){
+                values.push_back(args[i]);
+            }
+            else if(i>=args.size()&&params[i].p_default->type()!=KAstNoLiteral){
+                values.push_back(params[i].p_default);
+            }
+            else{
+                return false;
+            }
+        }
+        m_calls.push_back(node.get());
+        return true;
+    }
+    //all arguments are evaluated before the first parameter changes
+    void jump(std::vector<AstNodePtr>& statements,std::vector<AstNodePtr> values){
+        if(values.size()>0){
+            std::vector<AstNodePtr> names;
+            for(auto& param:m_function.parameters()){
+                names.push_back(param.p_name);
+            }
+            statements.push_back(std::make_shared<MultipleAssign>(names,values));
+        }
+        statements.push_back(std::make_shared<ContinueStatement>(m_function.token()));
+    }
+
+    AstNodePtr rewriteIf(AstNodePtr node,bool tail){
+        auto stmt=std::dynamic_pointer_cast<IfStatement>(node);
+        std::vector<std::pair<AstNodePtr,AstNodePtr>> elifs;
+        for(auto& elif:stmt->elifs()){
+            elifs.push_back({elif.first,rewrite(elif.second,tail)});
+        }
+        return std::make_shared<IfStatement>(stmt->token(),stmt->condition(),rewrite(stmt->ifBody(),tail),
+                                             rewrite(stmt->elseBody(),tail),elifs);
+    }
+
+  public:
+    Rewriter(const FunctionDefinition& function):m_function(function){
+        m_name=function.name()->stringify();
+        m_is_void=function.returnType()->stringify()=="void";
+    }
+    std::vector<const AstNode*> calls() const{
+        return m_calls;
+    }
+
+    //tail is true when the function returns right after the block. loops,
+    //try, with and the rest are not entered: a continue inside a loop or a
+    //match would go to the wrong place, the others have to run code once
+    //their body is done
+    AstNodePtr rewrite(AstNodePtr node,bool tail){
+        if(node->type()!=KAstBlockStmt){
+            return node;
+        }
+        auto statements=std::dynamic_pointer_cast<BlockStatement>(node)->statements();
+        std::vector<AstNodePtr> res;
+        std::vector<AstNodePtr> values;
+        for(size_t i=0;i<statements.size();++i){
+            auto stmt=statements[i];
+            bool last=i+1==statements.size();
+            if(stmt->type()==KAstReturnStatement&&
+                selfCall(std::dynamic_pointer_cast<ReturnStatement>(stmt)->returnValue(),values)){
+                jump(res,values);
+            }
+            //f(x) followed by the end of a void function or by a bare return
+            else if(m_is_void&&(last?tail:statements[i+1]->type()==KAstReturnStatement&&
+                    std::dynamic_pointer_cast<ReturnStatement>(statements[i+1])->returnValue()->type()==KAstNoLiteral)&&
+                    selfCall(stmt,values)){
+                jump(res,values);
+            }
+            else if(stmt->type()==KAstIfStmt){
+                res.push_back(rewriteIf(stmt,tail&&last));
+            }
+            else if(stmt->type()==KAstDecorator&&
+                    std::dynamic_pointer_cast<DecoratorStatement>(stmt)->body()->type()==KAstIfStmt){
+                auto decorator=std::dynamic_pointer_cast<DecoratorStatement>(stmt);
+                res.push_back(std::make_shared<DecoratorStatement>(decorator->token(),decorator->decoratorItem(),
+                                                                   rewriteIf(decorator->body(),tail&&last)));
+            }
+            else{
+                res.push_back(stmt);
+            }
+        }
+        return std::make_shared<BlockStatement>(res);
+    }
+};
+
+//the function with its body in a while loop, the same function if it never
+//calls itself in a tail position
+AstNodePtr rewriteFunction(AstNodePtr node){
+    auto function=std::dynamic_pointer_cast<FunctionDefinition>(node);
+    if(ineligible(*function)!=""){
+        return node;
+    }
+    Rewriter rewriter(*function);
+    auto body=rewriter.rewrite(function->body(),true);
+    if(rewriter.calls().size()==0){
+        return node;
+    }
+    auto tok=function->token();
+    auto statements=std::dynamic_pointer_cast<BlockStatement>(body)->statements();
+    //a body that runs to its end leaves the loop, and the function, there
+    if(statements.size()==0||(statements.back()->type()!=KAstReturnStatement&&
+                              statements.back()->type()!=KAstContinueStatement)){
+        statements.push_back(std::make_shared<BreakStatement>(tok));
+    }
+    auto loop=std::make_shared<WhileStatement>(tok,std::make_shared<BoolLiteral>(tok,"True"),
+                                               std::make_shared<BlockStatement>(statements));
+    return std::make_shared<FunctionDefinition>(tok,function->returnType(),function->name(),function->parameters(),
+                                                std::make_shared<BlockStatement>(std::vector<AstNodePtr>{loop}),
+                                                function->comment(),function->generics());
+}
+}
+
+std::string ineligible(const FunctionDefinition& function){
+    if(function.name()->stringify()=="main"){
+        return "it is the main function";
+    }
+    if(function.body()->type()!=KAstBlockStmt){
+        return "it has no body";
+    }
+    if(containsYield(function.body())){
+        return "it is a generator";
+    }
+    for(auto& param:function.parameters()){
+        if(param.p_paramType!=Normal){
+            return "it takes a variable number of arguments";
+        }
+        if(param.is_const){
+            return "its parameter "+param.p_name->stringify()+" is const";
+        }
+        if(param.p_type->type()==KAstRefTypeExpr){
+            //assigning it would write to the variable of the caller
+            return "its parameter "+param.p_name->stringify()+" is a reference";
+        }
+    }
+    if(containsStatement(function.body(),KAstFunctionDef)){
+        //they may keep the parameters, which the loop changes
+        return "it defines functions";
+    }
+    return "";
+}
+
+std::vector<const AstNode*> tailCalls(const FunctionDefinition& function){
+    Rewriter rewriter(function);
+    rewriter.rewrite(function.body(),true);
+    return rewriter.calls();
+}
+
+AstNodePtr eliminate(AstNodePtr program){
+    auto node=std::dynamic_pointer_cast<Program>(program);
+    std::vector<AstNodePtr> statements;
+    for(auto& stmt:node->statements()){
+        if(stmt->type()==KAstFunctionDef){
+            statements.push_back(rewriteFunction(stmt));
+            continue;
+        }
+        if(stmt->type()!=KAstDecorator){
+            statements.push_back(stmt);
+            continue;
+        }
+        auto decorator=std::dynamic_pointer_cast<DecoratorStatement>(stmt);
+        auto items=decorator->decoratorItem();
+        if(decorator->body()->type()!=KAstFunctionDef||!std::all_of(items.begin(),items.end(),isAttribute)){
+            statements.push_back(stmt);
+            continue;
+        }
+        items.erase(std::remove_if(items.begin(),items.end(),[](AstNodePtr x){
+            return x->type()==KAstIdentifier&&x->stringify()=="tailrec";
+        }),items.end());
+        auto function=rewriteFunction(decorator->body());
+        if(items.size()==0){
+            statements.push_back(function);
+        }
+        else{
+            statements.push_back(std::make_shared<DecoratorStatement>(decorator->token(),items,function));
+        }
+    }
+    return std::make_shared<Program>(statements,node->comment());
+}
+}
@@ -0,0 +1,19 @@
+#ifndef PEREGRINE_TAIL_CALL_HPP
+#define PEREGRINE_TAIL_CALL_HPP
+#include "ast/ast.hpp"
+#include <string>
+#include <vector>
+//A global function that returns a call of itself jumps back to its start
+//instead. The arguments are assigned to the parameters and the body runs
+//again in a while loop, so the recursion needs no stack in either backend.
+namespace tailCall{
+using namespace ast;
+//why the calls of the function to itself can't become a loop, empty if they can
+std::string ineligible(const FunctionDefinition& function);
+//the calls of the function to itself that become a jump back to its start
+std::vector<const AstNode*> tailCalls(const FunctionDefinition& function);
+//rewrites the global functions that call themselves in a tail position and
+//drops the @tailrec decorators, which only ask the validator to check that
+AstNodePtr eliminate(AstNodePtr program);
+}
+#endif
@@ -14,10 +14,7 @@ TypeChecker::TypeChecker(ast::AstNodePtr ast) {
     m_currentFunction = nullptr;
     ast->accept(*this);
     if(m_errors.size()!=0) {
-        for(auto& err : m_errors) {
-            display(err);
-        }
-        exit(1);
+        throw CompileError(m_errors);
     }
 }
 bool TypeChecker::defined(ast::AstNodePtr name){
@@ -415,6 +412,7 @@ bool TypeChecker::visit(const ast::ForStatement& node) {
     // be correct here
 
     node.body()->accept(*this);
+    m_env = oldEnv;
     return true;
 }
 
@@ -777,7 +775,17 @@ bool TypeChecker::visit(const ast::IdentifierExpression& node) {
     return true;
 }
 
+// channel{int}(16), the validator checks the channels and atomics
+bool TypeChecker::visit(const ast::GenericCall& node) {
+    m_result = NULL;
+    return true;
+}
+
 bool TypeChecker::visit(const ast::TypeExpression& node) {
+    if (node.generic_types().size() != 0) {
+        m_result = NULL;
+        return true;
+    }
     auto enum_map = m_env->getEnumMap();
     auto union_map = m_env->getUnionMap();
     if(enum_map.contains(node.value())){
@@ -799,7 +807,7 @@ bool TypeChecker::visit(const ast::TypeExpression& node) {
         return true;
     }
     else{
-        m_result = identifierToTypeMap[node.value()];
+        m_result = identifierToTypeMap.at(node.value());
     }
     return true;
 }
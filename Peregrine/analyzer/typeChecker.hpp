@@ -60,6 +60,7 @@ class TypeChecker : public ast::AstVisitor {
     bool visit(const ast::ArrowExpression& node);
     bool visit(const ast::IdentifierExpression& node);
     bool visit(const ast::TypeExpression& node);
+    bool visit(const ast::GenericCall& node);
     bool visit(const ast::ListTypeExpr& node);
     bool visit(const ast::FunctionTypeExpr& node);
     bool visit(const ast::NoLiteral& node);
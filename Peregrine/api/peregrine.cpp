@@ -0,0 +1,49 @@
+#include "peregrine.hpp"
+#include "analyzer/ast_validate.hpp"
+#include "analyzer/tail_call.hpp"
+#include "codegen/cpp/codegen.hpp"
+#include "codegen/js/codegen.hpp"
+#include "docgen/html/docgen.hpp"
+#include "lexer/lexer.hpp"
+#include "parser/parser.hpp"
+#include <sstream>
+namespace peregrine{
+std::string Result::diagnostics() const{
+    std::string res;
+    for(auto& err:errors){
+        res+=format(err);
+    }
+    if(message!=""){
+        res+=fg("Error: "+message,light_red)+"\n";
+    }
+    return res;
+}
+
+Result compile(const std::string& source,const Options& options){
+    Result res;
+    try{
+        auto tokens=LEXER(source,options.filename).result();
+        Parser::Parser parser(tokens,options.filename);
+        ast::AstNodePtr program=parser.parse();
+        astValidator::Validator val(program,options.filename,options.target==Target::Js,options.has_main);
+        std::ostringstream out;
+        if(options.target==Target::Doc){
+            html::Docgen docgen(out,program,options.filename);
+        }
+        else if(options.target==Target::Cpp){
+            cpp::Codegen codegen(out,tailCall::eliminate(program),options.filename,options.profile_alloc,
+                                 options.line_directives,options.reorder_fields,options.march_dispatch);
+        }
+        else{
+            js::Codegen codegen(out,tailCall::eliminate(program),options.target==Target::Html,options.filename);
+        }
+        res.output=out.str();
+        res.ok=true;
+    }
+    catch(const CompileError& e){
+        res.errors=e.errors();
+        res.message=e.message();
+    }
+    return res;
+}
+}
@@ -0,0 +1,37 @@
+#ifndef PEREGRINE_API_HPP
+#define PEREGRINE_API_HPP
+//libperegrine, the compiler without its command line. compile() takes the
+//source of a module and gives back what a backend generated from it or the
+//errors it has. nothing is kept between calls and no file is written, so a
+//build system or the playground can run any number of them at once
+#include "errors/error.hpp"
+#include <string>
+#include <vector>
+namespace peregrine{
+enum class Target{
+    Cpp,
+    Js,
+    Html,//javascript embedded in a page
+    Doc//html docs of the module
+};
+struct Options{
+    Target target=Target::Cpp;
+    //the path shown in errors, the globals of the module are named after it too
+    std::string filename="main.pe";
+    bool has_main=false;//it is a program, so main has to be defined
+    bool profile_alloc=false;
+    bool line_directives=false;
+    bool reorder_fields=false;
+    bool march_dispatch=false;
+};
+struct Result{
+    bool ok=false;
+    std::string output;//the C++, javascript or html
+    std::vector<PEError> errors;
+    std::string message;//an error that has no place in the source
+    //the errors the way the command line prints them
+    std::string diagnostics() const;
+};
+Result compile(const std::string& source,const Options& options=Options());
+}
+#endif
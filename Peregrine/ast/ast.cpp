@@ -704,6 +704,9 @@ std::string FunctionDefinition::stringify() const {
             if (i) {
                 res += ", ";
             }
+            if(param.is_noalias){
+                res += "@noalias ";
+            }
             if(param.is_const){
                 res += "const ";
             }
@@ -1624,6 +1627,9 @@ std::string MethodDefinition::stringify() const {
             if (i) {
                 res += ", ";
             }
+            if(param.is_noalias){
+                res += "@noalias ";
+            }
             if(param.is_const){
                 res += "const ";
             }
@@ -1866,6 +1872,9 @@ std::string LambdaDefinition::stringify() const{
             if (i) {
                 res += ", ";
             }
+            if(param.is_noalias){
+                res += "@noalias ";
+            }
             if(param.is_const){
                 res += "const ";
             }
@@ -1941,4 +1950,123 @@ std::string FormatedStr::stringify() const{
     res+="\"";
     return res;
 }
+
+AsyncStatement::AsyncStatement(Token tok, AstNodePtr body) {
+    m_token = tok;
+    m_body = body;
+}
+
+AstNodePtr AsyncStatement::body() const { return m_body; }
+
+Token AsyncStatement::token() const { return m_token; }
+
+AstKind AsyncStatement::type() const { return KAstAsync; }
+
+std::string AsyncStatement::stringify() const {
+    std::string res = "async ";
+    res += m_body->stringify();
+    return res;
+}
+
+AwaitExpression::AwaitExpression(Token tok, AstNodePtr value) {
+    m_token = tok;
+    m_value = value;
+}
+
+AstNodePtr AwaitExpression::value() const { return m_value; }
+
+Token AwaitExpression::token() const { return m_token; }
+
+AstKind AwaitExpression::type() const { return KAstAwait; }
+
+std::string AwaitExpression::stringify() const {
+    return "await " + m_value->stringify();
+}
+
+YieldStatement::YieldStatement(Token tok, AstNodePtr value) {
+    m_token = tok;
+    m_value = value;
+}
+
+AstNodePtr YieldStatement::value() const { return m_value; }
+
+Token YieldStatement::token() const { return m_token; }
+
+AstKind YieldStatement::type() const { return KAstYield; }
+
+std::string YieldStatement::stringify() const {
+    return "yield " + m_value->stringify();
+}
+
+SpawnStatement::SpawnStatement(Token tok, AstNodePtr value) {
+    m_token = tok;
+    m_value = value;
+}
+
+AstNodePtr SpawnStatement::value() const { return m_value; }
+
+Token SpawnStatement::token() const { return m_token; }
+
+AstKind SpawnStatement::type() const { return KAstSpawn; }
+
+std::string SpawnStatement::stringify() const {
+    return "spawn " + m_value->stringify();
+}
+
+bool containsYield(AstNodePtr node) { return containsStatement(node, KAstYield); }
+
+bool containsStatement(AstNodePtr node, AstKind kind) {
+    if (node->type() == kind) {
+        return true;
+    }
+    switch (node->type()) {
+        case KAstBlockStmt: {
+            for (auto& stmt : std::dynamic_pointer_cast<BlockStatement>(node)->statements()) {
+                if (containsStatement(stmt, kind)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        case KAstIfStmt: {
+            auto stmt = std::dynamic_pointer_cast<IfStatement>(node);
+            for (auto& elif : stmt->elifs()) {
+                if (containsStatement(elif.second, kind)) {
+                    return true;
+                }
+            }
+            return containsStatement(stmt->ifBody(), kind) || containsStatement(stmt->elseBody(), kind);
+        }
+        case KAstWhileStmt:
+            return containsStatement(std::dynamic_pointer_cast<WhileStatement>(node)->body(), kind);
+        case KAstForStatement:
+            return containsStatement(std::dynamic_pointer_cast<ForStatement>(node)->body(), kind);
+        case KAstScopeStmt:
+            return containsStatement(std::dynamic_pointer_cast<ScopeStatement>(node)->body(), kind);
+        case KAstWith:
+            return containsStatement(std::dynamic_pointer_cast<WithStatement>(node)->body(), kind);
+        case KAstDecorator:
+            return containsStatement(std::dynamic_pointer_cast<DecoratorStatement>(node)->body(), kind);
+        case KAstMatchStmt: {
+            auto stmt = std::dynamic_pointer_cast<MatchStatement>(node);
+            for (auto& matchCase : stmt->caseBody()) {
+                if (containsStatement(matchCase.second, kind)) {
+                    return true;
+                }
+            }
+            return containsStatement(stmt->defaultBody(), kind);
+        }
+        case KAstTryExcept: {
+            auto stmt = std::dynamic_pointer_cast<TryExcept>(node);
+            for (auto& except : stmt->except_clauses()) {
+                if (containsStatement(except.second, kind)) {
+                    return true;
+                }
+            }
+            return containsStatement(stmt->body(), kind) || containsStatement(stmt->else_body(), kind);
+        }
+        default:
+            return false;
+    }
+}
 } // namespace ast
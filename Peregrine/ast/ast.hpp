@@ -82,7 +82,11 @@ enum AstKind {
     KAstInlineAsm,
     KAstLambda,
     KAstGenericCall,
-    KAstFormatedStr
+    KAstFormatedStr,
+    KAstAsync,
+    KAstAwait,
+    KAstYield,
+    KAstSpawn
 };
 
 class AstVisitor;
@@ -582,6 +586,7 @@ struct parameter {
     AstNodePtr p_default;
     bool is_const=false;
     ParamType p_paramType=Normal;
+    bool is_noalias=false;//@noalias, no other pointer reaches what it points to
 };
 
 class ClassDefinition : public AstNode {
@@ -1332,6 +1337,67 @@ class FormatedStr: public AstNode{
     std::string stringify() const;
     void accept(AstVisitor& visitor) const;
 };
+
+// async def function():...
+class AsyncStatement : public AstNode {
+    Token m_token;
+    AstNodePtr m_body;
+
+  public:
+    AsyncStatement(Token tok, AstNodePtr body);
+    AstNodePtr body() const;
+    Token token() const;
+    AstKind type() const;
+    std::string stringify() const;
+    void accept(AstVisitor& visitor) const;
+};
+
+// await value
+class AwaitExpression : public AstNode {
+    Token m_token;
+    AstNodePtr m_value;
+
+  public:
+    AwaitExpression(Token tok, AstNodePtr value);
+    AstNodePtr value() const;
+    Token token() const;
+    AstKind type() const;
+    std::string stringify() const;
+    void accept(AstVisitor& visitor) const;
+};
+
+// yield value
+class YieldStatement : public AstNode {
+    Token m_token;
+    AstNodePtr m_value;
+
+  public:
+    YieldStatement(Token tok, AstNodePtr value);
+    AstNodePtr value() const;
+    Token token() const;
+    AstKind type() const;
+    std::string stringify() const;
+    void accept(AstVisitor& visitor) const;
+};
+
+// spawn f(x)
+class SpawnStatement : public AstNode {
+    Token m_token;
+    AstNodePtr m_value;
+
+  public:
+    SpawnStatement(Token tok, AstNodePtr value);
+    AstNodePtr value() const;
+    Token token() const;
+    AstKind type() const;
+    std::string stringify() const;
+    void accept(AstVisitor& visitor) const;
+};
+
+// true if the statements of a function body contain a statement of the given
+// kind, nested functions and classes are not searched
+bool containsStatement(AstNodePtr node, AstKind kind);
+bool containsYield(AstNodePtr node);
 } // namespace ast
 
 #endif
@@ -1110,7 +1110,7 @@ TypePtr TypeProducer::enumT(std::string name,std::vector<std::string> items,std:
 TypePtr TypeProducer::unionT(std::string name,std::map<std::string,TypePtr> items){
     return std::make_shared<UnionTypeDef>(name,items);
 }
-std::map<std::string, TypePtr> identifierToTypeMap = {
+const std::map<std::string, TypePtr> identifierToTypeMap = {
     {"i8", TypeProducer::integer(IntType::IntSizes::Int8)},
     {"i16", TypeProducer::integer(IntType::IntSizes::Int16)},
     {"i32", TypeProducer::integer()},
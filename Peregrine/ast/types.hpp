@@ -396,7 +396,7 @@ class TypeProducer {
     static TypePtr unionT(std::string name,std::map<std::string,TypePtr> items);
 };
 
-extern std::map<std::string, TypePtr> identifierToTypeMap;
+extern const std::map<std::string, TypePtr> identifierToTypeMap;
 
 } // namespace types
 
@@ -185,4 +185,8 @@ void InlineAsm::accept(AstVisitor &visitor) const {visitor.visit(*this);}
 void LambdaDefinition::accept(AstVisitor &visitor) const {visitor.visit(*this);}
 void GenericCall::accept(AstVisitor& visitor) const { visitor.visit(*this); }
 void FormatedStr::accept(AstVisitor& visitor) const { visitor.visit(*this); }
+void AsyncStatement::accept(AstVisitor& visitor) const { visitor.visit(*this); }
+void AwaitExpression::accept(AstVisitor& visitor) const { visitor.visit(*this); }
+void YieldStatement::accept(AstVisitor& visitor) const { visitor.visit(*this); }
+void SpawnStatement::accept(AstVisitor& visitor) const { visitor.visit(*this); }
 } // namespace ast
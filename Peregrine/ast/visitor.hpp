@@ -81,6 +81,10 @@ class AstVisitor {
     virtual bool visit(const LambdaDefinition& node) { return false; };
     virtual bool visit(const GenericCall& node) { return false; };
     virtual bool visit(const FormatedStr& node) {return false;}
+    virtual bool visit(const AsyncStatement& node) { return false; };
+    virtual bool visit(const AwaitExpression& node) { return false; };
+    virtual bool visit(const YieldStatement& node) { return false; };
+    virtual bool visit(const SpawnStatement& node) { return false; };
 
 };
 
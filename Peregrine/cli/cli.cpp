@@ -6,11 +6,23 @@ namespace cli{
         println("Usage: peregrine [command] [options] [file] -o [output file]\n");
         println("Peregrine Commands:");
         println("\tcompile          - compiles a given file");
+        println("\trun              - compiles a given file and runs it, what follows the file is passed to it");
+        println("\t                   (binaries are cached in $PEREGRINE_CACHE_DIR or ~/.cache/peregrine)");
+        println("\t                   (at most $PEREGRINE_CACHE_SIZE MiB of them, 512 by default)");
         println("\thelp             - prints out help");
         println("\nPeregrine Options:");
         println("\t-release         - create release builds");
         println("\t-debug           - create debug builds");
         println("\t-static          - create statically linked builds");
+        println("\t-profile-alloc   - report heap traffic per source line when the program exits (the buffers of");
+        println("\t                   soa_list, @cache and channels, objects of classes are not on the heap)");
+        println("\t-size-report     - print how much of the binary each function takes (also written as <output>.size.json)");
+        println("\t-time-trace      - print which functions and classes the c++ compiler spends its time on (needs clang)");
+        println("\t-reorder-fields  - order the fields of classes to save padding (@hot fields first) and print their layout");
+        println("\t-march-dispatch  - build the functions that have loops for avx2 and avx512f as well and pick one at runtime");
+        println("\t-MD              - write a make/ninja rule listing the imported modules and runtime headers to <output>.d");
+        println("\t-MF <file>       - write the rule of -MD to <file> instead");
+        println("\t-print-import-graph[=dot] - print the modules the file imports as json (or dot) and exit");
         println("\t-cc              - select the c++ compiler with which you want to compile the resultant code");
         println("\t-cc_flag         - add flags with which you want to compile the generated c++ code");
         println("\t-emit_cpp        - generates C++ code and exits (skips C++ compilation phase)");
@@ -21,6 +33,7 @@ namespace cli{
         println("\t-o <output file> - select the output file");
         println("\nExample:");
         println("\tperegrine compile example.pe -o example");
+        println("\tperegrine run -release example.pe arg1 arg2");
     }
     CLI::CLI(int argc, char** argv){
         for (int i = 1; i < argc; ++i) {
@@ -56,11 +69,32 @@ namespace cli{
             }else if(curr_arg=="-release"){
                 m_state.cpp_arg+=" -O2 ";
                 m_state.is_release=true;
+            }else if(curr_arg=="-profile-alloc"){
+                m_state.profile_alloc=true;
+            }else if(curr_arg=="-size-report"){
+                m_state.size_report=true;
+            }else if(curr_arg=="-time-trace"){
+                m_state.time_trace=true;
+            }else if(curr_arg=="-reorder-fields"){
+                m_state.reorder_fields=true;
+            }else if(curr_arg=="-march-dispatch"){
+                m_state.march_dispatch=true;
             }else if(curr_arg=="-static"){
                 m_state.cpp_arg+=" -static ";
             }else if(curr_arg=="-debug"){
                 m_state.debug=true;
                 m_state.cpp_arg+=" -ggdb -glldb ";
+            }else if(curr_arg=="-MD"){
+                m_state.depfile=true;
+            }else if(curr_arg=="-MF"){
+                advance();
+                checkargs("dependency file");
+                m_state.depfile=true;
+                m_state.depfile_name=curr_arg;
+            }else if(curr_arg=="-print-import-graph"||curr_arg=="-print-import-graph=json"){
+                m_state.import_graph="json";
+            }else if(curr_arg=="-print-import-graph=dot"){
+                m_state.import_graph="dot";
             }else if (curr_arg=="-o"){
                 advance();
                 checkargs("output file");
@@ -77,6 +111,8 @@ namespace cli{
                     exit(1);
                 }
                 m_state.input_filename = curr_arg;
+            }else if(curr_arg=="run"){
+                m_state.run=true;
             }else if(curr_arg=="-dev_debug"){
                 m_state.dev_debug = true;
             }else if(curr_arg=="help"){
@@ -101,6 +137,15 @@ namespace cli{
                     exit(1);
                 }
             }
+            if(m_state.run && m_state.input_filename!=""){
+                //the rest of the command line belongs to the program
+                advance();
+                while(curr_arg!=""){
+                    m_state.run_args.push_back(curr_arg);
+                    advance();
+                }
+                break;
+            }
             advance();
         }
         return m_state;
@@ -122,6 +167,11 @@ namespace cli{
             exit(1);
         }
         int check_state=0;
+        if(m_state.run && (m_state.output_filename!=""||m_state.depfile||m_state.emit_cpp||m_state.emit_js||m_state.emit_html||
+                           m_state.doc_html||m_state.emit_obj||m_state.size_report||m_state.time_trace)){
+            println("peregrine run builds an executable of its own, it takes no -o, -MD or output format");
+            exit(1);
+        }
         if(m_state.output_filename==""){
             if(m_state.emit_cpp){
                 m_state.output_filename=m_state.input_filename.substr(0, m_state.input_filename.size()-3)+".cpp";
@@ -178,8 +228,31 @@ namespace cli{
             }
             check_state++;
         }
+        if(m_state.depfile && m_state.depfile_name==""){
+            m_state.depfile_name=m_state.output_filename+".d";
+        }
+        if(m_state.size_report && (m_state.emit_cpp||m_state.emit_js||m_state.emit_html||m_state.doc_html||m_state.emit_obj)){
+            println("-size-report can only be used when building an executable");
+            exit(1);
+        }
+        if(m_state.time_trace && (m_state.emit_cpp||m_state.emit_js||m_state.emit_html||m_state.doc_html||m_state.emit_obj)){
+            println("-time-trace can only be used when building an executable");
+            exit(1);
+        }
+        if(m_state.reorder_fields && (m_state.emit_js||m_state.emit_html||m_state.doc_html)){
+            println("-reorder-fields can only be used with the c++ backend");
+            exit(1);
+        }
+        if(m_state.march_dispatch && (m_state.emit_js||m_state.emit_html||m_state.doc_html)){
+            println("-march-dispatch can only be used with the c++ backend");
+            exit(1);
+        }
         if(m_state.cpp_compiler==""){
             m_state.cpp_compiler="clang++";//it will use clang that we are shiping with in the future
         }
+        if(m_state.time_trace && m_state.cpp_compiler.find("clang")==std::string::npos){
+            println("-time-trace needs clang as the c++ compiler");
+            exit(1);
+        }
     }
 }
\ No newline at end of file
@@ -19,6 +19,16 @@ class state{
     bool doc_html=false;
     bool is_release=false;
     bool debug=false;
+    bool profile_alloc=false;
+    bool size_report=false;
+    bool time_trace=false;
+    bool reorder_fields=false;
+    bool march_dispatch=false;
+    bool run=false;//peregrine run, builds the program into the cache and runs it
+    std::vector<std::string> run_args;
+    bool depfile=false;//-MD
+    std::string depfile_name="";//-MF, <output>.d when it is not given
+    std::string import_graph="";//json or dot with -print-import-graph
     bool dev_debug=false;//Will be removed later. It is for debugging the parser
     void validate_state();
 };
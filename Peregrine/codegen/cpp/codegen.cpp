@@ -4,6 +4,7 @@
 #include "errors/error.hpp"
 #include <algorithm>
 #include <cstddef>
+#include <cstdio>
 #include <bitset>
 #include <functional>
 #include <filesystem>
@@ -12,6 +13,9 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#ifndef PEREGRINE_RUNTIME_DIR
+#define PEREGRINE_RUNTIME_DIR "lib"
+#endif
 #define local_mangle_start() bool curr_state=local;\
                              local=true; \
                              auto symbol_map=m_symbolMap;
@@ -46,23 +50,76 @@ std::string global_name(std::string name)
     }
     return res;
 }
+//text as the inside of a c string literal, file names can have quotes and
+//backslashes (windows paths)
+static std::string c_string(std::string text)
+{
+    std::string res;
+    for (unsigned char c : text)
+    {
+        if(c=='\\'||c=='"'){
+            res+='\\';
+            res+=c;
+        }
+        else if(c<0x20||c==0x7f){
+            char octal[5];
+            snprintf(octal,sizeof(octal),"\\%03o",c);
+            res+=octal;
+        }
+        else{
+            res+=c;
+        }
+    }
+    return res;
+}
 
 namespace cpp {
 
-Codegen::Codegen(std::string outputFilename, ast::AstNodePtr ast,std::string filename) {
+Codegen::Codegen(std::ostream& out, ast::AstNodePtr ast,std::string filename,bool profile_alloc,bool line_directives,bool reorder_fields,bool march_dispatch) {
     m_filename=filename;
-    m_file.open(outputFilename);
-    m_file << "#include <setjmp.h>\n#include <cstdlib>\n#include <stdio.h>\n#include <stdint.h>\n#include <functional>\ntypedef enum{error________P____P____Error,error________P____P____AssertionError,error________P____P____ZeroDivisionError} error;\n";
-    m_file<<"struct ____P____exception_handler{\n"
+    m_profile_alloc=profile_alloc;
+    m_line_directives=line_directives;
+    m_reorder_fields=reorder_fields;
+    m_march_dispatch=march_dispatch;
+    m_global_name=global_name(filename);
+    ast->accept(*this);
+    if(m_profile_alloc){
+        out<<"#define PEREGRINE_PROFILE_ALLOC\n";
+        out<<"#define PEREGRINE_PROFILE_ALLOC_FILE \""+filename+"\"\n";
+        out<<"#include \"" PEREGRINE_RUNTIME_DIR "/alloc.hpp\"\n";
+    }
+    for(auto& header:m_runtime_headers){
+        out<<"#include \"" PEREGRINE_RUNTIME_DIR "/"<<header<<"\"\n";
+    }
+    out << "#include <setjmp.h>\n#include <cstdlib>\n#include <stdio.h>\n#include <stdint.h>\n#include <functional>\ntypedef enum{error________P____P____Error,error________P____P____AssertionError,error________P____P____ZeroDivisionError} error;\n";
+    out<<"struct ____P____exception_handler{\n"
             "jmp_buf* buf;\n"
             "std::function<void(void)> handler;\n"
             "error err;\n"
             "};\n";
-    m_global_name=global_name(filename);
-    ast->accept(*this);
-    m_file.close();
+    out<<m_file.str();
+}
+
+std::map<std::string, std::string> Codegen::symbol_origins() {
+    return m_symbolMap.reverse_map();
 }
 
+std::vector<std::string> Codegen::runtime_headers() {
+    std::vector<std::string> res;
+    if(m_profile_alloc){
+        res.push_back(PEREGRINE_RUNTIME_DIR "/alloc.hpp");
+    }
+    for(auto& header:m_runtime_headers){
+        res.push_back(PEREGRINE_RUNTIME_DIR "/"+header);
+    }
+    return res;
+}
+
+void Codegen::print_layouts() {
+    for(auto& layout:m_layouts){
+        std::cout<<layout;
+    }
+}
 
 std::string Codegen::write(std::string_view code) {
     if(save){
@@ -74,6 +131,10 @@ std::string Codegen::write(std::string_view code) {
     return res;
 }
 
+void Codegen::use_runtime(std::string header) {
+    m_runtime_headers.insert(header);
+}
+
 std::string Codegen::searchDefaultModule(std::string path,
                                          std::string moduleName) {
     for (auto& entry : std::filesystem::directory_iterator(path)) {
@@ -105,6 +166,9 @@ void Codegen::codegenFuncParams(std::vector<ast::parameter> parameters,size_t st
             else{
                 parameters[i].p_type->accept(*this);
             }
+            if(parameters[i].is_noalias){
+                write(" __restrict");
+            }
             write(" ");
             is_define=true;
             parameters[i].p_name->accept(*this);
@@ -119,26 +183,397 @@ void Codegen::codegenFuncParams(std::vector<ast::parameter> parameters,size_t st
     write("____P____exception_handler* ____Pexception_handlers=NULL");
 }
 
+void Codegen::runtimeBuiltins(const ast::Program& node) {
+    bool has_async=false;
+    std::vector<std::string> defined;
+    for (auto& stmt : node.statements()) {
+        auto function=stmt;
+        if(stmt->type()==ast::KAstAsync){
+            has_async=true;
+            function=std::dynamic_pointer_cast<ast::AsyncStatement>(stmt)->body();
+        }
+        else if(stmt->type()==ast::KAstDecorator){
+            function=std::dynamic_pointer_cast<ast::DecoratorStatement>(stmt)->body();
+        }
+        if(function->type()==ast::KAstFunctionDef){
+            defined.push_back(std::dynamic_pointer_cast<ast::FunctionDefinition>(function)->name()->stringify());
+        }
+        else if(function->type()==ast::KAstClassDef){
+            defined.push_back(std::dynamic_pointer_cast<ast::ClassDefinition>(function)->name()->stringify());
+        }
+        else if(stmt->type()==ast::KAstEnum){
+            defined.push_back(std::dynamic_pointer_cast<ast::EnumLiteral>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==ast::KAstUnion){
+            defined.push_back(std::dynamic_pointer_cast<ast::UnionLiteral>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==ast::KAstTypeDefinition){
+            defined.push_back(std::dynamic_pointer_cast<ast::TypeDefinition>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==ast::KAstVariableStmt){
+            defined.push_back(std::dynamic_pointer_cast<ast::VariableStatement>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==ast::KAstConstDecl){
+            defined.push_back(std::dynamic_pointer_cast<ast::ConstDeclaration>(stmt)->name()->stringify());
+        }
+        else if(stmt->type()==ast::KAstExternFuncDef){
+            m_extern_owners.push_back(std::dynamic_pointer_cast<ast::ExternFuncDef>(stmt)->owner());
+        }
+    }
+    //names of the program win over the runtime ones
+    auto builtin=[&](std::string name,std::string mangled){
+        if(std::find(defined.begin(),defined.end(),name)==defined.end()){
+            m_symbolMap.set_global(name,mangled);
+        }
+    };
+    //lib/iter.hpp is included once one of these is used
+    for(auto& name:{"range","span","map","filter","take","enumerate","zip","reduce","sum","count"}){
+        builtin(name,std::string("Peregrine::iter::")+name);
+    }
+    //lib/channel.hpp
+    for(auto& name:{"channel","spsc_channel","atomic"}){
+        builtin(name,std::string("Peregrine::")+name);
+    }
+    //lib/soa.hpp
+    builtin("soa_list","Peregrine::soa_list");
+    //lib/simd.hpp
+    builtin("vec","Peregrine::vec");
+    //c in def c.func(), a local or parameter named c hides it
+    for(auto& owner:m_extern_owners){
+        builtin(owner,owner);
+    }
+    //branch hints, they are not functions
+    builtin("likely","__builtin_expect");
+    builtin("unlikely","__builtin_expect");
+    //the event loop is only pulled in by programs that have async functions
+    if(!has_async){
+        return;
+    }
+    use_runtime("async.hpp");
+    for(auto& name:{"sleep","yield_now","run","read","write","close","pipe","listen","local_port","accept","connect"}){
+        builtin(name,std::string("Peregrine::")+name);
+    }
+}
+
 bool Codegen::visit(const ast::Program& node) {
+    runtimeBuiltins(node);
     for (auto& stmt : node.statements()) {
-        stmt->accept(*this);
+        if(stmt->type()!=ast::KAstDecorator){
+            continue;
+        }
+        auto decorated=std::dynamic_pointer_cast<ast::DecoratorStatement>(stmt);
+        for(auto& x:decorated->decoratorItem()){
+            if(decorated->body()->type()==ast::KAstFunctionDef && x->type()==ast::KAstIdentifier &&
+                (x->stringify()=="pure"||x->stringify()=="const")){
+                m_pure_functions.insert(std::dynamic_pointer_cast<ast::FunctionDefinition>(decorated->body())->name()->stringify());
+            }
+        }
+    }
+    for (auto& stmt : node.statements()) {
+        if(m_line_directives){
+            //lets the c++ compiler report locations in the peregrine source
+            write("#line "+std::to_string(stmt->token().line)+" \""+c_string(m_filename)+"\"\n");
+        }
+        if(stmt->type()==ast::KAstVariableStmt||stmt->type()==ast::KAstConstDecl){
+            globalVariable(stmt);
+        }
+        else{
+            stmt->accept(*this);
+        }
         write(";\n");
     }
     return true;
 }
 
+//whether the c++ compiler can evaluate the initialiser of a global
+bool Codegen::constantExpression(ast::AstNodePtr node){
+    switch(node->type()){
+        case ast::KAstInteger:
+        case ast::KAstDecimal:
+        case ast::KAstBool:
+        case ast::KAstNone:{
+            return true;
+        }
+        case ast::KAstIdentifier:{
+            return m_constant_globals.count(node->stringify())>0;
+        }
+        case ast::KAstBinaryOp:{
+            auto op=std::dynamic_pointer_cast<ast::BinaryOperation>(node);
+            auto kind=op->token().tkType;
+            return kind!=tk_pipeline&&kind!=tk_in&&kind!=tk_not_in&&
+                   constantExpression(op->left())&&constantExpression(op->right());
+        }
+        case ast::KAstPrefixExpr:{
+            auto op=std::dynamic_pointer_cast<ast::PrefixExpression>(node);
+            auto prefix=op->prefix().keyword;
+            return (prefix=="-"||prefix=="+"||prefix=="~"||prefix=="not")&&constantExpression(op->right());
+        }
+        default:{
+            return false;
+        }
+    }
+}
+
+//a global with a constant initialiser is constinit (constexpr if it is a
+//constant) so it costs nothing at startup. any other one is a function that
+//initialises it the first time it is called, then returns it. uses of the
+//global call the function, so a program only initialises what it uses
+void Codegen::globalVariable(ast::AstNodePtr stmt){
+    static const std::set<std::string> scalars={"int","i8","i16","i32","i64","uint","u8","u16","u32","u64",
+                                                "float","f32","f64","f128","bool","char"};
+    bool is_const=stmt->type()==ast::KAstConstDecl;
+    ast::AstNodePtr type,name,value;
+    if(is_const){
+        auto decl=std::dynamic_pointer_cast<ast::ConstDeclaration>(stmt);
+        type=decl->constType();
+        name=decl->name();
+        value=decl->value();
+    }
+    else{
+        auto decl=std::dynamic_pointer_cast<ast::VariableStatement>(stmt);
+        type=decl->varType();
+        name=decl->name();
+        value=decl->value();
+    }
+    bool has_type=type->type()!=ast::KAstNoLiteral;
+    bool has_value=value->type()!=ast::KAstNoLiteral;
+    if(!has_type&&!has_value){
+        stmt->accept(*this);
+        return;
+    }
+    bool scalar=!has_type||type->type()==ast::KAstPointerTypeExpr||
+                (type->type()==ast::KAstTypeExpr&&scalars.count(type->stringify())>0);
+    std::string type_name=has_type?render([&]{type->accept(*this);}):"auto";
+    is_define=true;
+    std::string mangled=render([&]{name->accept(*this);});
+    is_define=false;
+    if(scalar&&(!has_value||constantExpression(value))){
+        if(is_const){
+            m_constant_globals.insert(name->stringify());
+        }
+        write((is_const?"constexpr ":"constinit ")+type_name+" "+mangled);
+        if(has_value){
+            write(" = ");
+            value->accept(*this);
+        }
+        else{
+            write("{}");
+        }
+        return;
+    }
+    std::string qualifier=is_const?"const ":"";
+    write(qualifier+type_name+"& "+mangled+"() noexcept {\n");
+    write("static "+qualifier+type_name+" ____P____VALUE");
+    if(has_value){
+        write(" = ");
+        value->accept(*this);
+    }
+    else{
+        write("{}");
+    }
+    write(";\nreturn ____P____VALUE;\n}");
+    m_lazy_globals.insert(mangled);
+}
+
 bool Codegen::visit(const ast::BlockStatement& node) {
     for (auto& stmt : node.statements()) {
         write("    ");
+        if(m_profile_alloc){
+            //allocation site of everything this statement allocates
+            write("Peregrine::alloc_site="+std::to_string(stmt->token().line)+";\n    ");
+        }
+        if(m_pure_functions.size()>0&&!m_hoist_locals){
+            commonCalls(stmt);
+        }
         stmt->accept(*this);
+        m_common_calls.clear();
         write(";\n");
     }
     return true;
 }
 
+//the calls of pure functions in an expression that always run, the arguments
+//of a call come before it. false if the expression can change what they return
+bool Codegen::pureCalls(ast::AstNodePtr node,std::vector<ast::AstNodePtr>& calls){
+    switch(node->type()){
+        case ast::KAstIdentifier:
+        case ast::KAstInteger:
+        case ast::KAstDecimal:
+        case ast::KAstString:
+        case ast::KAstBool:
+        case ast::KAstNone:{
+            return true;
+        }
+        case ast::KAstBinaryOp:{
+            auto op=std::dynamic_pointer_cast<ast::BinaryOperation>(node);
+            if(op->token().tkType==tk_and||op->token().tkType==tk_or){
+                //the right side may not run at all, so its calls can't be made
+                //before the statement. it still must not write
+                std::vector<ast::AstNodePtr> conditional;
+                return pureCalls(op->left(),calls)&&pureCalls(op->right(),conditional);
+            }
+            return op->token().tkType!=tk_pipeline&&pureCalls(op->left(),calls)&&pureCalls(op->right(),calls);
+        }
+        case ast::KAstPrefixExpr:{
+            auto op=std::dynamic_pointer_cast<ast::PrefixExpression>(node);
+            if(op->prefix().tkType==tk_increment||op->prefix().tkType==tk_decrement){
+                return false;
+            }
+            return pureCalls(op->right(),calls);
+        }
+        case ast::KAstDotExpression:{
+            auto dot=std::dynamic_pointer_cast<ast::DotExpression>(node);
+            return dot->referenced()->type()==ast::KAstIdentifier&&pureCalls(dot->owner(),calls);
+        }
+        case ast::KAstListOrDictAccess:{
+            auto access=std::dynamic_pointer_cast<ast::ListOrDictAccess>(node);
+            for(auto& key:access->keyOrIndex()){
+                if(!pureCalls(key,calls)){
+                    return false;
+                }
+            }
+            return pureCalls(access->container(),calls);
+        }
+        case ast::KAstFunctionCall:{
+            auto call=std::dynamic_pointer_cast<ast::FunctionCall>(node);
+            if(call->name()->type()!=ast::KAstIdentifier||!m_pure_functions.count(call->name()->stringify())){
+                return false;
+            }
+            for(auto& arg:call->arguments()){
+                if(!pureCalls(arg,calls)){
+                    return false;
+                }
+            }
+            calls.push_back(node);
+            return true;
+        }
+        default:{
+            return false;
+        }
+    }
+}
+
+//a pure call that is repeated with the same arguments in a statement is made
+//once before it. nothing else in the statement may write, so that it returns
+//the same every time
+void Codegen::commonCalls(ast::AstNodePtr stmt){
+    std::vector<ast::AstNodePtr> calls;
+    bool pure=false;
+    switch(stmt->type()){
+        case ast::KAstVariableStmt:{
+            auto var=std::dynamic_pointer_cast<ast::VariableStatement>(stmt);
+            pure=pureCalls(var->name(),calls)&&pureCalls(var->value(),calls);
+            break;
+        }
+        case ast::KAstConstDecl:{
+            pure=pureCalls(std::dynamic_pointer_cast<ast::ConstDeclaration>(stmt)->value(),calls);
+            break;
+        }
+        case ast::KAstReturnStatement:{
+            pure=!m_is_generator&&pureCalls(std::dynamic_pointer_cast<ast::ReturnStatement>(stmt)->returnValue(),calls);
+            break;
+        }
+        default:{}
+    }
+    if(!pure){
+        return;
+    }
+    std::map<std::string,size_t> count;
+    for(auto& call:calls){
+        count[call->stringify()]++;
+    }
+    for(auto& call:calls){
+        auto key=call->stringify();
+        if(count[key]<2||m_common_calls.count(key)){
+            continue;
+        }
+        std::string local="____P____CSE"+std::to_string(m_common_call_count++);
+        write("auto "+local+"="+render([&]{call->accept(*this);})+";\n    ");
+        m_common_calls[key]=local;
+    }
+}
+
 bool Codegen::visit(const ast::ImportStatement& node) { return true; }
 
+std::string Codegen::render(std::function<void()> emit) {
+    //code that has to be placed somewhere else than where it is visited
+    bool prev_save=save;
+    std::string prev_res=res;
+    save=true;
+    res="";
+    emit();
+    std::string code=res;
+    save=prev_save;
+    res=prev_res;
+    return code;
+}
+
+void Codegen::hoist(std::string name,std::string declaration) {
+    for(auto& member:m_generator_members){
+        if(member.first==name){
+            return;
+        }
+    }
+    m_generator_members.push_back({name,declaration});
+}
+
+void Codegen::generator(const ast::FunctionDefinition& node) {
+    //a function that yields becomes a struct that keeps the parameters and
+    //locals as members. next() switches on the yield it stopped at and jumps
+    //right behind it, __iter__ resumes it once for every iteration of a for loop
+    use_runtime("generator.hpp");
+    is_define=true;
+    std::string name=render([&]{node.name()->accept(*this);});
+    is_define=false;
+    is_func_def=true;
+    local_mangle_start();
+    std::string value_type=render([&]{node.returnType()->accept(*this);});
+    std::string members;
+    std::string init;
+    for(auto& param:node.parameters()){
+        std::string param_type=render([&]{param.p_type->accept(*this);});
+        is_define=true;
+        std::string param_name=render([&]{param.p_name->accept(*this);});
+        is_define=false;
+        members+=param_type+" "+param_name+";\n";
+        init+=","+param_name+"("+param_name+")";
+    }
+    std::string params=render([&]{codegenFuncParams(node.parameters());});
+    m_is_generator=true;
+    m_hoist_locals=true;
+    m_yields=0;
+    m_generator_loops=0;
+    m_generator_members.clear();
+    std::string body=render([&]{node.body()->accept(*this);});
+    m_is_generator=false;
+    m_hoist_locals=false;
+    local_mangle_end();
+    is_func_def=false;
+    write("struct "+name+" {\n");
+    write("int ____P____state=0;\n");
+    write("____P____exception_handler* ____Pexception_handlers;\n");
+    write(members);
+    write(value_type+" ____P____value;\n");
+    for(auto& member:m_generator_members){
+        write(member.second+";\n");
+    }
+    write(name+"("+params+") noexcept :____Pexception_handlers(____Pexception_handlers)"+init+"{}\n");
+    write("bool ____P____next() noexcept {\nswitch (____P____state) {\ncase 0:;\n");
+    write(body);
+    write("}\n____P____state=-1;\nreturn false;\n}\n");
+    //raises go to the handlers of the loop that is iterating right now
+    write("size_t ____mem____P____P______iter__(____P____exception_handler* ____P____handlers=NULL) noexcept {\n");
+    write("____Pexception_handlers=____P____handlers;\n");
+    write("return ____P____next()?SIZE_MAX:0;\n}\n");
+    write(value_type+" ____mem____P____P______iterate__(____P____exception_handler* ____P____handlers=NULL) noexcept {\n");
+    write("return ____P____value;\n}\n}");
+}
+
 bool Codegen::visit(const ast::FunctionDefinition& node) {
+    if(!is_func_def && ast::containsYield(node.body())){
+        generator(node);
+        return true;
+    }
     auto return_type=TurpleTypes(node.returnType());
     auto functionName =
         std::dynamic_pointer_cast<ast::IdentifierExpression>(node.name())
@@ -155,6 +590,13 @@ bool Codegen::visit(const ast::FunctionDefinition& node) {
             write("return 0;\n}");
             local_mangle_end();
         } else {
+            //loops are what the vectoriser can do something with on a wider isa
+            if(m_function_attributes.find("TARGET_CLONES")==std::string::npos&&m_march_dispatch&&
+                (ast::containsStatement(node.body(),ast::KAstForStatement)||ast::containsStatement(node.body(),ast::KAstWhileStmt))){
+                m_function_attributes=targetClones({});
+            }
+            write(m_function_attributes);
+            m_function_attributes="";
             if(return_type.size()==0){
                 node.returnType()->accept(*this);
             }
@@ -179,7 +621,12 @@ bool Codegen::visit(const ast::FunctionDefinition& node) {
                 }
             }
             write(")  noexcept {\n");
-            node.body()->accept(*this);
+            if(m_cache!=""){
+                cachedBody(node);
+            }
+            else{
+                node.body()->accept(*this);
+            }
             write("\n}");
             local_mangle_end();
         }
@@ -219,6 +666,21 @@ bool Codegen::visit(const ast::FunctionDefinition& node) {
 }
 
 bool Codegen::visit(const ast::VariableStatement& node) {
+    if (m_hoist_locals && node.varType()->type() != ast::KAstNoLiteral) {
+        std::string var_type=render([&]{node.varType()->accept(*this);});
+        is_define=true;
+        std::string var=render([&]{node.name()->accept(*this);});
+        is_define=false;
+        hoist(var,var_type+" "+var);
+        write(var+" = ");
+        if (node.value()->type() != ast::KAstNoLiteral) {
+            node.value()->accept(*this);
+        }
+        else{
+            write("{}");
+        }
+        return true;
+    }
     if (node.varType()->type() != ast::KAstNoLiteral) {
         node.varType()->accept(*this);
         is_define=true;
@@ -237,6 +699,19 @@ bool Codegen::visit(const ast::VariableStatement& node) {
 }
 
 bool Codegen::visit(const ast::ConstDeclaration& node) {
+    if (m_hoist_locals) {
+        std::string value=render([&]{node.value()->accept(*this);});
+        std::string const_type="std::decay_t<decltype("+value+")>";
+        if (node.constType()->type()!=ast::KAstNoLiteral){
+            const_type=render([&]{node.constType()->accept(*this);});
+        }
+        is_define=true;
+        std::string name=render([&]{node.name()->accept(*this);});
+        is_define=false;
+        hoist(name,const_type+" "+name);
+        write(name+"="+value);
+        return true;
+    }
     write("const ");
     if (node.constType()->type()!=ast::KAstNoLiteral){
         node.constType()->accept(*this);
@@ -269,10 +744,28 @@ bool Codegen::visit(const ast::PassStatement& node) {
     return true;
 }
 
+//an arm that raises is only taken when something went wrong
+static bool raises(ast::AstNodePtr body) {
+    if(body->type()!=ast::KAstBlockStmt){
+        return false;
+    }
+    for(auto& stmt:std::dynamic_pointer_cast<ast::BlockStatement>(body)->statements()){
+        if(stmt->type()==ast::KAstRaiseStmt){
+            return true;
+        }
+    }
+    return false;
+}
+
 bool Codegen::visit(const ast::IfStatement& node) {
+    std::string likelihood=m_if_likelihood;
+    m_if_likelihood="";
+    if(likelihood==""&&raises(node.ifBody())){
+        likelihood="[[unlikely]] ";
+    }
     write("if (");
     node.condition()->accept(*this);
-    write(") {\n");
+    write(") "+likelihood+"{\n");
     local_mangle_start();
     node.ifBody()->accept(*this);
     local_mangle_end();
@@ -284,7 +777,7 @@ bool Codegen::visit(const ast::IfStatement& node) {
         for (auto& body : elifNode) { // making sure that elif exists
             write("else if (");
             body.first->accept(*this);
-            write(") {\n");
+            write(raises(body.second)?") [[unlikely]] {\n":") {\n");
             local_mangle_start();
             body.second->accept(*this);
             local_mangle_end();
@@ -295,7 +788,7 @@ bool Codegen::visit(const ast::IfStatement& node) {
     auto elseNode = node.elseBody();
     if (elseNode->type() ==
         ast::KAstBlockStmt) { // making sure that else exists
-        write("\nelse {\n");
+        write(raises(elseNode)?"\nelse [[unlikely]] {\n":"\nelse {\n");
         local_mangle_start();
         elseNode->accept(*this);
         local_mangle_end();
@@ -316,20 +809,70 @@ bool Codegen::visit(const ast::WhileStatement& node) {
 }
 
 bool Codegen::visit(const ast::ForStatement& node) {
-    write("{\nauto ____P____VALUE=");
+    if (m_hoist_locals && ast::containsYield(node.body())) {
+        generatorFor(node);
+        return true;
+    }
+    //nothing in the loop is resumed, so its locals can stay on the stack
+    bool hoist_locals=m_hoist_locals;
+    m_hoist_locals=false;
+    //range(stop) and range(start,stop) are counted directly, the compiler can
+    //vectorise such a loop (over the columns of a soa_list for example)
+    std::vector<ast::AstNodePtr> range;
+    auto sequence=node.sequence();
+    if(sequence->type()==ast::KAstFunctionCall && node.variable().size()==1 && m_symbolMap["range"]=="Peregrine::iter::range"){
+        auto call=std::dynamic_pointer_cast<ast::FunctionCall>(sequence);
+        if(call->name()->type()==ast::KAstIdentifier && call->name()->stringify()=="range"){
+            range=call->arguments();
+        }
+    }
+    if(range.size()==1||range.size()==2){
+        write("{\nint64_t ____P____START=");
+        if(range.size()==2){
+            range[0]->accept(*this);
+        }
+        else{
+            write("0");
+        }
+        write(",____P____STOP=");
+        range.back()->accept(*this);
+        write(";\n");
+        write("for (int64_t ____P____i=____P____START;____P____i<____P____STOP;++____P____i){\n");
+        local_mangle_start();
+        write("int64_t ");
+        is_define=true;
+        node.variable()[0]->accept(*this);
+        is_define=false;
+        write("=____P____i;\n");
+        node.body()->accept(*this);
+        local_mangle_end();
+        write("\n}\n}");
+        m_hoist_locals=hoist_locals;
+        return true;
+    }
+    //a sequence with a cursor of its own is copied, so the loop doesn't move
+    //the cursor of the original. the channels and atomics that can't be
+    //copied are the exception, a loop over one takes the values out of the
+    //original. anything walked by index (see lib/generator.hpp) is not copied
+    use_runtime("generator.hpp");
+    write("{\nauto&& ____P____SEQUENCE=");
     node.sequence()->accept(*this);
     write(";\n");
-    write("for (size_t ____P____i=0;____P____i<____P____VALUE.____mem____P____P______iter__(____Pexception_handlers);++____P____i){\n");
+    write("using ____P____SEQUENCE_T=std::decay_t<decltype(____P____SEQUENCE)>;\n");
+    write("std::conditional_t<std::is_copy_constructible_v<____P____SEQUENCE_T>&&Peregrine::has_cursor<____P____SEQUENCE_T>,");
+    write("____P____SEQUENCE_T,decltype(____P____SEQUENCE)> ");
+    write("____P____VALUE=std::forward<decltype(____P____SEQUENCE)>(____P____SEQUENCE);\n");
+    write("for (size_t ____P____i=0;____P____i<Peregrine::loop_end(____P____VALUE,____Pexception_handlers);++____P____i){\n");
     local_mangle_start();
     if (node.variable().size()==1){
         write("auto ");
         is_define=true;
         node.variable()[0]->accept(*this);
         is_define=false;
-        write("=____P____VALUE.____mem____P____P______iterate__(____Pexception_handlers);\n");
+        write("=Peregrine::loop_item(____P____VALUE,____P____i,____Pexception_handlers);\n");
     }
     else{
-        write("auto ____P____TEMP=____P____VALUE.____mem____P____P______iterate__(____Pexception_handlers);\n");
+        write("auto ____P____TEMP=Peregrine::loop_item(____P____VALUE,____P____i,____Pexception_handlers);\n");
         for (size_t i=0;i<node.variable().size();++i){
             auto x=node.variable()[i];
             write("auto ");
@@ -344,9 +887,149 @@ bool Codegen::visit(const ast::ForStatement& node) {
     node.body()->accept(*this);
     local_mangle_end();
     write("\n}\n}");
+    m_hoist_locals=hoist_locals;
     return true;
 }
 
+void Codegen::generatorFor(const ast::ForStatement& node) {
+    //the sequence, the index and the loop variables have to survive a yield
+    //inside the loop, so they are members of the generator as well
+    std::string id=std::to_string(m_generator_loops++);
+    std::string sequence=render([&]{node.sequence()->accept(*this);});
+    std::string sequence_type="std::decay_t<decltype("+sequence+")>";
+    std::string value="____P____VALUE"+id;
+    std::string index="____P____i"+id;
+    hoist(value,"std::optional<"+sequence_type+"> "+value);
+    hoist(index,"size_t "+index);
+    write(value+".emplace("+sequence+");\n");
+    write("for ("+index+"=0;"+index+"<Peregrine::loop_end(*"+value+",____Pexception_handlers);++"+index+"){\n");
+    local_mangle_start();
+    std::string item_type="Peregrine::iterate_t<"+sequence_type+">";
+    auto variables=node.variable();
+    if (variables.size()==1){
+        is_define=true;
+        std::string var=render([&]{variables[0]->accept(*this);});
+        is_define=false;
+        hoist(var,item_type+" "+var);
+        write(var+"=Peregrine::loop_item(*"+value+","+index+",____Pexception_handlers);\n");
+    }
+    else{
+        std::string temp="____P____TEMP"+id;
+        hoist(temp,item_type+" "+temp);
+        write(temp+"=Peregrine::loop_item(*"+value+","+index+",____Pexception_handlers);\n");
+        for (size_t i=0;i<variables.size();++i){
+            is_define=true;
+            std::string var=render([&]{variables[i]->accept(*this);});
+            is_define=false;
+            hoist(var,"Peregrine::getitem_t<"+item_type+"> "+var);
+            write(var+"="+temp+".____mem____P____P______getitem__("+std::to_string(i)+",____Pexception_handlers);\n");
+        }
+    }
+    node.body()->accept(*this);
+    local_mangle_end();
+    write("\n}\n"+value+".reset()");
+}
+
+void Codegen::parallelFor(std::vector<ast::AstNodePtr> decorators,std::shared_ptr<ast::ForStatement> loop) {
+    //the validator only lets @parallel or @parallel(chunk=n,sum=var,...) through
+    use_runtime("parallel.hpp");
+    ast::AstNodePtr chunk;
+    std::vector<std::pair<std::string,ast::AstNodePtr>> reductions;
+    if(decorators[0]->type()==ast::KAstFunctionCall){
+        for(auto& arg:std::dynamic_pointer_cast<ast::FunctionCall>(decorators[0])->arguments()){
+            auto option=std::dynamic_pointer_cast<ast::DefaultArg>(arg);
+            auto name=std::dynamic_pointer_cast<ast::IdentifierExpression>(option->name())->value();
+            if(name=="chunk"){
+                chunk=option->value();
+            }
+            else{
+                reductions.push_back({name,option->value()});
+            }
+        }
+    }
+    //range(stop) and range(start,stop) are counted directly, anything else is
+    //indexed with __getitem__ from 0 to __len__()
+    std::vector<ast::AstNodePtr> range;
+    auto sequence=loop->sequence();
+    if(sequence->type()==ast::KAstFunctionCall && m_symbolMap["range"]=="Peregrine::iter::range"){
+        auto call=std::dynamic_pointer_cast<ast::FunctionCall>(sequence);
+        if(call->name()->type()==ast::KAstIdentifier &&
+            std::dynamic_pointer_cast<ast::IdentifierExpression>(call->name())->value()=="range"){
+            range=call->arguments();
+        }
+    }
+    write("{\n");
+    if(range.size()==0){
+        write("auto&& ____P____VALUE=");
+        sequence->accept(*this);
+        write(";\n");
+    }
+    if(reductions.size()>0){
+        write("std::mutex ____P____REDUCE;\n");
+    }
+    write("Peregrine::parallel_for(");
+    if(range.size()==0){
+        write("0,(int64_t)____P____VALUE.____mem____P____P______len__(),");
+    }
+    else if(range.size()==1){
+        write("0,");
+        range[0]->accept(*this);
+        write(",");
+    }
+    else{
+        range[0]->accept(*this);
+        write(",");
+        range[1]->accept(*this);
+        write(",");
+    }
+    if(chunk){
+        chunk->accept(*this);
+    }
+    else{
+        write("0");
+    }
+    write(",[&](int64_t ____P____lo,int64_t ____P____hi){\n");
+    local_mangle_start();
+    //a raise can't jump into the stack of another thread
+    write("____P____exception_handler* ____Pexception_handlers=NULL;\n");
+    for(size_t i=0;i<reductions.size();++i){
+        std::string outer="____P____OUTER"+std::to_string(i);
+        std::string var_type="std::remove_reference_t<decltype("+outer+")>";
+        write("auto& "+outer+"=");
+        reductions[i].second->accept(*this);
+        write(";\n"+var_type+" ");
+        reductions[i].second->accept(*this);
+        write("=Peregrine::reduce_identity<Peregrine::reduce_op::"+reductions[i].first+","+var_type+">();\n");
+    }
+    write("for (int64_t ____P____i=____P____lo;____P____i<____P____hi;++____P____i){\n");
+    if(range.size()==0){
+        write("auto ");
+        is_define=true;
+        loop->variable()[0]->accept(*this);
+        is_define=false;
+        write("=____P____VALUE.____mem____P____P______getitem__(____P____i);\n");
+    }
+    else{
+        write("int64_t ");
+        is_define=true;
+        loop->variable()[0]->accept(*this);
+        is_define=false;
+        write("=____P____i;\n");
+    }
+    loop->body()->accept(*this);
+    write("\n}\n");
+    if(reductions.size()>0){
+        write("std::lock_guard<std::mutex> ____P____guard(____P____REDUCE);\n");
+    }
+    for(size_t i=0;i<reductions.size();++i){
+        write("Peregrine::reduce_combine<Peregrine::reduce_op::"+reductions[i].first+">(____P____OUTER"+std::to_string(i)+",");
+        reductions[i].second->accept(*this);
+        write(");\n");
+    }
+    local_mangle_end();
+    write("});\n}");
+}
+
 bool Codegen::visit(const ast::MatchStatement& node) {
     auto toMatch = node.matchItem();
     auto cases = node.caseBody();
@@ -392,19 +1075,53 @@ bool Codegen::visit(const ast::MatchStatement& node) {
 
 bool Codegen::visit(const ast::ScopeStatement& node) {
     write("{\n");
+    //the tasks it spawns are joined before it is left
+    bool spawns=!m_is_async && ast::containsStatement(node.body(),ast::KAstSpawn);
+    if(spawns){
+        use_runtime("scope.hpp");
+        write("Peregrine::scope<____P____exception_handler> ____P____SCOPE;\n");
+    }
+    if(spawns){
+        //a raise in the body lands here first so the tasks, which may use its
+        //locals, are joined before the error leaves the scope
+        write("jmp_buf ____P____SCOPE_BUF;\n");
+        write("____P____exception_handler ____P____SCOPE_RAISED={&____P____SCOPE_BUF};\n");
+        write("if(!setjmp(____P____SCOPE_BUF)){\n");
+        write("____P____exception_handler* ____Pexception_handlers=&____P____SCOPE_RAISED;\n");
+    }
     local_mangle_start();
     node.body()->accept(*this);
     local_mangle_end();
+    if(spawns){
+        write(";\n}else{\n");
+        write("____P____SCOPE.join();\n");
+        write("if(____Pexception_handlers!=NULL){\n");
+        write("____Pexception_handlers->err=____P____SCOPE_RAISED.err;\n");
+        write("____Pexception_handlers->handler=____P____SCOPE_RAISED.handler;\n");
+        write("longjmp(*(____Pexception_handlers->buf),1);\n}else{\n");
+        write("____P____SCOPE_RAISED.handler();}\n}");
+        //the first error of a task is raised again here
+        write(";\nif(auto ____P____ERROR=____P____SCOPE.join()){\n");
+        write("if(____Pexception_handlers!=NULL){\n");
+        write("____Pexception_handlers->err=____P____ERROR->err;\n");
+        write("____Pexception_handlers->handler=____P____ERROR->handler;\n");
+        write("longjmp(*(____Pexception_handlers->buf),1);\n}else{\n");
+        write("____P____ERROR->handler();}\n}");
+    }
     write("\n}");
     return true;
 }
 
 
 bool Codegen::visit(const ast::ReturnStatement& node) {
+    if(m_is_generator){
+        write("____P____state=-1;\nreturn false");
+        return true;
+    }
     if(node.returnValue()->type()!=ast::KAstNoLiteral){
         auto return_values=TurpleExpression(node.returnValue()); 
         if(return_values.size()==0){
-            write("return ");
+            write(m_is_async?"co_return ":"return ");
             node.returnValue()->accept(*this);
         }
         else{
@@ -420,7 +1137,7 @@ bool Codegen::visit(const ast::ReturnStatement& node) {
         }
     }
     else{
-        write("return ");
+        write(m_is_async?"co_return ":"return ");
     }
     return true;
 }
@@ -438,6 +1155,39 @@ bool Codegen::visit(const ast::BreakStatement& node) {
 bool Codegen::visit(const ast::DecoratorStatement& node) {
     auto items = node.decoratorItem();
     auto body = node.body();
+    if(body->type()==ast::KAstForStatement){
+        parallelFor(items,std::dynamic_pointer_cast<ast::ForStatement>(body));
+        return true;
+    }
+    if(body->type()==ast::KAstClassDef){
+        m_class_alignment=alignment(items);
+        body->accept(*this);
+        return true;
+    }
+    if(body->type()==ast::KAstIfStmt){
+        m_if_likelihood="[["+items[0]->stringify()+"]] ";
+        body->accept(*this);
+        return true;
+    }
+    if(body->type()==ast::KAstFunctionDef&&!is_func_def){
+        //these dont wrap the function, it is still defined as one
+        std::vector<ast::AstNodePtr> attributes;
+        for(auto& x:items){
+            auto size=cacheSize(x);
+            if(size!=""){
+                m_cache=size;
+            }
+            else{
+                attributes.push_back(x);
+            }
+        }
+        m_function_attributes=attributes.size()>0?functionAttributes(attributes):"";
+        if(m_function_attributes!=""||(m_cache!=""&&attributes.size()==0)){
+            body->accept(*this);
+            return true;
+        }
+        m_cache="";
+    }
     std::string contains;
     std::string x;
     std::string prev;
@@ -620,6 +1370,21 @@ bool Codegen::visit(const ast::PostfixExpression& node) {
     return true;
 }
 bool Codegen::visit(const ast::FunctionCall& node) {
+    if(node.name()->type()==ast::KAstIdentifier&&m_symbolMap[node.name()->stringify()]=="__builtin_expect"&&
+        node.arguments().size()==1){
+        //likely(x) and unlikely(x), which way x usually goes
+        write("__builtin_expect(!!(");
+        node.arguments()[0]->accept(*this);
+        write(node.name()->stringify()=="likely"?"),1)":"),0)");
+        return true;
+    }
+    if(m_common_calls.size()>0){
+        auto local=m_common_calls.find(node.stringify());
+        if(local!=m_common_calls.end()){
+            write(local->second);
+            return true;
+        }
+    }
     node.name()->accept(*this);
     write("(");
     handle_ref_start()
@@ -657,6 +1422,23 @@ bool Codegen::visit(const ast::ArrowExpression& node) {
 
 
 bool Codegen::visit(const ast::DotExpression& node) {
+    if(node.owner()->type()==ast::KAstIdentifier && node.referenced()->type()==ast::KAstFunctionCall){
+        std::string owner=std::dynamic_pointer_cast<ast::IdentifierExpression>(node.owner())->value();
+        if(std::count(m_extern_owners.begin(),m_extern_owners.end(),owner)&&m_symbolMap[owner]==owner){
+            //c functions dont take the exception handlers
+            auto call=std::dynamic_pointer_cast<ast::FunctionCall>(node.referenced());
+            write(std::dynamic_pointer_cast<ast::IdentifierExpression>(call->name())->value()+"(");
+            auto args=call->arguments();
+            for(size_t i=0;i<args.size();++i){
+                if(i){
+                    write(", ");
+                }
+                args[i]->accept(*this);
+            }
+            write(")");
+            return true;
+        }
+    }
     bool x=is_ref;
     is_ref=true;
     if(node.owner()->type()!=ast::KAstDotExpression||node.owner()->type()!=ast::KAstArrowExpression){
@@ -720,18 +1502,61 @@ bool Codegen::visit(const ast::IdentifierExpression& node) {
     else if(is_define && local){
         m_symbolMap.set_local(x);
     }
-    write(m_symbolMap[x]);
+    auto name=m_symbolMap[x];
+    useRuntimeOf(name);
+    write(name);
+    if(!is_define&&m_lazy_globals.count(name)>0){
+        write("()");
+    }
     return true;
 }
 
+void Codegen::useRuntimeOf(std::string name) {
+    if(name.rfind("Peregrine::iter::",0)==0){
+        use_runtime("iter.hpp");
+    }
+    else if(name=="Peregrine::channel"||name=="Peregrine::spsc_channel"||name=="Peregrine::atomic"){
+        use_runtime("channel.hpp");
+    }
+    else if(name=="Peregrine::soa_list"){
+        use_runtime("soa.hpp");
+    }
+    else if(name=="Peregrine::vec"){
+        use_runtime("simd.hpp");
+    }
+}
+
+//name{a,b} is name<a,b>
+void Codegen::genericTypes(std::vector<ast::AstNodePtr> types) {
+    if(types.size()==0){
+        return;
+    }
+    write("<");
+    for(size_t i=0;i<types.size();++i){
+        if(i){
+            write(",");
+        }
+        types[i]->accept(*this);
+    }
+    write(">");
+}
+
 bool Codegen::visit(const ast::TypeExpression& node) {
     auto x=node.value();
     if(!m_symbolMap.contains(x)){
         write(x);
     }
     else{
+        useRuntimeOf(m_symbolMap[x]);
         write(m_symbolMap[x]);
     }
+    genericTypes(node.generic_types());
+    return true;
+}
+
+bool Codegen::visit(const ast::GenericCall& node) {
+    node.identifier()->accept(*this);
+    genericTypes(node.generic_types());
     return true;
 }
 
@@ -803,7 +1628,7 @@ bool Codegen::visit(const ast::NoneLiteral& node) {
 bool Codegen::visit(const ast::AssertStatement& node){
     write("if(!(");
     node.condition()->accept(*this);
-    write(")){\n");
+    write(")) [[unlikely]] {\n");
     write("if(____Pexception_handlers!=NULL){\n");
     write("____Pexception_handlers->err=error________P____P____AssertionError;\n");
     write("____Pexception_handlers->handler=");
@@ -899,8 +1724,264 @@ bool Codegen::visit(const ast::RefTypeExpr& node){
     write("&");
     return true;
 }
+//@align(N) and @padded
+std::string Codegen::alignment(std::vector<ast::AstNodePtr> decorators){
+    std::string res;
+    for(auto& x:decorators){
+        if(x->type()==ast::KAstFunctionCall){
+            auto args=std::dynamic_pointer_cast<ast::FunctionCall>(x)->arguments();
+            res+="alignas("+args[0]->stringify()+") ";
+        }
+        else if(x->stringify()=="padded"){
+            use_runtime("layout.hpp");
+            res+="alignas(Peregrine::cache_line) ";
+        }
+    }
+    return res;
+}
+
+//empty if one of the decorators is not an attribute
+std::string Codegen::functionAttributes(std::vector<ast::AstNodePtr> decorators){
+    std::string standard;
+    std::string gnu;
+    for(auto& x:decorators){
+        if(x->type()==ast::KAstIdentifier&&(x->stringify()=="pure"||x->stringify()=="const"||
+                                            x->stringify()=="hot"||x->stringify()=="cold")){
+            standard+="[[gnu::"+x->stringify()+"]] ";
+            continue;
+        }
+        if(x->type()!=ast::KAstFunctionCall){
+            return "";
+        }
+        auto call=std::dynamic_pointer_cast<ast::FunctionCall>(x);
+        if(call->name()->stringify()=="target_clones"){
+            std::vector<std::string> targets;
+            for(auto& arg:call->arguments()){
+                targets.push_back(std::dynamic_pointer_cast<ast::StringLiteral>(arg)->value());
+            }
+            gnu+=targetClones(targets);
+        }
+        else{
+            return "";
+        }
+    }
+    //[[...]] has to come first
+    return standard+gnu;
+}
+
+//maxsize of @cache (0 is no limit) or @cache(maxsize=N), empty for other decorators
+std::string Codegen::cacheSize(ast::AstNodePtr decorator){
+    if(decorator->type()==ast::KAstIdentifier){
+        return decorator->stringify()=="cache"?"0":"";
+    }
+    if(decorator->type()!=ast::KAstFunctionCall){
+        return "";
+    }
+    auto call=std::dynamic_pointer_cast<ast::FunctionCall>(decorator);
+    if(call->name()->stringify()!="cache"){
+        return "";
+    }
+    auto size=call->arguments()[0];
+    if(size->type()==ast::KAstDefaultArg){
+        size=std::dynamic_pointer_cast<ast::DefaultArg>(size)->value();
+    }
+    return render([&]{size->accept(*this);});
+}
+
+//the body of a @cache function only runs for arguments that are not in its
+//table yet. the table is typed by the signature so the keys are not boxed
+void Codegen::cachedBody(const ast::FunctionDefinition& node){
+    use_runtime("cache.hpp");
+    std::string maxsize=m_cache;
+    m_cache="";
+    std::string return_type=render([&]{node.returnType()->accept(*this);});
+    std::string types;
+    std::string args;
+    for(auto& param:node.parameters()){
+        types+=(types==""?"":",")+render([&]{param.p_type->accept(*this);});
+        args+=(args==""?"":",")+render([&]{param.p_name->accept(*this);});
+    }
+    write("static thread_local Peregrine::cache<"+return_type+"("+types+")> ____P____CACHE("+maxsize+");\n");
+    write("return ____P____CACHE.get({"+args+"},[&]()->"+return_type+"{\n");
+    node.body()->accept(*this);
+    write("\n});");
+}
+
+//without targets the ones of -march-dispatch
+std::string Codegen::targetClones(std::vector<std::string> targets){
+    use_runtime("dispatch.hpp");
+    if(targets.size()==0){
+        targets={"avx2","avx512f"};
+    }
+    //what cpus that have none of the others run
+    if(std::find(targets.begin(),targets.end(),"default")==targets.end()){
+        targets.push_back("default");
+    }
+    std::string attribute="PEREGRINE_TARGET_CLONES(";
+    for(size_t i=0;i<targets.size();++i){
+        if(i){
+            attribute+=",";
+        }
+        attribute+="\""+targets[i]+"\"";
+    }
+    return attribute+") ";
+}
+
+//size and alignment of a field type on 64 bit targets. anything else (classes,
+//strings, lists) is counted as 8 bytes, which is what most of them are aligned to
+static std::pair<size_t,bool> fieldSize(ast::AstNodePtr type){
+    if(type->type()==ast::KAstPointerTypeExpr){
+        return {8,true};
+    }
+    static const std::map<std::string,size_t> sizes={
+        {"i8",1},{"u8",1},{"bool",1},{"char",1},
+        {"i16",2},{"u16",2},
+        {"i32",4},{"u32",4},{"f32",4},
+        {"int",8},{"uint",8},{"i64",8},{"u64",8},{"float",8},{"f64",8},
+        {"f128",16}
+    };
+    auto it=sizes.find(type->stringify());
+    if(it==sizes.end()){
+        return {8,false};
+    }
+    return {it->second,true};
+}
+
+//-reorder-fields: @hot fields first and then every group from the largest
+//alignment to the smallest, which leaves no padding between the fields.
+//static fields dont take space in objects and stay where they are, classes
+//that place their fields with @align or @padded are not touched
+std::vector<ast::AstNodePtr> Codegen::reorderFields(std::string name,std::vector<ast::AstNodePtr> attributes){
+    struct field{
+        ast::AstNodePtr node;
+        std::string name;
+        size_t size;
+        bool known;
+        bool hot;
+        std::string value;//the initialiser
+    };
+    std::vector<ast::AstNodePtr> res;
+    std::vector<field> fields;
+    for(auto& x:attributes){
+        auto body=x;
+        bool hot=false;
+        if(body->type()==ast::KAstDecorator){
+            auto decorated=std::dynamic_pointer_cast<ast::DecoratorStatement>(body);
+            for(auto& item:decorated->decoratorItem()){
+                if(item->stringify()!="hot"){
+                    m_layouts.push_back("class "+name+": kept, its fields use @align or @padded\n");
+                    return attributes;
+                }
+            }
+            hot=true;
+            body=decorated->body();
+        }
+        if(body->type()==ast::KAstPrivate){
+            body=std::dynamic_pointer_cast<ast::PrivateDef>(body)->definition();
+        }
+        if(body->type()==ast::KAstVariableStmt){
+            auto var=std::dynamic_pointer_cast<ast::VariableStatement>(body);
+            auto size=fieldSize(var->varType());
+            fields.push_back({x,var->name()->stringify()+":"+var->varType()->stringify(),size.first,size.second,hot,
+                              var->value()->type()==ast::KAstNoLiteral?"":var->value()->stringify()});
+        }
+        else if(body->type()==ast::KAstConstDecl){
+            auto var=std::dynamic_pointer_cast<ast::ConstDeclaration>(body);
+            auto size=fieldSize(var->constType());
+            fields.push_back({x,var->name()->stringify()+":"+var->constType()->stringify(),size.first,size.second,hot,
+                              var->value()->type()==ast::KAstNoLiteral?"":var->value()->stringify()});
+        }
+        else{
+            res.push_back(x);
+        }
+    }
+    //fields are initialised in the order they are declared, so one whose
+    //initialiser reads another field has to stay after it
+    for(auto& x:fields){
+        std::string word;
+        for(char ch:x.value+" "){
+            if(isalnum((unsigned char)ch)||ch=='_'){
+                word+=ch;
+                continue;
+            }
+            for(auto& other:fields){
+                if(!word.empty()&&&other!=&x&&other.name.substr(0,other.name.find(':'))==word){
+                    m_layouts.push_back("class "+name+": kept, the initialiser of "+x.name.substr(0,x.name.find(':'))+
+                                        " uses the field "+word+"\n");
+                    return attributes;
+                }
+            }
+            word="";
+        }
+    }
+    //the size of an object with the fields in this order
+    auto object_size=[](std::vector<field>& order){
+        size_t offset=0;
+        size_t align=1;
+        for(auto& x:order){
+            offset=(offset+x.size-1)/x.size*x.size+x.size;
+            align=std::max(align,x.size);
+        }
+        return (offset+align-1)/align*align;
+    };
+    size_t before=object_size(fields);
+    std::stable_sort(fields.begin(),fields.end(),[](const field& a,const field& b){
+        if(a.hot!=b.hot){
+            return a.hot;
+        }
+        return a.size>b.size;
+    });
+    size_t after=object_size(fields);
+    bool known=true;
+    std::string order;
+    for(auto& x:fields){
+        known=known&&x.known;
+        order+="    "+std::string(x.hot?"@hot ":"")+x.name+"\n";
+        res.push_back(x.node);
+    }
+    m_layouts.push_back("class "+name+": "+std::to_string(before)+" -> "+std::to_string(after)+" bytes"+
+                        (known?"":" (other classes, strings and lists counted as 8 bytes)")+"\n"+order);
+    return res;
+}
+
+//the fields of a class as the columns of a soa_list, see lib/soa.hpp. the
+//columns of a derived class would miss the fields of its parents, so it only
+//gets a declaration and soa_list rejects it. a const field is the same in
+//every object, the rows have it instead of a column
+void Codegen::soaColumns(std::string name,bool plain,std::vector<std::pair<std::string,std::string>> columns,std::vector<std::string> constants){
+    write("template<template<typename> class ____P____COLUMN>\nstruct ____P____SOA");
+    if(!plain){
+        write(";\n");
+        return;
+    }
+    std::string push,reserve,clear,row;
+    write("{\n");
+    for(auto& x:columns){
+        write("____P____COLUMN<"+x.first+"> "+x.second+";\n");
+        push+=x.second+".push(value."+x.second+");\n";
+        reserve+=x.second+".reserve(capacity);\n";
+        clear+=x.second+".clear();\n";
+        row+=(row.empty()?"":",")+x.second+"[index]";
+    }
+    write("struct ____P____ROW{\n");
+    for(auto& x:columns){
+        write(x.first+"& "+x.second+";\n");
+    }
+    for(auto& x:constants){
+        write(x+";\n");
+    }
+    write("};\n");
+    write("void ____P____push(const "+name+"& value){\n"+push+"}\n");
+    write("void ____P____reserve(size_t capacity){\n"+reserve+"}\n");
+    write("void ____P____clear(){\n"+clear+"}\n");
+    write("____P____ROW ____P____row(size_t index){\nreturn {"+row+"};\n}\n");
+    write("};\n");
+}
+
 bool Codegen::visit(const ast::ClassDefinition& node){
     write("class ");
+    write(m_class_alignment);
+    m_class_alignment="";
     is_define=true;
     node.name()->accept(*this);
     is_define=false;
@@ -925,10 +2006,32 @@ bool Codegen::visit(const ast::ClassDefinition& node){
     write("public:\n");
     {
         local_mangle_start();
-        for (auto& x : node.attributes()){
+        //the field after a @padded one starts a new cache line too
+        bool after_padded=false;
+        std::vector<std::pair<std::string,std::string>> columns;//type,name
+        std::vector<std::string> constants;
+        auto attributes=node.attributes();
+        if(m_reorder_fields){
+            attributes=reorderFields(node.name()->stringify(),attributes);
+        }
+        for (auto& x : attributes){
+            std::string align;
+            if(after_padded){
+                align="alignas(Peregrine::cache_line) ";
+                after_padded=false;
+            }
+            if(x->type()==ast::KAstDecorator){
+                auto field=std::dynamic_pointer_cast<ast::DecoratorStatement>(x);
+                align+=alignment(field->decoratorItem());
+                after_padded=align.find("Peregrine::cache_line")!=std::string::npos;
+                x=field->body();
+            }
+            write(align);
+            bool is_static=false;
             if(x->type()==ast::KAstStatic){
                 x = std::dynamic_pointer_cast<ast::StaticStatement>(x)->body();
                 write("static ");
+                is_static=true;
             }
             else if(x->type()==ast::KAstPrivate){
                 x = std::dynamic_pointer_cast<ast::PrivateDef>(x)->definition();
@@ -936,10 +2039,14 @@ bool Codegen::visit(const ast::ClassDefinition& node){
             switch(x->type()){
                 case ast::KAstVariableStmt:{
                     std::shared_ptr<ast::VariableStatement> var = std::dynamic_pointer_cast<ast::VariableStatement>(x);
-                    var->varType()->accept(*this);
+                    auto type=render([&]{var->varType()->accept(*this);});
+                    write(type);
                     write(" ____mem____P____P____");
                     auto str=std::dynamic_pointer_cast<ast::IdentifierExpression>(var->name())->value();
                     write(str);
+                    if(!is_static){
+                        columns.push_back({type,"____mem____P____P____"+str});
+                    }
                     m_symbolMap.set_local(str,"____mem____P____P____"+str);
                     if(var->value()->type()!=ast::KAstNoLiteral){
                         write(" = ");
@@ -950,31 +2057,47 @@ bool Codegen::visit(const ast::ClassDefinition& node){
                 }
                 case ast::KAstConstDecl:{
                     std::shared_ptr<ast::ConstDeclaration> var = std::dynamic_pointer_cast<ast::ConstDeclaration>(x);
-                    write("const ");
-                    var->constType()->accept(*this);
-                    write(" ____mem____P____P____");
                     auto str=std::dynamic_pointer_cast<ast::IdentifierExpression>(var->name())->value();
-                    write(str);
+                    std::string field="const "+render([&]{var->constType()->accept(*this);})+" ____mem____P____P____"+str;
                     m_symbolMap.set_local(str,"____mem____P____P____"+str);
                     if(var->value()->type()!=ast::KAstNoLiteral){
-                        write(" = ");
-                        var->value()->accept(*this);
+                        field+=" = "+render([&]{var->value()->accept(*this);});
+                    }
+                    write(field+";\n");
+                    if(!is_static){
+                        constants.push_back(field);
                     }
-                    write(";\n");
                     break;
                 }
                 default:{}
             }
         }
         local_mangle_end();
+        soaColumns(name,parents.size()==0,columns,constants);
     }
+    bool has_init=false;
     for (auto& x : node.methods()){
         if(x->type()==ast::KAstPrivate){
             x = std::dynamic_pointer_cast<ast::PrivateDef>(x)->definition();
         }
+        auto function=x;
+        if(x->type()==ast::KAstVirtual){
+            function=std::dynamic_pointer_cast<ast::VirtualStatement>(x)->body();
+        }
+        else if(x->type()==ast::KAstInline){
+            function=std::dynamic_pointer_cast<ast::InlineStatement>(x)->body();
+        }
+        if(function->type()==ast::KAstFunctionDef){
+            has_init=has_init||std::dynamic_pointer_cast<ast::FunctionDefinition>(function)->name()->stringify()=="__init__";
+        }
         magic_method(x,name);
         write(";\n");
     }
+    //Class() passes the exception handlers, without a constructor that would
+    //initialise the first field with them
+    if(!has_init){
+        write(name+"(____P____exception_handler* ____Pexception_handlers=NULL) noexcept {}\n");
+    }
     write("\n}");
     local_mangle_end();
     return true;
@@ -1050,7 +2173,8 @@ bool Codegen::visit(const ast::TryExcept& node){
         "____P____exception_handler ____exception_handlers={&____buf};\n"
         "____P____exception_handler* ____Pexception_handlers=&____exception_handlers;\n"
     );
-    write("if(!setjmp(*(____Pexception_handlers->buf))){\n");
+    //the except clauses are the cold path
+    write("if(!setjmp(*(____Pexception_handlers->buf))) [[likely]] {\n");
     local_mangle_start();
     node.body()->accept(*this);
     local_mangle_end();
@@ -1331,7 +2455,229 @@ bool Codegen::visit(const ast::LambdaDefinition& node){
     write(";\n}");
     return true;
 }
+bool Codegen::visit(const ast::AsyncStatement& node){
+    //a c++20 coroutine returning a Peregrine::task, see lib/async.hpp
+    auto function=std::dynamic_pointer_cast<ast::FunctionDefinition>(node.body());
+    auto functionName=std::dynamic_pointer_cast<ast::IdentifierExpression>(function->name())->value();
+    auto return_type=function->returnType();
+    bool returns_void=return_type->type()==ast::KAstTypeExpr && return_type->stringify()=="void";
+    is_func_def=true;
+    m_is_async=true;
+    write("Peregrine::task<");
+    return_type->accept(*this);
+    write("> ");
+    if(functionName=="main"){
+        write("____P____async_main");
+    }
+    else{
+        is_define=true;
+        function->name()->accept(*this);
+        is_define=false;
+    }
+    write("(");
+    local_mangle_start();
+    codegenFuncParams(function->parameters());
+    write(") noexcept {\n{\n");
+    //the stack a handler would jump back to is gone once the coroutine was suspended
+    write("____P____exception_handler* ____Pexception_handlers=NULL;\n");
+    function->body()->accept(*this);
+    write("\n}\n");
+    if(returns_void){
+        //makes it a coroutine even if it never awaits
+        write("co_return;\n");
+    }
+    write("}");
+    local_mangle_end();
+    m_is_async=false;
+    is_func_def=false;
+    if(functionName=="main"){
+        m_symbolMap.set_global("main","main");
+        write(";\nint main () noexcept {\nPeregrine::run(____P____async_main());\nreturn 0;\n}");
+    }
+    return true;
+}
+bool Codegen::visit(const ast::AwaitExpression& node){
+    write("(co_await ");
+    node.value()->accept(*this);
+    write(")");
+    return true;
+}
+bool Codegen::visit(const ast::YieldStatement& node){
+    //the next call of next() continues at the case label
+    std::string state=std::to_string(++m_yields);
+    write("____P____value=");
+    node.value()->accept(*this);
+    write(";\n____P____state="+state+";\nreturn true;\ncase "+state+":");
+    return true;
+}
+bool Codegen::visit(const ast::SpawnStatement& node){
+    if(m_is_async){
+        //a coroutine that runs on the event loop, nobody awaits it
+        write("Peregrine::spawn(");
+        node.value()->accept(*this);
+        write(")");
+        return true;
+    }
+    //the arguments are evaluated now and captured by the task, the call
+    //itself runs on the pool with handlers that catch its raise
+    auto call=std::dynamic_pointer_cast<ast::FunctionCall>(node.value());
+    auto args=call->arguments();
+    write("____P____SCOPE.spawn([&");
+    handle_ref_start()
+    for(size_t i=0;i<args.size();++i){
+        write(",____P____ARG"+std::to_string(i)+"=Peregrine::spawn_arg(");
+        args[i]->accept(*this);
+        write(")");
+    }
+    handle_ref_end()
+    write("](____P____exception_handler* ____Pexception_handlers) mutable {\n");
+    call->name()->accept(*this);
+    write("(");
+    for(size_t i=0;i<args.size();++i){
+        write("____P____ARG"+std::to_string(i)+",");
+    }
+    write("____Pexception_handlers);\n})");
+    return true;
+}
+std::string Codegen::iterBuiltin(ast::AstNodePtr stage,std::vector<ast::AstNodePtr>& args){
+    //the name of a stage that calls one of the lib/iter.hpp functions
+    ast::AstNodePtr name=stage;
+    args.clear();
+    if(stage->type()==ast::KAstFunctionCall){
+        auto call=std::dynamic_pointer_cast<ast::FunctionCall>(stage);
+        name=call->name();
+        args=call->arguments();
+    }
+    if(name->type()!=ast::KAstIdentifier){
+        return "";
+    }
+    auto value=std::dynamic_pointer_cast<ast::IdentifierExpression>(name)->value();
+    if(m_symbolMap[value]!="Peregrine::iter::"+value){
+        return "";
+    }
+    return value;
+}
+
+bool Codegen::fusedPipeline(const ast::BinaryOperation& node){
+    //data |> map(f) |> filter(g) |> sum becomes a single loop over data that
+    //calls f and g on each element, instead of a chain of views
+    std::vector<ast::AstNodePtr> stages={node.right()};
+    ast::AstNodePtr source=node.left();
+    while(source->type()==ast::KAstBinaryOp && source->token().tkType==tk_pipeline){
+        auto op=std::dynamic_pointer_cast<ast::BinaryOperation>(source);
+        stages.insert(stages.begin(),op->right());
+        source=op->left();
+    }
+    std::vector<ast::AstNodePtr> args;
+    std::string terminal=iterBuiltin(stages.back(),args);
+    if(!((terminal=="sum"&&args.size()==0)||(terminal=="count"&&args.size()==0)||(terminal=="reduce"&&args.size()==2))){
+        return false;
+    }
+    std::vector<ast::AstNodePtr> terminal_args=args;
+    for(size_t i=0;i+1<stages.size();++i){
+        std::string stage=iterBuiltin(stages[i],args);
+        bool one_arg=(stage=="map"||stage=="filter"||stage=="take"||stage=="zip")&&args.size()==1;
+        if(!one_arg&&!(stage=="enumerate"&&args.size()==0)){
+            return false;
+        }
+    }
+    std::string handlers=is_func_def?"____Pexception_handlers":"NULL";
+    std::string setup;
+    std::string loop;
+    std::string body;
+    std::vector<std::pair<std::string,std::string>> values;//name,type
+    auto join=[&](bool declval){
+        std::string res;
+        for(auto& value:values){
+            res+=(declval?"std::declval<"+value.second+">()":value.first)+",";
+        }
+        return res+handlers;
+    };
+    std::string source_name=iterBuiltin(source,args);
+    if(source_name=="range"&&(args.size()==1||args.size()==2)){
+        std::string start=args.size()==2?render([&]{args[0]->accept(*this);}):"0";
+        std::string stop=render([&]{args.back()->accept(*this);});
+        loop="for (int64_t ____P____V0="+start+",____P____END="+stop+";____P____V0<____P____END;++____P____V0) {\n";
+        values.push_back({"____P____V0","int64_t"});
+    }
+    else if(source_name=="span"&&args.size()==2){
+        setup+="auto ____P____DATA="+render([&]{args[0]->accept(*this);})+";\n";
+        setup+="int64_t ____P____END="+render([&]{args[1]->accept(*this);})+";\n";
+        loop="for (int64_t ____P____i=0;____P____i<____P____END;++____P____i) {\n";
+        body+="auto ____P____V0=____P____DATA[____P____i];\n";
+        values.push_back({"____P____V0","std::decay_t<decltype(*____P____DATA)>"});
+    }
+    else{
+        setup+="auto&& ____P____SOURCE="+render([&]{source->accept(*this);})+";\n";
+        loop="for (size_t ____P____i=0;____P____i<Peregrine::loop_end(____P____SOURCE,"+handlers+");++____P____i) {\n";
+        body+="auto ____P____V0=Peregrine::loop_item(____P____SOURCE,____P____i,"+handlers+");\n";
+        values.push_back({"____P____V0","Peregrine::iterate_t<std::decay_t<decltype(____P____SOURCE)>>"});
+    }
+    for(size_t i=0;i+1<stages.size();++i){
+        std::string stage=iterBuiltin(stages[i],args);
+        std::string id=std::to_string(i+1);
+        std::string value="____P____V"+id;
+        if(stage=="map"){
+            setup+="auto&& ____P____F"+id+"="+render([&]{args[0]->accept(*this);})+";\n";
+            std::string type="std::decay_t<decltype(____P____F"+id+"("+join(true)+"))>";
+            body+="auto "+value+"=____P____F"+id+"("+join(false)+");\n";
+            values={{value,type}};
+        }
+        else if(stage=="filter"){
+            setup+="auto&& ____P____F"+id+"="+render([&]{args[0]->accept(*this);})+";\n";
+            body+="if (!(____P____F"+id+"("+join(false)+"))) {\ncontinue;\n}\n";
+        }
+        else if(stage=="take"){
+            setup+="int64_t ____P____TAKE"+id+"="+render([&]{args[0]->accept(*this);})+";\n";
+            body+="if (____P____TAKE"+id+"--<=0) {\nbreak;\n}\n";
+        }
+        else if(stage=="enumerate"){
+            setup+="int64_t ____P____INDEX"+id+"=0;\n";
+            body+="int64_t "+value+"=____P____INDEX"+id+"++;\n";
+            values.insert(values.begin(),{value,"int64_t"});
+        }
+        else{
+            std::string zip="____P____ZIP"+id;
+            setup+="auto&& "+zip+"="+render([&]{args[0]->accept(*this);})+";\n";
+            setup+="size_t "+zip+"_i=0;\n";
+            body+="if (!("+zip+"_i<Peregrine::loop_end("+zip+","+handlers+"))) {\nbreak;\n}\n";
+            body+="auto "+value+"=Peregrine::loop_item("+zip+","+zip+"_i,"+handlers+");\n";
+            body+="++"+zip+"_i;\n";
+            values.push_back({value,"Peregrine::iterate_t<std::decay_t<decltype("+zip+")>>"});
+        }
+    }
+    if(terminal=="sum"){
+        if(values.size()!=1){
+            return false;
+        }
+        setup+=values[0].second+" ____P____ACC{};\n";
+        body+="____P____ACC+="+values[0].first+";\n";
+    }
+    else if(terminal=="count"){
+        setup+="int64_t ____P____ACC=0;\n";
+        body+="++____P____ACC;\n";
+    }
+    else{
+        std::string init=render([&]{terminal_args[1]->accept(*this);});
+        setup+="auto&& ____P____REDUCE="+render([&]{terminal_args[0]->accept(*this);})+";\n";
+        setup+="std::decay_t<decltype("+init+")> ____P____ACC="+init+";\n";
+        values.insert(values.begin(),{"____P____ACC",""});
+        body+="____P____ACC=____P____REDUCE("+join(false)+");\n";
+    }
+    use_runtime("iter.hpp");
+    //a lambda outside of a function can't capture
+    write(is_func_def?"[&]() {\n":"[]() {\n");
+    write(setup);
+    write(loop);
+    write(body);
+    write("}\nreturn ____P____ACC;\n}()");
+    return true;
+}
+
 bool Codegen::pipeline(const ast::BinaryOperation& node){
+    if(fusedPipeline(node)){
+        return true;
+    }
     auto right=node.right();
     switch(right->type()){
         case ast::KAstIdentifier:{
@@ -6,8 +6,11 @@
 #include "utils/symbolTable.hpp"
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <string>
 #include <string_view>
 
@@ -17,7 +20,14 @@ typedef std::shared_ptr<SymbolTable<ast::AstNodePtr>> EnvPtr;
 
 class Codegen : public ast::AstVisitor {
   public:
-    Codegen(std::string outputFilename, ast::AstNodePtr ast,std::string filename);
+    //writes the generated C++ to out, a file or the stdin of the compiler
+    Codegen(std::ostream& out, ast::AstNodePtr ast,std::string filename,bool profile_alloc=false,bool line_directives=false,bool reorder_fields=false,bool march_dispatch=false);
+    //maps the emitted global names back to the peregrine declarations
+    std::map<std::string, std::string> symbol_origins();
+    //the field order that -reorder-fields picked for every class
+    void print_layouts();
+    //paths of the runtime headers the generated code includes
+    std::vector<std::string> runtime_headers();
 
 
   private:
@@ -32,9 +42,52 @@ class Codegen : public ast::AstVisitor {
     std::string res;
     bool save=false;
     std::string m_filename;
-    std::ofstream m_file;
+    std::stringstream m_file;//written out once we know which runtime headers it needs
+    std::set<std::string> m_runtime_headers;
     bool is_func_def=false;
+    bool m_profile_alloc=false;
+    bool m_line_directives=false;
+    bool m_reorder_fields=false;
+    bool m_march_dispatch=false;//clone functions with loops for avx2 and avx512f
+    std::vector<std::string> m_layouts;
+    bool m_is_async=false;//returns have to be co_return
+    bool m_is_generator=false;//yield and return resume and leave the state machine
+    bool m_hoist_locals=false;//locals are members of the generator struct
+    size_t m_yields=0;
+    size_t m_generator_loops=0;
+    std::vector<std::pair<std::string,std::string>> m_generator_members;//name,declaration
+    std::vector<std::string> m_extern_owners;//c in def c.func()
+    std::string m_class_alignment;//alignas of the class that is visited next
+    std::string m_if_likelihood;//[[likely]] or [[unlikely]] of the if that is visited next
+    std::string alignment(std::vector<ast::AstNodePtr> decorators);
+    std::string m_function_attributes;//attributes of the function that is visited next
+    std::string functionAttributes(std::vector<ast::AstNodePtr> decorators);
+    std::string m_cache;//maxsize of the @cache of the function that is visited next
+    //globals are initialised at compile time when they can be, the others
+    //when they are first used
+    std::set<std::string> m_constant_globals;//constexpr, usable in the initialiser of another one
+    std::set<std::string> m_lazy_globals;//mangled names, every use calls them
+    void globalVariable(ast::AstNodePtr stmt);
+    bool constantExpression(ast::AstNodePtr node);
+    std::string cacheSize(ast::AstNodePtr decorator);
+    void cachedBody(const ast::FunctionDefinition& node);
+    std::string targetClones(std::vector<std::string> targets);
+    std::set<std::string> m_pure_functions;//@pure and @const ones
+    std::map<std::string,std::string> m_common_calls;//a pure call that the statement repeats and the local holding it
+    size_t m_common_call_count=0;
+    bool pureCalls(ast::AstNodePtr node,std::vector<ast::AstNodePtr>& calls);
+    void commonCalls(ast::AstNodePtr stmt);
+    std::vector<ast::AstNodePtr> reorderFields(std::string name,std::vector<ast::AstNodePtr> attributes);
+    void soaColumns(std::string name,bool plain,std::vector<std::pair<std::string,std::string>> columns,std::vector<std::string> constants);
     std::string write(std::string_view code);
+    void use_runtime(std::string header);
+    void runtimeBuiltins(const ast::Program& node);
+    void useRuntimeOf(std::string name);
+    void genericTypes(std::vector<ast::AstNodePtr> types);
+    std::string render(std::function<void()> emit);
+    void hoist(std::string name,std::string declaration);
+    void generator(const ast::FunctionDefinition& node);
+    void generatorFor(const ast::ForStatement& node);
 
     std::string searchDefaultModule(std::string path, std::string moduleName);
     std::vector<ast::AstNodePtr> TurpleTypes(ast::AstNodePtr node);
@@ -45,6 +98,7 @@ class Codegen : public ast::AstVisitor {
     void matchArg(std::vector<ast::AstNodePtr> matchItem,
                   std::vector<ast::AstNodePtr> caseItem);
     std::string wrap(ast::AstNodePtr item,std::string contains);
+    void parallelFor(std::vector<ast::AstNodePtr> decorators,std::shared_ptr<ast::ForStatement> loop);
     bool visit(const ast::Program& node);
     bool visit(const ast::BlockStatement& node);
     bool visit(const ast::ImportStatement& node);
@@ -77,6 +131,7 @@ class Codegen : public ast::AstVisitor {
     bool visit(const ast::ArrowExpression& node);
     bool visit(const ast::IdentifierExpression& node);
     bool visit(const ast::TypeExpression& node);
+    bool visit(const ast::GenericCall& node);
     bool visit(const ast::ListTypeExpr& node);
     bool visit(const ast::FunctionTypeExpr& node);
     bool visit(const ast::NoLiteral& node);
@@ -105,7 +160,13 @@ class Codegen : public ast::AstVisitor {
     bool visit(const ast::PrivateDef& node);
     bool visit(const ast::InlineAsm& node);
     bool visit(const ast::LambdaDefinition& node);
+    bool visit(const ast::AsyncStatement& node);
+    bool visit(const ast::AwaitExpression& node);
+    bool visit(const ast::YieldStatement& node);
+    bool visit(const ast::SpawnStatement& node);
     bool pipeline(const ast::BinaryOperation& node);
+    std::string iterBuiltin(ast::AstNodePtr stage,std::vector<ast::AstNodePtr>& args);
+    bool fusedPipeline(const ast::BinaryOperation& node);
     EnvPtr m_env;
 };
 
@@ -11,20 +11,24 @@
 #include <string_view>
 
 namespace js {
-Codegen::Codegen(std::string outputFilename, ast::AstNodePtr ast, bool html, std::string  filename) {
+Codegen::Codegen(std::ostream& out, ast::AstNodePtr ast, bool html, std::string  filename) : m_file(out) {
     m_filename = filename;
-    m_file.open(outputFilename);
     if (html){
         m_file<<"<!DOCTYPE html><html><body id='body'><script>";
     }
     m_file << "function render(code){document.write(code);}error___AssertionError=0;error___ZeroDivisionError=1\n";
     m_env = createEnv();
     ast->accept(*this);
+    if(m_uses_vectors){
+        vectorHelpers();
+    }
+    if(m_uses_cache){
+        cacheHelpers();
+    }
     m_file<<"\nmain();";
     if(html){
         m_file<<"</script></body></html>";
     }
-    m_file.close();
 }
 
 std::shared_ptr<SymbolTable<ast::AstNodePtr>>
@@ -64,12 +68,23 @@ void Codegen::codegenFuncParams(std::vector<ast::parameter> parameters) {
         for (size_t i = 0; i < parameters.size(); ++i) {
             if (i)
                 write(", ");
+            declare(parameters[i].p_name,parameters[i].p_type);
             parameters[i].p_name->accept(*this);
         }
     }
 }
 
 bool Codegen::visit(const ast::Program& node) {
+    for (auto& stmt : node.statements()) {
+        if (stmt->type()==ast::KAstAsync){
+            //what the c++ backend gets from lib/async.hpp, the io is left to the host
+            write("function sleep(ms){return new Promise(function(resolve){setTimeout(resolve,ms);});}\n");
+            write("function yield_now(){return sleep(0);}\n");
+            write("function spawn(task){task.catch(function(e){console.error(e);});}\n");
+            write("function run(task){return task;}\n");
+            break;
+        }
+    }
     for (auto& stmt : node.statements()) {
         stmt->accept(*this);
         write(";\n"); // TODO: will this break stuff later?
@@ -79,11 +94,14 @@ bool Codegen::visit(const ast::Program& node) {
 }
 
 bool Codegen::visit(const ast::BlockStatement& node) {
+    // the vectors declared in the block end with it
+    auto vectors = m_vectors;
     for (auto& stmt : node.statements()) {
         write("    ");
         stmt->accept(*this);
         write(";\n");
     }
+    m_vectors = vectors;
     return true;
 }
 
@@ -93,6 +111,10 @@ bool Codegen::visit(const ast::FunctionDefinition& node) {
     auto functionName =
         std::dynamic_pointer_cast<ast::IdentifierExpression>(node.name())
             ->value();
+    // functions that yield are native generators
+    std::string function = ast::containsYield(node.body()) ? "function*" : "function";
+    // the vector parameters end with the function
+    auto vectors = m_vectors;
     if (!is_func_def){
         is_func_def = true;
         if (functionName == "main") {
@@ -103,29 +125,51 @@ bool Codegen::visit(const ast::FunctionDefinition& node) {
             node.body()->accept(*this);
             write("return 0;\n}");
         } else {
-            write("function ");
+            write(function + " ");
             node.name()->accept(*this);
             write("(");
             codegenFuncParams(node.parameters());
             write(") {\n");
-            node.body()->accept(*this);
+            if (m_cache != "") {
+                // @cache, the table is a Map kept on the function
+                auto params = node.parameters();
+                m_uses_cache = true;
+                write("return ____cache(");
+                node.name()->accept(*this);
+                write(",");
+                write(params.size() == 1 ? "" : "JSON.stringify([");
+                for (size_t i = 0; i < params.size(); ++i) {
+                    if (i)
+                        write(",");
+                    params[i].p_name->accept(*this);
+                }
+                write(params.size() == 1 ? "" : "])");
+                write("," + m_cache + ",()=>{\n");
+                m_cache = "";
+                node.body()->accept(*this);
+                write("\n});");
+            } else {
+                node.body()->accept(*this);
+            }
             write("\n}");
         }
         is_func_def=false;
     }
     else{
         node.name()->accept(*this);
-        write("=function(");
+        write("=" + function + "(");
         codegenFuncParams(node.parameters());
         write(")");
         write("{\n");
         node.body()->accept(*this);
         write("\n}");
     }
+    m_vectors = vectors;
     return true;
 }
 
 bool Codegen::visit(const ast::VariableStatement& node) {
+    declare(node.name(),node.varType());
     if (node.varType()->type() != ast::KAstNoLiteral) {
         write("let ");
     }
@@ -138,6 +182,7 @@ bool Codegen::visit(const ast::VariableStatement& node) {
 }
 
 bool Codegen::visit(const ast::ConstDeclaration& node) {
+    declare(node.name(),node.constType());
     write("const ");
     write(" ");
     node.name()->accept(*this);
@@ -203,7 +248,28 @@ bool Codegen::visit(const ast::WhileStatement& node) {
     return true;
 }
 
-bool Codegen::visit(const ast::ForStatement& node) { return true; }
+bool Codegen::visit(const ast::ForStatement& node) {
+    // arrays, strings and generators are all iterable
+    write("for (let ");
+    auto variables = node.variable();
+    if (variables.size() == 1) {
+        variables[0]->accept(*this);
+    } else {
+        write("[");
+        for (size_t i = 0; i < variables.size(); ++i) {
+            if (i)
+                write(",");
+            variables[i]->accept(*this);
+        }
+        write("]");
+    }
+    write(" of ");
+    node.sequence()->accept(*this);
+    write(") {\n");
+    node.body()->accept(*this);
+    write("}");
+    return true;
+}
 
 bool Codegen::visit(const ast::MatchStatement& node) {
     auto toMatch = node.matchItem();
@@ -272,6 +338,31 @@ bool Codegen::visit(const ast::BreakStatement& node) {
 bool Codegen::visit(const ast::DecoratorStatement& node) {
     auto items = node.decoratorItem();
     auto body = node.body();
+    //@target_clones, @pure, @const, @hot, @cold, @likely and @unlikely are
+    //hints for the c++ compiler, the function or the if stays as it is.
+    //@cache(maxsize=N) is handled by the function definition
+    bool hints = true;
+    std::string cache;
+    for (auto& item : items) {
+        auto call = std::dynamic_pointer_cast<ast::FunctionCall>(item);
+        auto name = call ? call->name()->stringify() : item->stringify();
+        if (name == "cache") {
+            cache = "0";
+            if (call) {
+                auto size = call->arguments()[0];
+                auto arg = std::dynamic_pointer_cast<ast::DefaultArg>(size);
+                cache = (arg ? arg->value() : size)->stringify();
+            }
+        } else if (name != "target_clones" && name != "pure" && name != "const" && name != "hot" &&
+                   name != "cold" && name != "likely" && name != "unlikely") {
+            hints = false;
+        }
+    }
+    if (hints) {
+        m_cache = cache;
+        body->accept(*this);
+        return true;
+    }
     std::string contains;
     std::string x;
     std::string prev;
@@ -375,6 +466,13 @@ bool Codegen::visit(const ast::BinaryOperation& node) {
     if(node.token().tkType==tk_pipeline){
         return pipeline(node);
     }
+    else if(isVector(node.left())||isVector(node.right())){
+        write("____vec_op(\""+node.op().keyword+"\",");
+        node.left()->accept(*this);
+        write(",");
+        node.right()->accept(*this);
+        write(")");
+    }
     else {
         write("(");
         node.left()->accept(*this);
@@ -391,6 +489,13 @@ bool Codegen::visit(const ast::BinaryOperation& node) {
 }
 
 bool Codegen::visit(const ast::PrefixExpression& node) {
+    if(isVector(node.right())){
+        //-v is 0-v and ~v is -1^v
+        write(node.prefix().keyword=="-"?"____vec_op(\"-\",0,":"____vec_op(\"^\",-1,");
+        node.right()->accept(*this);
+        write(")");
+        return true;
+    }
     write("(" + node.prefix().keyword + " ");
     node.right()->accept(*this);
     write(")");
@@ -398,10 +503,18 @@ bool Codegen::visit(const ast::PrefixExpression& node) {
 }
 
 bool Codegen::visit(const ast::FunctionCall& node) {
+    auto args = node.arguments();
+    if (node.name()->type()==ast::KAstIdentifier && args.size()==1 &&
+        (node.name()->stringify()=="likely"||node.name()->stringify()=="unlikely")){
+        //branch hints only matter to the c++ backend
+        write("(");
+        args[0]->accept(*this);
+        write(")");
+        return true;
+    }
     node.name()->accept(*this);
     write("(");
 
-    auto args = node.arguments();
     if (args.size()) {
         for (size_t i = 0; i < args.size(); ++i) {
             if (i)
@@ -466,6 +579,21 @@ bool Codegen::visit(const ast::TypeExpression& node) {
     return true;
 }
 
+bool Codegen::visit(const ast::GenericCall& node) {
+    //vec{f32,8}(...), the other generic types only matter to the c++ backend
+    auto types=node.generic_types();
+    if(node.identifier()->type()==ast::KAstIdentifier&&std::dynamic_pointer_cast<ast::IdentifierExpression>(node.identifier())->value()=="vec"&&types.size()==2){
+        m_uses_vectors=true;
+        write("____vec(");
+        types[1]->accept(*this);
+        write(",\""+std::dynamic_pointer_cast<ast::TypeExpression>(types[0])->value()+"\")");
+    }
+    else{
+        node.identifier()->accept(*this);
+    }
+    return true;
+}
+
 bool Codegen::visit(const ast::ListTypeExpr& node) { return true; }
 
 bool Codegen::visit(const ast::FunctionTypeExpr& node) {
@@ -647,6 +775,16 @@ bool Codegen::visit(const ast::MultipleAssign& node){
     return true;
 }
 bool Codegen::visit(const ast::AugAssign& node){
+    if(isVector(node.name())){
+        auto op=node.op();
+        node.name()->accept(*this);
+        write("=____vec_op(\""+op.substr(0,op.size()-1)+"\",");
+        node.name()->accept(*this);
+        write(",");
+        node.value()->accept(*this);
+        write(")");
+        return true;
+    }
     node.name()->accept(*this);
     write(node.op());
     node.value()->accept(*this);
@@ -660,6 +798,118 @@ bool Codegen::visit(const ast::LambdaDefinition& node){
     write(";}");
     return true;
 }
+bool Codegen::visit(const ast::AsyncStatement& node){
+    write("async ");
+    node.body()->accept(*this);
+    return true;
+}
+bool Codegen::visit(const ast::AwaitExpression& node){
+    write("(await ");
+    node.value()->accept(*this);
+    write(")");
+    return true;
+}
+bool Codegen::visit(const ast::YieldStatement& node){
+    write("yield ");
+    node.value()->accept(*this);
+    return true;
+}
+bool Codegen::visit(const ast::SpawnStatement& node){
+    write("spawn(");
+    node.value()->accept(*this);
+    write(")");
+    return true;
+}
+//a declaration of any other type hides a vector of the same name
+void Codegen::declare(ast::AstNodePtr name,ast::AstNodePtr type){
+    if(name->type()!=ast::KAstIdentifier||type->type()==ast::KAstNoLiteral){
+        return;
+    }
+    auto value=std::dynamic_pointer_cast<ast::IdentifierExpression>(name)->value();
+    if(type->type()==ast::KAstTypeExpr&&std::dynamic_pointer_cast<ast::TypeExpression>(type)->value()=="vec"){
+        m_vectors.insert(value);
+    }
+    else{
+        m_vectors.erase(value);
+    }
+}
+
+bool Codegen::isVector(ast::AstNodePtr node){
+    switch(node->type()){
+        case ast::KAstIdentifier:{
+            return m_vectors.count(std::dynamic_pointer_cast<ast::IdentifierExpression>(node)->value());
+        }
+        case ast::KAstFunctionCall:{
+            auto name=std::dynamic_pointer_cast<ast::FunctionCall>(node)->name();
+            if(name->type()!=ast::KAstGenericCall){
+                return false;
+            }
+            auto generic=std::dynamic_pointer_cast<ast::GenericCall>(name)->identifier();
+            return generic->type()==ast::KAstIdentifier&&std::dynamic_pointer_cast<ast::IdentifierExpression>(generic)->value()=="vec";
+        }
+        case ast::KAstBinaryOp:{
+            auto op=std::dynamic_pointer_cast<ast::BinaryOperation>(node);
+            return isVector(op->left())||isVector(op->right());
+        }
+        case ast::KAstPrefixExpr:{
+            return isVector(std::dynamic_pointer_cast<ast::PrefixExpression>(node)->right());
+        }
+        case ast::KAstDotExpression:{
+            //the methods of a vector that return one
+            auto dot=std::dynamic_pointer_cast<ast::DotExpression>(node);
+            if(!isVector(dot->owner())||dot->referenced()->type()!=ast::KAstFunctionCall){
+                return false;
+            }
+            auto method=std::dynamic_pointer_cast<ast::FunctionCall>(dot->referenced())->name();
+            if(method->type()!=ast::KAstIdentifier){
+                return false;
+            }
+            auto name=std::dynamic_pointer_cast<ast::IdentifierExpression>(method)->value();
+            return name=="select"||name=="shuffle"||name=="reverse";
+        }
+        default:{
+            return false;
+        }
+    }
+}
+
+//vec{T,N} is a typed array of N lanes (a Float64Array for int and uint) with
+//the methods of lib/simd.hpp, comparisons give masks of -1 and 0
+void Codegen::vectorHelpers(){
+    m_file<<"\nfunction ____vec(n,kind){return function(){let v=new (____vec_class(kind))(n);if(arguments.length==1){v.fill(arguments[0]);}else{v.set(arguments);}return v;};}";
+    m_file<<"\nfunction ____vec_class(kind){if(____vec_class[kind]){return ____vec_class[kind];}";
+    m_file<<"let base={f32:Float32Array,i8:Int8Array,i16:Int16Array,i32:Int32Array,u8:Uint8Array,u16:Uint16Array,u32:Uint32Array}[kind]||Float64Array;";
+    m_file<<"let c=class extends base{";
+    m_file<<"sum(){return this.reduce(function(a,b){return a+b;});}";
+    m_file<<"min(){return Math.min(...this);}";
+    m_file<<"max(){return Math.max(...this);}";
+    m_file<<"any(){return this.some(function(x){return x!=0;});}";
+    m_file<<"all(){return this.every(function(x){return x!=0;});}";
+    m_file<<"select(a,b){let r=new a.constructor(a.length);for(let i=0;i<r.length;++i){r[i]=this[i]?a[i]:b[i];}return r;}";
+    m_file<<"shuffle(idx){let r=new this.constructor(this.length);for(let i=0;i<r.length;++i){r[i]=this[idx[i]&(this.length-1)];}return r;}";
+    m_file<<"reverse(){let r=new this.constructor(this.length);for(let i=0;i<r.length;++i){r[i]=this[this.length-1-i];}return r;}";
+    m_file<<"load(src,offset){for(let i=0;i<this.length;++i){this[i]=src[offset+i];}}";
+    m_file<<"store(dst,offset){for(let i=0;i<this.length;++i){dst[offset+i]=this[i];}}";
+    m_file<<"len(){return this.length;}};";
+    m_file<<"c.whole=kind==\"int\"||kind==\"uint\";____vec_class[kind]=c;return c;}";
+    m_file<<"\nfunction ____vec_op(op,a,b){let v=a.length===undefined?b:a;let mask=[\"==\",\"!=\",\"<\",\"<=\",\">\",\">=\"].includes(op);";
+    m_file<<"let r=new (mask?____vec_class(\"i32\"):v.constructor)(v.length);";
+    m_file<<"for(let i=0;i<r.length;++i){let x=a.length===undefined?a:a[i],y=b.length===undefined?b:b[i];let z;switch(op){";
+    m_file<<"case \"+\":z=x+y;break;case \"-\":z=x-y;break;case \"*\":z=x*y;break;case \"/\":z=x/y;break;case \"%\":z=x%y;break;";
+    m_file<<"case \"&\":z=x&y;break;case \"|\":z=x|y;break;case \"^\":z=x^y;break;case \"<<\":z=x<<y;break;case \">>\":z=x>>y;break;";
+    m_file<<"case \"==\":z=x==y;break;case \"!=\":z=x!=y;break;case \"<\":z=x<y;break;case \"<=\":z=x<=y;break;case \">\":z=x>y;break;case \">=\":z=x>=y;break;}";
+    m_file<<"r[i]=mask?-z:(v.constructor.whole?Math.trunc(z):z);}return r;}";
+}
+
+//the results of a @cache function by its arguments, a Map keeps the order in
+//which keys were set so the least recently used one comes first
+void Codegen::cacheHelpers(){
+    m_file<<"\nfunction ____cache(f,key,maxsize,compute){let table=f.____table||(f.____table=new Map());";
+    m_file<<"if(table.has(key)){let v=table.get(key);if(maxsize){table.delete(key);table.set(key,v);}return v;}";
+    m_file<<"let v=compute();if(maxsize&&table.size>=maxsize){table.delete(table.keys().next().value);}";
+    m_file<<"table.set(key,v);return v;}";
+}
+
 bool Codegen::pipeline(const ast::BinaryOperation& node){
     auto right=node.right();
     switch(right->type()){
@@ -7,6 +7,7 @@
 
 #include <fstream>
 #include <memory>
+#include <set>
 #include <string>
 #include <string_view>
 
@@ -16,7 +17,8 @@ typedef std::shared_ptr<SymbolTable<ast::AstNodePtr>> EnvPtr;
 
 class Codegen : public ast::AstVisitor {
   public:
-    Codegen(std::string outputFilename, ast::AstNodePtr ast,bool html,std::string filename);
+    //writes the generated javascript, or a page running it when html is set, to out
+    Codegen(std::ostream& out, ast::AstNodePtr ast,bool html,std::string filename);
 
     EnvPtr createEnv(EnvPtr parent = nullptr);
 
@@ -27,8 +29,13 @@ class Codegen : public ast::AstVisitor {
     std::string res;
     bool save=false;
     std::string m_filename;
-    std::ofstream m_file;
+    std::ostream& m_file;
     bool is_func_def=false;
+    //variables and parameters of type vec{T,N} in scope, their operators become calls
+    std::set<std::string> m_vectors;
+    bool m_uses_vectors=false;
+    std::string m_cache;//maxsize of the @cache of the function that is visited next
+    bool m_uses_cache=false;
     std::string write(std::string_view code);
     std::string mangleName(ast::AstNodePtr astNode);
 
@@ -65,6 +72,7 @@ class Codegen : public ast::AstVisitor {
     bool visit(const ast::DotExpression& node);
     bool visit(const ast::IdentifierExpression& node);
     bool visit(const ast::TypeExpression& node);
+    bool visit(const ast::GenericCall& node);
     bool visit(const ast::ListTypeExpr& node);
     bool visit(const ast::FunctionTypeExpr& node);
     bool visit(const ast::NoLiteral& node);
@@ -82,7 +90,15 @@ class Codegen : public ast::AstVisitor {
     bool visit(const ast::AugAssign& node);
     bool visit(const ast::PostfixExpression& node);
     bool visit(const ast::LambdaDefinition& node);
+    bool visit(const ast::AsyncStatement& node);
+    bool visit(const ast::AwaitExpression& node);
+    bool visit(const ast::YieldStatement& node);
+    bool visit(const ast::SpawnStatement& node);
     bool pipeline(const ast::BinaryOperation& node);
+    void declare(ast::AstNodePtr name,ast::AstNodePtr type);
+    bool isVector(ast::AstNodePtr node);
+    void vectorHelpers();
+    void cacheHelpers();
     EnvPtr m_env;
 };
 
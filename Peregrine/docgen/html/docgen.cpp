@@ -39,8 +39,46 @@ void Docgen::funcParams(std::vector<ast::parameter> parameters) {
     }
 }
 
-Docgen::Docgen(std::string outputFilename, ast::AstNodePtr ast,std::string file){
-    m_file.open(outputFilename);
+//fields of a class that uses @align or @padded, so its layout can be seen
+void Docgen::classLayout(std::vector<ast::AstNodePtr> attributes) {
+    bool decorated=class_decorators.size()>0;
+    for (auto& x:attributes){
+      decorated=decorated||x->type()==KAstDecorator;
+    }
+    if(!decorated){
+      return;
+    }
+    for (auto x:attributes){
+      res+="<br>&emsp;";
+      if(x->type()==KAstDecorator){
+        auto field=std::dynamic_pointer_cast<DecoratorStatement>(x);
+        for (auto& item:field->decoratorItem()){
+          res+="<font color=#45a4a0>@"+item->stringify()+"</font> ";
+        }
+        x=field->body();
+      }
+      if(x->type()==KAstStatic){
+        res+="<font color=#cf222e>static</font> ";
+        x=std::dynamic_pointer_cast<StaticStatement>(x)->body();
+      }
+      if(x->type()==KAstVariableStmt){
+        auto var=std::dynamic_pointer_cast<VariableStatement>(x);
+        res+=var->name()->stringify();
+        if(var->varType()->type()!=KAstNoLiteral){
+          res+=":<font color=#45a4a0>"+var->varType()->stringify()+"</font>";
+        }
+      }
+      else if(x->type()==KAstConstDecl){
+        auto var=std::dynamic_pointer_cast<ConstDeclaration>(x);
+        res+="<font color=#cf222e>const</font> "+var->name()->stringify();
+        if(var->constType()->type()!=KAstNoLiteral){
+          res+=":<font color=#45a4a0>"+var->constType()->stringify()+"</font>";
+        }
+      }
+    }
+}
+
+Docgen::Docgen(std::ostream& out, ast::AstNodePtr ast,std::string file) : m_file(out) {
     std::string style="body {background: black;color:white } .local{color:#2d3748} a{text-decoration: none;}";
     style+="h1 {font-weight: bold;font-size: 40px;} h2 {font-weight: bold;font-size: 35px;} h3 {font-size: 25px;} h4 {font-size: 20px;}";
     style+=".code {background:#2d3748;padding: 10px;font-size:20px}";
@@ -50,7 +88,6 @@ Docgen::Docgen(std::string outputFilename, ast::AstNodePtr ast,std::string file)
     ast->accept(*this);
     write(res);
     m_file<<"</body></html>";
-    m_file.close();
 }
 void Docgen::write(std::string_view code) {
     m_file << code;
@@ -85,7 +122,11 @@ bool Docgen::visit(const ClassDefinition& node) {
     class_name=node.name()->stringify();
     res+="<h2 id=\""+str+"\">"+"class "+node.name()->stringify();
     res+="<a href=\"#"+str+"\" class=\"local\"> #</a></h2><hr>";
-    res+="<h3><div class=\"code\"><font color=#63b3ed>class</font> ";
+    res+="<h3><div class=\"code\">";
+    for (auto&x : class_decorators){
+      res+="<font color=#45a4a0>@"+x->stringify()+"</font><br>";
+    }
+    res+="<font color=#63b3ed>class</font> ";
     res+="<font color=#45a4a0>"+class_name+"</font>(";
     auto parents=node.parent();
     for (size_t i=0;i<parents.size();++i){
@@ -93,6 +134,8 @@ bool Docgen::visit(const ClassDefinition& node) {
         if(i<parents.size()-1){res+=",";}
     }
     res+=")";
+    classLayout(node.attributes());
+    class_decorators.clear();
     res+="</div></h3>";
     if(node.comment()!=""){
       res+=node.comment();
@@ -115,6 +158,11 @@ bool Docgen::visit(const DecoratorStatement& node) {
     std::string smaller;
     std::shared_ptr<FunctionDefinition> body;
     std::string prefix="";
+    if (node.body()->type()==KAstClassDef){
+      class_decorators=node.decoratorItem();
+      node.body()->accept(*this);
+      return true;
+    }
     if (node.body()->type()==KAstStatic){
       prefix="static ";
       body=std::dynamic_pointer_cast<FunctionDefinition>(
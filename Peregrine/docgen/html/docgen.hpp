@@ -10,14 +10,16 @@
 namespace html {
 class Docgen : public ast::AstVisitor {
   public:
-    Docgen(std::string outputFilename, ast::AstNodePtr ast,std::string file);
+    Docgen(std::ostream& out, ast::AstNodePtr ast,std::string file);
   private:
     size_t id=0;
-    std::ofstream m_file;
+    std::ostream& m_file;
     std::string res;
     std::string class_name;
     bool is_class=false;
+    std::vector<ast::AstNodePtr> class_decorators;
     void funcParams(std::vector<ast::parameter> parameters);
+    void classLayout(std::vector<ast::AstNodePtr> attributes);
     bool visit(const ast::Program& node);
     bool visit(const ast::ClassDefinition& node);
     bool visit(const ast::DecoratorStatement& node);
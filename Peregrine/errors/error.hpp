@@ -1,7 +1,9 @@
 #ifndef PEREGRINE_ERROR_HPP
 #define PEREGRINE_ERROR_HPP
 
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 const std::string prefix = "\e[";
 const std::string suffix = "m";
@@ -29,9 +31,25 @@ struct PEError {
     std::string ecode;
 };
 
+//thrown by the phases of the compiler once they find errors, so that a
+//program embedding it gets them back instead of being exited. message is
+//for an error that has no place in the source
+class CompileError : public std::runtime_error {
+    std::vector<PEError> m_errors;
+    std::string m_message;
+
+  public:
+    CompileError(std::vector<PEError> errors, std::string message = "");
+    const std::vector<PEError>& errors() const;
+    std::string message() const;
+};
+
 std::string fg(std::string text, std::string color);
 std::string style(std::string text, std::string color);
 
+//the error as display prints it
+std::string format(PEError e);
 void display(PEError e);
+void display(const CompileError& e);
 
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "error.hpp"
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
 std::string add_space(std::string& str,size_t s){
     std::string res;
@@ -35,39 +36,66 @@ std::string style(std::string text, std::string color) {
     return prefix + color + suffix + text + reset;
 }
 
-void display(PEError e) {
-    std::cout << "  ╭- "
-              << fg(style("Error ---------------------------------------- " +
-                              e.loc.file + ":" + std::to_string(e.loc.line) +
-                              ":" + std::to_string(e.loc.col),
-                          bold),
-                    light_red)
-              << "\n";
-    std::cout << "  | " << fg(style(e.msg, bold), light_red) << "\n";
-    std::cout << "  |"
-              << "\n";
-    std::cout << "  |"
-              << "\n";
-    std::cout << "  |"
-              << "\n";
-    std::cout << std::to_string(e.loc.line) << " | "
-              << e.loc.code.substr(0, e.loc.code.length()) << "\n";
-    std::cout << "  |";
-    std::cout << add_space(e.loc.code,e.loc.loc);
-    std::cout << fg(style(" ^----- " + e.submsg, bold), light_red) << "\n";
-    std::cout << "  |\n  |\n";
+CompileError::CompileError(std::vector<PEError> errors, std::string message)
+    : std::runtime_error(message != "" ? message : errors.size() > 0 ? errors[0].msg : "compile error"),
+      m_errors(errors), m_message(message) {}
+
+const std::vector<PEError>& CompileError::errors() const {
+    return m_errors;
+}
+
+std::string CompileError::message() const {
+    return m_message;
+}
+
+std::string format(PEError e) {
+    std::ostringstream out;
+    out << "  ╭- "
+        << fg(style("Error ---------------------------------------- " +
+                        e.loc.file + ":" + std::to_string(e.loc.line) +
+                        ":" + std::to_string(e.loc.col),
+                    bold),
+              light_red)
+        << "\n";
+    out << "  | " << fg(style(e.msg, bold), light_red) << "\n";
+    out << "  |"
+        << "\n";
+    out << "  |"
+        << "\n";
+    out << "  |"
+        << "\n";
+    out << std::to_string(e.loc.line) << " | "
+        << e.loc.code.substr(0, e.loc.code.length()) << "\n";
+    out << "  |";
+    out << add_space(e.loc.code,e.loc.loc);
+    out << fg(style(" ^----- " + e.submsg, bold), light_red) << "\n";
+    out << "  |\n  |\n";
     if (e.hint != "") {
-        std::cout << "  ├- " << fg(style("Try: ", bold), blue) << e.hint
-                  << "\n";
-        std::cout << "  |"
-                  << "\n";
+        out << "  ├- " << fg(style("Try: ", bold), blue) << e.hint
+            << "\n";
+        out << "  |"
+            << "\n";
     }
     if (e.ecode==""){
-        std::cout << "  ╰-----------------------------------------\n";
+        out << "  ╰-----------------------------------------\n";
     }
     else{
-        std::cout << "  ╰- " << fg(style("Hint: ", bold), cyan)
-                << "Use peregrine --explain=" << e.ecode << "\n";
+        out << "  ╰- " << fg(style("Hint: ", bold), cyan)
+            << "Use peregrine --explain=" << e.ecode << "\n";
+    }
+    out << "\n";
+    return out.str();
+}
+
+void display(PEError e) {
+    std::cout << format(e) << std::flush;
+}
+
+void display(const CompileError& e) {
+    for (auto& err : e.errors()) {
+        display(err);
+    }
+    if (e.message() != "") {
+        std::cout << fg("Error: " + e.message(), light_red) << std::endl;
     }
-    std::cout<<std::endl;
 }
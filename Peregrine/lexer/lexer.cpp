@@ -6,6 +6,57 @@
 #include <regex>
 #define not_tab()   m_is_tab=false;
 
+//shared by every lexer, nothing changes them once they are built
+static const std::regex decimal_literal(R"(^^\s*[-+]?((\d+(\.\d+)?)|(\d+\.)|(\.\d+))(e[-+]?\d+)?\s*$)");
+static const std::regex identifier("^[a-zA-Z_][a-zA-Z0-9_]*$");
+static const std::map<std::string,TokenType> key_map={
+    {"True",tk_true},
+    {"False",tk_false},
+    {"None",tk_none},
+    {"import",tk_import},
+    {"from",tk_from},
+    {"const",tk_const},
+    {"if",tk_if},
+    {"type",tk_type},
+    {"union",tk_union},
+    {"scope",tk_scope},
+    {"elif",tk_elif},
+    {"else",tk_else},
+    {"while",tk_while},
+    {"for",tk_for},
+    {"break",tk_break},
+    {"assert",tk_assert},
+    {"try",tk_try},
+    {"except",tk_except},
+    {"raise",tk_raise},
+    {"with",tk_with},
+    {"continue",tk_continue},
+    {"match",tk_match},
+    {"extern",tk_extern},
+    {"cast",tk_cast},
+    {"case",tk_case},
+    {"default",tk_default},
+    {"static",tk_static},
+    {"def",tk_def},
+    {"private",tk_private},
+    {"return",tk_return},
+    {"as",tk_as},
+    {"enum",tk_enum},
+    {"and",tk_and},
+    {"or",tk_or},
+    {"not",tk_not},
+    {"is",tk_is},
+    {"in",tk_in},
+    {"inline",tk_inline},
+    {"virtual",tk_virtual},
+    {"class",tk_class},
+    {"export",tk_export},
+    {"async",tk_async},
+    {"await",tk_await},
+    {"yield",tk_yield},
+    {"spawn",tk_spawn},
+    {"__asm__",tk_asm}
+};
 
 LEXER::LEXER(std::string input, std::string filename){
     m_input = input;
@@ -33,50 +84,6 @@ LEXER::LEXER(std::string input, std::string filename){
 
 void LEXER::add_unknown(){
     TokenType type;
-    std::map<std::string,TokenType> key_map={
-        {"True",tk_true},
-        {"False",tk_false},
-        {"None",tk_none},
-        {"import",tk_import},
-        {"from",tk_from},
-        {"const",tk_const},
-        {"if",tk_if},
-        {"type",tk_type},
-        {"union",tk_union},
-        {"scope",tk_scope},
-        {"elif",tk_elif},
-        {"else",tk_else},
-        {"while",tk_while},
-        {"for",tk_for},
-        {"break",tk_break},
-        {"assert",tk_assert},
-        {"try",tk_try},
-        {"except",tk_except},
-        {"raise",tk_raise},
-        {"with",tk_with},
-        {"continue",tk_continue},
-        {"match",tk_match},
-        {"extern",tk_extern},
-        {"cast",tk_cast},
-        {"case",tk_case},
-        {"default",tk_default},
-        {"static",tk_static},
-        {"def",tk_def},
-        {"private",tk_private},
-        {"return",tk_return},
-        {"as",tk_as},
-        {"enum",tk_enum},
-        {"and",tk_and},
-        {"or",tk_or},
-        {"not",tk_not},
-        {"is",tk_is},
-        {"in",tk_in},
-        {"inline",tk_inline},
-        {"virtual",tk_virtual},
-        {"class",tk_class},
-        {"export",tk_export},
-        {"__asm__",tk_asm}
-    };
     if(m_keyword=="f" && (m_curr_item=='"'||m_curr_item=='\'')){
         type=tk_format;
     }
@@ -84,18 +91,18 @@ void LEXER::add_unknown(){
         type=tk_raw;
     }
     else if (key_map.count(m_keyword) > 0) {
-        type = key_map[m_keyword];
+        type = key_map.at(m_keyword);
     }
     else if(m_keyword!=""){
         if(is_int(m_keyword)||is_hex(m_keyword)){
             type=tk_integer;
         }
-        else if(std::regex_match(m_keyword,std::regex(R"(^^\s*[-+]?((\d+(\.\d+)?)|(\d+\.)|(\.\d+))(e[-+]?\d+)?\s*$)"))){
+        else if(std::regex_match(m_keyword,decimal_literal)){
             type=tk_decimal;
         }
         else{
             type=tk_identifier;
-            if(!std::regex_match(m_keyword,std::regex("^[a-zA-Z_][a-zA-Z0-9_]*$"))){
+            if(!std::regex_match(m_keyword,identifier)){
                 m_error.push_back(PEError(
                     PEError({.loc = Location({.line = m_line,
                                           .col = m_loc,
@@ -231,10 +238,7 @@ void LEXER::complete_it(){
         ));
     }
     if(m_error.size()>0){
-        for (auto& x: m_error) {
-            display(x);
-        }
-        exit(1);
+        throw CompileError(m_error);
     }
     if(m_result.size()>0){
         if(m_result.back().tkType!=tk_new_line
@@ -107,6 +107,10 @@ enum TokenType {
     tk_type,      // type defination
     tk_enum,      // enum
     tk_export,    // export
+    tk_async,     // async
+    tk_await,     // await
+    tk_yield,     // yield
+    tk_spawn,     // spawn
 
     // value type
     tk_decimal,
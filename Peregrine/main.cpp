@@ -2,11 +2,17 @@
 #include "docgen/html/docgen.hpp"
 #include "codegen/cpp/codegen.hpp"
 #include "analyzer/ast_validate.hpp"
+#include "analyzer/tail_call.hpp"
 #include "cli/cli.hpp"
 #include "codegen/js/codegen.hpp"
 #include "lexer/lexer.hpp"
 #include "lexer/tokens.hpp"
 #include "parser/parser.hpp"
+#include "utils/sizeReport.hpp"
+#include "utils/timeTrace.hpp"
+#include "utils/process.hpp"
+#include "utils/runCache.hpp"
+#include "utils/dependencies.hpp"
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -15,6 +21,62 @@
 #include <vector>
 #include <sys/stat.h>
 #include <filesystem>
+#include <unistd.h>
+
+//the compiler and its arguments, the ones passed with -cc_arg come last
+std::vector<std::string> backend(cli::state& s,std::vector<std::string> args){
+    auto res=Utils::splitArgs(s.cpp_compiler);
+    res.insert(res.end(),args.begin(),args.end());
+    for(auto& arg:Utils::splitArgs(s.cpp_arg)){
+        res.push_back(arg);
+    }
+    return res;
+}
+//runs the compiler and exits with its status if it fails. the generated C++
+//goes to its stdin, so nothing is written next to the program and any number
+//of compiles can run in the same directory
+void runBackend(cli::state& s,std::vector<std::string> args,const std::string& source=""){
+    int status=Utils::run(backend(s,args),source);
+    if(status==-1){
+        std::cout<<"Error: could not run "<<s.cpp_compiler<<std::endl;
+        exit(1);
+    }
+    if(status!=0){
+        exit(status);
+    }
+}
+
+//peregrine run. the program is built into the cache unless the same C++ was
+//built with the same command before, then it replaces this process
+void runCached(cli::state& s,const std::string& source){
+    Utils::RunCache cache;
+    if(cache.dir()==""){
+        std::cout<<"Error: could not create the cache directory, set PEREGRINE_CACHE_DIR"<<std::endl;
+        exit(1);
+    }
+    std::vector<std::string> args={"-std=c++2a","-x","c++","-","-x","none","-fpermissive","-w","-o"};
+    auto binary=cache.binary(source,backend(s,args));
+    if(access(binary.c_str(),X_OK)!=0){
+        auto built=binary+"."+std::to_string(getpid());
+        args.push_back(built);
+        runBackend(s,args,source);
+        if(!cache.store(built,binary)){
+            std::cout<<"Error: could not write "<<binary<<std::endl;
+            exit(1);
+        }
+    }
+    else{
+        cache.used(binary);
+    }
+    std::vector<char*> argv={const_cast<char*>(s.input_filename.c_str())};
+    for(auto& arg:s.run_args){
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(NULL);
+    execv(binary.c_str(),argv.data());
+    std::cout<<"Error: could not run "<<binary<<std::endl;
+    exit(1);
+}
 
 void compile(cli::state s){
     if (s.dev_debug){
@@ -54,30 +116,97 @@ void compile(cli::state s){
             }
             Parser::Parser parser(tokens,path);
             ast::AstNodePtr program = parser.parse();
+            if(s.import_graph!=""){
+                Utils::ImportGraph graph(s.input_filename,program);
+                std::cout<<(s.import_graph=="dot"?graph.dot():graph.json());
+                return;
+            }
             astValidator::Validator val(program,path,s.emit_js,s.has_main);
             auto output=s.output_filename;
+            std::vector<std::string> runtime;
+            if(!s.doc_html){
+                program=tailCall::eliminate(program);
+            }
             
             if (s.emit_js){
-                js::Codegen codegen(output, program, false, path);
+                std::ofstream out(output);
+                js::Codegen codegen(out, program, false, path);
             }else if(s.emit_html){
-                js::Codegen codegen(output, program, true, path);
+                std::ofstream out(output);
+                js::Codegen codegen(out, program, true, path);
             }else if(s.doc_html){
-                html::Docgen Docgen(output, program, path);
+                std::ofstream out(output);
+                html::Docgen Docgen(out, program, path);
             }else if(s.emit_cpp){
-                cpp::Codegen codegen(output, program,path);
+                std::ofstream out(output);
+                cpp::Codegen codegen(out, program,path,s.profile_alloc,false,s.reorder_fields,s.march_dispatch);
+                codegen.print_layouts();
+                runtime=codegen.runtime_headers();
             }else if(s.emit_obj){
-                cpp::Codegen codegen("temp.cc", program,path);
-                auto cmd=s.cpp_compiler+"  -c -std=c++20 temp.cc -fpermissive -w "+s.cpp_arg+" -o "+output;
-                system(cmd.c_str());
-                system("rm temp.cc");
+                std::ostringstream source;
+                cpp::Codegen codegen(source, program,path,s.profile_alloc,false,s.reorder_fields,s.march_dispatch);
+                codegen.print_layouts();
+                runtime=codegen.runtime_headers();
+                //-x none makes the files passed with -cc_arg go by their extension again
+                runBackend(s,{"-c","-std=c++20","-x","c++","-","-x","none","-fpermissive","-w","-o",output},source.str());
             }else{
-                cpp::Codegen codegen("temp.cc", program,path);
+                std::ostringstream source;
+                cpp::Codegen codegen(source, program,path,s.profile_alloc,s.time_trace,s.reorder_fields,s.march_dispatch);
+                codegen.print_layouts();
+                runtime=codegen.runtime_headers();
+                //the runtime of @parallel loops uses threads
+                s.cpp_arg+=" -pthread ";
                 if(s.is_release){
-                    s.cpp_arg+=" -flto -s ";
+                    //the size report needs the symbols so dont strip them
+                    s.cpp_arg+=s.size_report?" -flto ":" -flto -s ";
+                }
+                if(s.run){
+                    runCached(s,source.str());
+                }
+                else if(s.time_trace){
+                    //clang writes the trace next to the object file, so compile and link
+                    //separately in a directory of our own
+                    Utils::TempDir dir;
+                    if(dir.path()==""){
+                        std::cout<<"Error: could not create a temporary directory"<<std::endl;
+                        exit(1);
+                    }
+                    std::ofstream(dir.file("temp.cc"))<<source.str();
+                    runBackend(s,{"-c","-std=c++2a",dir.file("temp.cc"),"-fpermissive","-w","-ftime-trace",
+                                  "-ftime-trace-granularity=0","-o",dir.file("temp.o")});
+                    runBackend(s,{dir.file("temp.o"),"-o",output});
+                    Utils::TimeTrace trace(path,program,codegen.symbol_origins());
+                    if(!trace.load(dir.file("temp.json"))){
+                        std::cout<<"Error: could not read the time trace written by "<<s.cpp_compiler<<std::endl;
+                        exit(1);
+                    }
+                    trace.print();
+                }
+                else{
+                    runBackend(s,{"-std=c++2a","-x","c++","-","-x","none","-fpermissive","-w","-o",output},source.str());
                 }
-                auto cmd=s.cpp_compiler+" -std=c++2a temp.cc -fpermissive -w "+s.cpp_arg+" -o "+output;
-                system(cmd.c_str());
-                system("rm temp.cc");
+                if(s.size_report){
+                    Utils::SizeReport report(path,codegen.symbol_origins());
+                    if(!report.collect(output)){
+                        std::cout<<"Error: could not read the symbols of "<<output<<" (is nm installed?)"<<std::endl;
+                        exit(1);
+                    }
+                    report.print();
+                    std::ofstream json(output+".size.json");
+                    json<<report.json();
+                }
+            }
+            if(s.depfile){
+                //written once the output is, so that a failed build is not taken as up to date
+                Utils::ImportGraph graph(s.input_filename,program);
+                std::vector<std::string> deps;
+                for(auto& module:graph.modules()){
+                    deps.push_back(module.path);
+                }
+                for(auto& header:Utils::runtimeIncludes(runtime)){
+                    deps.push_back(header);
+                }
+                std::ofstream(s.depfile_name)<<Utils::makeRule(output,deps);
             }
         }
         else{
@@ -95,7 +224,13 @@ int main(int argc, char** argv) {
         return 0;
     } else {
         state.validate_state();
-        compile(state);
+        try{
+            compile(state);
+        }
+        catch(const CompileError& e){
+            display(e);
+            return 1;
+        }
     }
     return 0;
 }
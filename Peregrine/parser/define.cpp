@@ -451,7 +451,18 @@ AstNodePtr Parser::parseClassDefinition() {
                 break;
             }
             case tk_at:{
-                methods.push_back(parseDecoratorCall());
+                //@align and @padded fields
+                auto decorated=parseDecoratorCall();
+                auto body=std::dynamic_pointer_cast<DecoratorStatement>(decorated)->body();
+                if(body->type()==KAstStatic){
+                    body=std::dynamic_pointer_cast<StaticStatement>(body)->body();
+                }
+                if(body->type()==KAstVariableStmt||body->type()==KAstConstDecl){
+                    attributes.push_back(decorated);
+                }
+                else{
+                    methods.push_back(decorated);
+                }
                 break;
             }
             case tk_inline: {
@@ -550,11 +561,34 @@ AstNodePtr Parser::parseDecoratorCall() {
     @decorator_name
     def name():
         ...
+    or a decorated loop
+    @parallel
+    for i in range(n):
+        ...
+    or a class and its fields
+    @align(64)
+    class name:
+        @padded
+        field:type
+    or the branch an if usually takes
+    @unlikely
+    if condition:
+        ...
     */
     auto tok = m_currentToken;
     std::vector<AstNodePtr> decorators;
     AstNodePtr body;
     while (m_currentToken.tkType == tk_at) {
+        if (next().tkType == tk_const) {
+            //@const is spelled like the keyword
+            advance();
+            decorators.push_back(std::make_shared<IdentifierExpression>(m_currentToken, "const"));
+            advance();
+            if (m_currentToken.tkType == tk_new_line) {
+                advance();
+            }
+            continue;
+        }
         if (next().tkType != tk_identifier) {
             error(next(), "Expected an identifier, got " +
                                   next().keyword +
@@ -569,6 +603,16 @@ AstNodePtr Parser::parseDecoratorCall() {
         body = parseFunctionDef();
     } else if (m_currentToken.tkType == tk_static) {
         body = parseStatic();
+    } else if (m_currentToken.tkType == tk_for) {
+        body = parseFor();
+    } else if (m_currentToken.tkType == tk_if) {
+        body = parseIf();
+    } else if (m_currentToken.tkType == tk_class) {
+        body = parseClassDefinition();
+    } else if (m_currentToken.tkType == tk_identifier) {
+        body = parseVariableStatement();
+    } else if (m_currentToken.tkType == tk_const) {
+        body = parseConstDeclaration();
     }
     else if(m_currentToken.tkType==tk_inline){
         error(m_currentToken,"Can't use decorators with inline function","","","");
@@ -577,7 +621,7 @@ AstNodePtr Parser::parseDecoratorCall() {
         error(m_currentToken,"Can't use decorators with virtual function","","","");
     }
     else{
-        error(m_currentToken, "Expected a function declaration but got "+m_currentToken.keyword+" instead","","","");
+        error(m_currentToken, "Expected a function, class or field declaration, a for loop or an if but got "+m_currentToken.keyword+" instead","","","");
     }
     return std::make_shared<DecoratorStatement>(tok, decorators, body);
 }
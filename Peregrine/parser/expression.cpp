@@ -99,6 +99,10 @@ AstNodePtr Parser::parseExpression(PrecedenceType currPrecedence) {
             left=parseLambda();
             break;
         }
+        case tk_await:{
+            left=parseAwait();
+            break;
+        }
         case tk_ident: {
             error(m_currentToken,
                   "IndentationError: unexpected indent");
@@ -261,6 +265,15 @@ AstNodePtr Parser::parsePrefixExpression() {
     return std::make_shared<PrefixExpression>(prefix, prefix, right);
 }
 
+AstNodePtr Parser::parseAwait() {
+    //await value
+    //await sleep(10)
+    Token tok = m_currentToken;
+    advance();
+    AstNodePtr value = parseExpression(pr_prefix);
+    return std::make_shared<AwaitExpression>(tok, value);
+}
+
 AstNodePtr Parser::parsePostfixExpression(AstNodePtr left) {
     //increment and decrement
     //i++
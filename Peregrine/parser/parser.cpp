@@ -159,6 +159,16 @@ AstNodePtr Parser::parseStatement() {
             break;
         }
 
+        case tk_yield: {
+            stmt = parseYield();
+            break;
+        }
+
+        case tk_spawn: {
+            stmt = parseSpawn();
+            break;
+        }
+
         case tk_scope: {
             stmt = parseScope();
             break;
@@ -191,6 +201,10 @@ AstNodePtr Parser::parseStatement() {
             stmt = parseExport();
             break;
         }
+        case tk_async:{
+            stmt = parseAsync();
+            break;
+        }
         case tk_try:{
             stmt = parseTryExcept();
             break;
@@ -450,6 +464,17 @@ AstNodePtr Parser::parseExport() {
     return std::make_shared<ExportStatement>(tok, body);
 }
 
+AstNodePtr Parser::parseAsync() {
+    //coroutine that can wait for other coroutines, timers and io
+    //async def function()->type:...
+    auto tok = m_currentToken;
+    expect(tk_def, "Expected function defination but got " +
+                          next().keyword +
+                          " instead");
+    AstNodePtr body=parseFunctionDef();
+    return std::make_shared<AsyncStatement>(tok, body);
+}
+
 AstNodePtr Parser::parseExtern(){
     //use external c library
     //extern c=import("lib1","lib2")
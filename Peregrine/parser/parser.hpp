@@ -105,6 +105,7 @@ class Parser {
     AstNodePtr parseCast();
     AstNodePtr parseLambda();
     AstNodePtr parseGeneric(AstNodePtr identifier);
+    AstNodePtr parseAwait();
 
     //defined in statement.cpp
     AstNodePtr parseAsm();
@@ -116,6 +117,8 @@ class Parser {
     AstNodePtr parseScope();
     AstNodePtr parseWhile();
     AstNodePtr parseReturn();
+    AstNodePtr parseYield();
+    AstNodePtr parseSpawn();
     AstNodePtr parseTryExcept();
     AstNodePtr parseFor();
 
@@ -144,6 +147,7 @@ class Parser {
     AstNodePtr parseStatic();
     AstNodePtr parseInline();
     AstNodePtr parseExport();
+    AstNodePtr parseAsync();
     AstNodePtr parseDefaultArg();
     AstNodePtr parsePrivate(bool is_class=false);
 
@@ -468,6 +468,27 @@ AstNodePtr Parser::parseReturn() {
     return std::make_shared<ReturnStatement>(tok, returnValue);
 }
 
+AstNodePtr Parser::parseYield() {
+    //hands a value to the loop that iterates over the generator
+    //yield value
+    Token tok = m_currentToken;
+    AstNodePtr value=std::make_shared<NoLiteral>();
+    advance();
+    if (m_currentToken.tkType != tk_new_line) {
+        value = parseExpression();
+    }
+    return std::make_shared<YieldStatement>(tok, value);
+}
+
+AstNodePtr Parser::parseSpawn() {
+    //starts a task that the enclosing scope waits for, or a coroutine
+    //spawn func(args)
+    Token tok = m_currentToken;
+    advance();
+    AstNodePtr value = parseExpression();
+    return std::make_shared<SpawnStatement>(tok, value);
+}
+
 AstNodePtr Parser::parseTryExcept(){
     //try except statement
     /*
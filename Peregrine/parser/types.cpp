@@ -29,6 +29,11 @@ AstNodePtr Parser::parseType(bool can_be_sumtype) {
             res = parseListType();
             break;
         }
+        case tk_integer:{
+            //the number of lanes in vec{f32,8}
+            res = parseInteger();
+            break;
+        }
         case tk_identifier: {
             if (next().tkType == tk_dot) {
                 res = parseImportedType();
@@ -50,8 +50,7 @@ void Parser::error(Token tok, std::string msg,std::string submsg,std::string hin
                    hint,
                    ecode};
 
-    display(err);
-    exit(1);
+    throw CompileError({err});
 }
 
 void Parser::expect(TokenType expectedType, std::string msg,std::string submsg,std::string hint,std::string ecode) {
@@ -120,6 +119,15 @@ parameter Parser::parseParameter(){
     AstNodePtr paramDefault = std::make_shared<NoLiteral>();
     AstNodePtr paramName = std::make_shared<NoLiteral>();
     bool is_const = false;
+    bool is_noalias = false;
+    if(m_currentToken.tkType==tk_at){
+        if(next().tkType!=tk_identifier||next().keyword!="noalias"){
+            error(next(),"Expected noalias but got "+next().keyword+" instead","Parameters can only be decorated with @noalias","","");
+        }
+        advance();
+        advance();
+        is_noalias=true;
+    }
     if(m_currentToken.tkType==tk_const){
         is_const=true;
         advance();
@@ -168,6 +176,6 @@ parameter Parser::parseParameter(){
         paramDefault=parseExpression();
         advance();
     }
-    return parameter{paramType, paramName,paramDefault,is_const};
+    return parameter{paramType, paramName,paramDefault,is_const,Normal,is_noalias};
 }
 }
\ No newline at end of file
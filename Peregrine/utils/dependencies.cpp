@@ -0,0 +1,171 @@
+#include "dependencies.hpp"
+#include "lexer/lexer.hpp"
+#include "parser/parser.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+namespace fs=std::filesystem;
+namespace Utils{
+static std::string json_escape(std::string str){
+    std::string res;
+    for(auto& c:str){
+        if(c=='"'||c=='\\'){
+            res+='\\';
+        }
+        res+=c;
+    }
+    return res;
+}
+//a.b.c as it is written in the import
+static std::string moduleName(ast::AstNodePtr name){
+    if(name->type()==ast::KAstDotExpression){
+        auto dot=std::dynamic_pointer_cast<ast::DotExpression>(name);
+        return moduleName(dot->owner())+"."+moduleName(dot->referenced());
+    }
+    return name->stringify();
+}
+static std::vector<std::string> importedModules(ast::AstNodePtr program){
+    std::vector<std::string> res;
+    for(auto& stmt:std::dynamic_pointer_cast<ast::Program>(program)->statements()){
+        if(stmt->type()!=ast::KAstImportStmt){
+            continue;
+        }
+        auto import=std::dynamic_pointer_cast<ast::ImportStatement>(stmt);
+        if(import->moduleName()->type()!=ast::KAstNoLiteral){
+            //from a import b
+            res.push_back(moduleName(import->moduleName()));
+        }
+        else{
+            //import a, b as c
+            for(auto& module:import->importedSymbols()){
+                res.push_back(moduleName(module.first));
+            }
+        }
+    }
+    return res;
+}
+
+ImportGraph::ImportGraph(std::string path,ast::AstNodePtr program){
+    //the paths of imports are normal too, an import of the file itself has
+    //to find it under the same name
+    add(fs::path(path).lexically_normal().string(),program);
+}
+void ImportGraph::add(std::string path,ast::AstNodePtr program){
+    size_t index=m_modules.size();
+    m_index[path]=index;
+    m_modules.push_back({path,{},{}});
+    for(auto& name:importedModules(program)){
+        std::string file=name;
+        std::replace(file.begin(),file.end(),'.','/');
+        auto dep=(fs::path(path).parent_path()/(file+".pe")).lexically_normal().string();
+        std::ifstream in(dep);
+        auto& list=in?m_modules[index].imports:m_modules[index].unresolved;
+        auto entry=in?dep:name;
+        //from a import b after import a is the same edge
+        if(std::find(list.begin(),list.end(),entry)!=list.end()){
+            continue;
+        }
+        list.push_back(entry);
+        if(!in||m_index.count(dep)>0){
+            continue;
+        }
+        std::stringstream buf;
+        buf<<in.rdbuf();
+        ast::AstNodePtr imported;
+        try{
+            auto tokens=LEXER(buf.str(),dep).result();
+            imported=Parser::Parser(tokens,dep).parse();
+        }
+        catch(const CompileError&){
+            //it is still a dependency, but what it imports is not known
+            imported=std::make_shared<ast::Program>(std::vector<ast::AstNodePtr>{},"");
+        }
+        add(dep,imported);
+    }
+}
+const std::vector<ModuleNode>& ImportGraph::modules() const{
+    return m_modules;
+}
+std::string ImportGraph::json() const{
+    std::string res="{\n  \"root\": \""+json_escape(m_modules[0].path)+"\",\n  \"modules\": [";
+    for(size_t i=0;i<m_modules.size();++i){
+        auto& x=m_modules[i];
+        res+=(i?",\n":"\n");
+        res+="    {\"path\": \""+json_escape(x.path)+"\", \"imports\": [";
+        for(size_t j=0;j<x.imports.size();++j){
+            res+=(j?", \"":"\"")+json_escape(x.imports[j])+"\"";
+        }
+        res+="], \"unresolved\": [";
+        for(size_t j=0;j<x.unresolved.size();++j){
+            res+=(j?", \"":"\"")+json_escape(x.unresolved[j])+"\"";
+        }
+        res+="]}";
+    }
+    res+="\n  ]\n}\n";
+    return res;
+}
+std::string ImportGraph::dot() const{
+    std::string res="digraph imports {\n";
+    for(auto& x:m_modules){
+        res+="  \""+json_escape(x.path)+"\";\n";
+        for(auto& dep:x.imports){
+            res+="  \""+json_escape(x.path)+"\" -> \""+json_escape(dep)+"\";\n";
+        }
+        for(auto& name:x.unresolved){
+            res+="  \""+json_escape(x.path)+"\" -> \""+json_escape(name)+"\" [style=dashed];\n";
+        }
+    }
+    res+="}\n";
+    return res;
+}
+
+std::vector<std::string> runtimeIncludes(std::vector<std::string> headers){
+    std::vector<std::string> res;
+    std::set<std::string> seen;
+    while(headers.size()>0){
+        auto header=headers.back();
+        headers.pop_back();
+        if(!seen.insert(header).second){
+            continue;
+        }
+        res.push_back(header);
+        std::ifstream in(header);
+        std::string line;
+        while(std::getline(in,line)){
+            //the runtime includes its own headers with quotes, the rest with <>
+            if(line.rfind("#include \"",0)==0&&line.find('"',10)!=std::string::npos){
+                auto name=line.substr(10,line.find('"',10)-10);
+                headers.push_back((fs::path(header).parent_path()/name).string());
+            }
+        }
+    }
+    return res;
+}
+
+static std::string make_escape(std::string path){
+    std::string res;
+    for(auto& c:path){
+        if(c==' '||c=='#'){
+            res+='\\';
+        }
+        else if(c=='$'){
+            res+='$';
+        }
+        res+=c;
+    }
+    return res;
+}
+std::string makeRule(std::string target,std::vector<std::string> deps){
+    std::string res=make_escape(target)+":";
+    for(auto& dep:deps){
+        res+=" \\\n  "+make_escape(dep);
+    }
+    res+="\n";
+    for(size_t i=1;i<deps.size();++i){
+        res+="\n"+make_escape(deps[i])+":\n";
+    }
+    return res;
+}
+}
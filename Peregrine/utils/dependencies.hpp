@@ -0,0 +1,36 @@
+#ifndef PEREGRINE_DEPENDENCIES_HPP
+#define PEREGRINE_DEPENDENCIES_HPP
+
+#include "ast/ast.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+namespace Utils{
+struct ModuleNode{
+    std::string path;
+    std::vector<std::string> imports;//paths of the modules it imports
+    std::vector<std::string> unresolved;//names of the ones that were not found
+};
+
+//the modules a file imports, directly or through other modules. import a.b
+//is the file a/b.pe next to the module that imports it
+class ImportGraph{
+    std::vector<ModuleNode> m_modules;//the first one is the file itself
+    std::map<std::string, size_t> m_index;
+    void add(std::string path,ast::AstNodePtr program);
+    public:
+    ImportGraph(std::string path,ast::AstNodePtr program);
+    const std::vector<ModuleNode>& modules() const;
+    std::string json() const;
+    std::string dot() const;
+};
+
+//the runtime headers and the ones they include themselves
+std::vector<std::string> runtimeIncludes(std::vector<std::string> headers);
+//a make rule, which ninja reads too, saying that target has to be rebuilt
+//when one of deps changes. every dependency but the first gets an empty rule
+//so that make does not stop once it is deleted, like gcc -MP
+std::string makeRule(std::string target,std::vector<std::string> deps);
+}
+#endif
@@ -0,0 +1,93 @@
+#include "process.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <sstream>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+namespace Utils{
+std::vector<std::string> splitArgs(std::string args){
+    std::vector<std::string> res;
+    std::istringstream stream(args);
+    std::string arg;
+    while(stream>>arg){
+        res.push_back(arg);
+    }
+    return res;
+}
+
+int run(const std::vector<std::string>& args,const std::string& input){
+    if(args.size()==0){
+        return -1;
+    }
+    std::vector<char*> argv;
+    for(auto& arg:args){
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(NULL);
+    //the write end is close on exec so the child sees the end of its input
+    //once we close ours, dup2 clears the flag on its stdin
+    int fds[2];
+    if(pipe2(fds,O_CLOEXEC)!=0){
+        return -1;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions,fds[0],STDIN_FILENO);
+    pid_t pid;
+    int err=posix_spawnp(&pid,argv[0],&actions,NULL,argv.data(),environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[0]);
+    if(err!=0){
+        close(fds[1]);
+        return -1;
+    }
+    //a compiler that stops reading early should not take us down with SIGPIPE
+    auto previous=signal(SIGPIPE,SIG_IGN);
+    size_t written=0;
+    while(written<input.size()){
+        ssize_t n=write(fds[1],input.data()+written,input.size()-written);
+        if(n<0&&errno==EINTR){
+            continue;
+        }
+        if(n<=0){
+            break;
+        }
+        written+=n;
+    }
+    close(fds[1]);
+    signal(SIGPIPE,previous);
+    int status;
+    while(waitpid(pid,&status,0)<0){
+        if(errno!=EINTR){
+            return -1;
+        }
+    }
+    return WIFEXITED(status)?WEXITSTATUS(status):-1;
+}
+
+TempDir::TempDir(){
+    const char* tmp=getenv("TMPDIR");
+    std::string pattern=std::string(tmp&&*tmp?tmp:"/tmp")+"/peregrine-XXXXXX";
+    if(mkdtemp(pattern.data())!=NULL){
+        m_path=pattern;
+    }
+}
+TempDir::~TempDir(){
+    if(m_path!=""){
+        std::error_code ec;
+        std::filesystem::remove_all(m_path,ec);
+    }
+}
+std::string TempDir::path() const{
+    return m_path;
+}
+std::string TempDir::file(std::string name) const{
+    return m_path+"/"+name;
+}
+}
@@ -0,0 +1,27 @@
+#ifndef PEREGRINE_PROCESS_HPP
+#define PEREGRINE_PROCESS_HPP
+
+#include <string>
+#include <vector>
+namespace Utils{
+//splits a command line on whitespace, there is no quoting as no shell runs it
+std::vector<std::string> splitArgs(std::string args);
+//runs args[0], found through PATH, with input written to its stdin and waits
+//for it. returns its exit status, -1 if it could not be started
+int run(const std::vector<std::string>& args,const std::string& input="");
+
+//a directory under $TMPDIR (or /tmp) that no other compile uses, it is
+//removed with everything in it when this goes out of scope
+class TempDir{
+    std::string m_path;
+    public:
+    TempDir();
+    ~TempDir();
+    TempDir(const TempDir&)=delete;
+    TempDir& operator=(const TempDir&)=delete;
+    //empty if the directory could not be created
+    std::string path() const;
+    std::string file(std::string name) const;
+};
+}
+#endif
@@ -0,0 +1,158 @@
+#include "runCache.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <set>
+namespace fs=std::filesystem;
+namespace Utils{
+namespace{
+//FNV-1a, there is one entry per program so 64 bits are plenty
+struct Hash{
+    uint64_t value=14695981039346656037ull;
+    void add(const std::string& data){
+        for(unsigned char c:data){
+            value=(value^c)*1099511628211ull;
+        }
+        //keeps "ab","c" apart from "a","bc"
+        value=(value^0xff)*1099511628211ull;
+    }
+};
+//the size and time of the last write of a file, empty if it is not one
+std::string stamp(const fs::path& path){
+    std::error_code ec;
+    if(!fs::is_regular_file(path,ec)){
+        return "";
+    }
+    auto size=fs::file_size(path,ec);
+    auto time=fs::last_write_time(path,ec).time_since_epoch().count();
+    return std::to_string(size)+":"+std::to_string(time);
+}
+//the file that runs for a command name, the way execvp finds it
+fs::path executable(const std::string& name){
+    if(name.find('/')!=std::string::npos){
+        return name;
+    }
+    auto path=getenv("PATH");
+    std::string dirs=path?path:"/usr/bin:/bin";
+    size_t start=0;
+    while(start<=dirs.size()){
+        auto end=dirs.find(':',start);
+        if(end==std::string::npos){
+            end=dirs.size();
+        }
+        auto candidate=fs::path(dirs.substr(start,end-start))/name;
+        if(stamp(candidate)!=""){
+            return candidate;
+        }
+        start=end+1;
+    }
+    return name;
+}
+}
+
+RunCache::RunCache(){
+    std::string dir;
+    if(auto env=getenv("PEREGRINE_CACHE_DIR");env&&*env){
+        dir=env;
+    }
+    else if(auto xdg=getenv("XDG_CACHE_HOME");xdg&&*xdg){
+        dir=std::string(xdg)+"/peregrine";
+    }
+    else if(auto home=getenv("HOME");home&&*home){
+        dir=std::string(home)+"/.cache/peregrine";
+    }
+    else{
+        return;
+    }
+    m_limit=512;
+    if(auto size=getenv("PEREGRINE_CACHE_SIZE");size&&*size){
+        m_limit=strtoull(size,NULL,10);
+    }
+    m_limit*=1024*1024;
+    std::error_code ec;
+    fs::create_directories(dir,ec);
+    if(fs::is_directory(dir,ec)){
+        m_dir=dir;
+    }
+}
+std::string RunCache::dir() const{
+    return m_dir;
+}
+std::string RunCache::binary(const std::string& source,const std::vector<std::string>& command) const{
+    Hash hash;
+    hash.add(source);
+    for(auto& arg:command){
+        hash.add(arg);
+        //-cc_flag lib.o or -cc_flag -include -cc_flag x.h name files that can
+        //change without the command changing
+        hash.add(stamp(arg));
+    }
+    //the compiler itself, an upgrade changes what it builds. through the
+    //symlinks, g++ is usually one to the real driver
+    if(command.size()>0){
+        std::error_code ec;
+        auto compiler=executable(command[0]);
+        auto real=fs::canonical(compiler,ec);
+        hash.add(ec?compiler.string():real.string());
+        hash.add(stamp(ec?compiler:real));
+    }
+    //the generated code includes the runtime by path, so an edit there has to
+    //be seen as well. sorted, the order of a directory listing is not fixed
+    std::set<std::string> headers;
+    std::error_code ec;
+    for(auto& entry:fs::directory_iterator(PEREGRINE_RUNTIME_DIR,ec)){
+        auto time=fs::last_write_time(entry.path(),ec).time_since_epoch().count();
+        headers.insert(entry.path().filename().string()+":"+std::to_string(time));
+    }
+    for(auto& header:headers){
+        hash.add(header);
+    }
+    char name[17];
+    snprintf(name,sizeof(name),"%016llx",(unsigned long long)hash.value);
+    return m_dir+"/"+name;
+}
+void RunCache::used(const std::string& binary) const{
+    std::error_code ec;
+    fs::last_write_time(binary,fs::file_time_type::clock::now(),ec);
+}
+bool RunCache::store(const std::string& built,const std::string& binary) const{
+    std::error_code ec;
+    fs::rename(built,binary,ec);
+    if(ec){
+        return false;
+    }
+    evict(binary);
+    return true;
+}
+void RunCache::evict(const std::string& keep) const{
+    //oldest first. binaries that are still being built have a . in the name
+    //and belong to another run
+    std::vector<std::pair<fs::file_time_type,fs::path>> binaries;
+    uintmax_t total=0;
+    std::error_code ec;
+    for(auto& entry:fs::directory_iterator(m_dir,ec)){
+        auto name=entry.path().filename().string();
+        if(name.find('.')!=std::string::npos||!entry.is_regular_file(ec)){
+            continue;
+        }
+        total+=entry.file_size(ec);
+        binaries.push_back({entry.last_write_time(ec),entry.path()});
+    }
+    std::sort(binaries.begin(),binaries.end());
+    for(auto& [time,path]:binaries){
+        if(total<=m_limit){
+            break;
+        }
+        if(path==keep){
+            continue;
+        }
+        auto size=fs::file_size(path,ec);
+        //a program that is running keeps its copy, unlinking it is safe
+        if(fs::remove(path,ec)){
+            total-=size;
+        }
+    }
+}
+}
@@ -0,0 +1,31 @@
+#ifndef PEREGRINE_RUN_CACHE_HPP
+#define PEREGRINE_RUN_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+namespace Utils{
+//the binaries built by peregrine run, named by a hash of the generated C++,
+//the command that compiles it, the compiler, the files the command names and
+//the runtime headers. a program that is run again without a change that
+//reaches the C++ starts without a compile
+class RunCache{
+    std::string m_dir;
+    uintmax_t m_limit;//bytes the binaries may take together
+    void evict(const std::string& keep) const;
+    public:
+    //$PEREGRINE_CACHE_DIR, $XDG_CACHE_HOME/peregrine or ~/.cache/peregrine.
+    //$PEREGRINE_CACHE_SIZE is the limit in MiB, 512 by default
+    RunCache();
+    //empty if the directory could not be created
+    std::string dir() const;
+    std::string binary(const std::string& source,const std::vector<std::string>& command) const;
+    //marks a binary that is run from the cache as recently used
+    void used(const std::string& binary) const;
+    //moves a binary built somewhere else in the directory to its place. the
+    //rename is atomic, so runs of the same program never see half a binary.
+    //the least recently used binaries are removed once the limit is passed
+    bool store(const std::string& built,const std::string& binary) const;
+};
+}
+#endif
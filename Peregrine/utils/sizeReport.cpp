@@ -0,0 +1,139 @@
+#include "sizeReport.hpp"
+#include "symbolTable.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+namespace Utils{
+static std::string json_escape(std::string str){
+    std::string res;
+    for(auto& c:str){
+        if(c=='"'||c=='\\'){
+            res+='\\';
+        }
+        res+=c;
+    }
+    return res;
+}
+SizeReport::SizeReport(std::string module,std::map<std::string, std::string> origins){
+    m_module=module;
+    m_origins=origins;
+}
+void SizeReport::add(std::string symbol,size_t size){
+    size_t pos;
+    std::string mangled=find_origin(m_origins,symbol,pos);
+    SizeEntry entry;
+    if(mangled==""){
+        entry.name="<runtime and libraries>";
+        entry.kind="runtime";
+    }
+    else{
+        entry.name=m_origins[mangled];
+        std::string rest=symbol.substr(pos+mangled.size());
+        std::string member="::____mem____P____P____";
+        if(rest.rfind(member,0)==0){
+            std::string method=rest.substr(member.size());
+            method=method.substr(0,method.find_first_of("(:<"));
+            entry.name+="."+method;
+            entry.kind="method";
+        }
+        else if(rest.rfind("::"+mangled+"(",0)==0){
+            entry.name+=".__init__";
+            entry.kind="method";
+        }
+        else if(rest.rfind("::~"+mangled+"(",0)==0){
+            entry.name+=".__del__";
+            entry.kind="method";
+        }
+        else if(symbol.rfind("vtable for ",0)==0||symbol.rfind("typeinfo",0)==0){
+            entry.kind="global";
+        }
+        else if(rest=="" || rest[0]=='('){
+            entry.kind="function";
+        }
+        else{
+            entry.kind="global";
+        }
+        if(symbol.find("std::_Function_handler")!=std::string::npos||
+           symbol.find("std::_Function_base")!=std::string::npos){
+            entry.kind="std::function";
+        }
+        else if(symbol.find("{lambda")!=std::string::npos){
+            entry.kind="lambda";
+        }
+    }
+    m_total+=size;
+    for(auto& x:m_entries){
+        if(x.name==entry.name && x.kind==entry.kind){
+            x.size+=size;
+            x.symbols++;
+            return;
+        }
+    }
+    entry.size=size;
+    entry.symbols=1;
+    m_entries.push_back(entry);
+}
+bool SizeReport::collect(std::string binary){
+    std::string cmd="nm -C -S --size-sort \""+binary+"\" 2>/dev/null";
+    FILE* pipe=popen(cmd.c_str(),"r");
+    if(pipe==NULL){
+        return false;
+    }
+    char buf[4096];
+    std::string line;
+    while(fgets(buf,sizeof(buf),pipe)!=NULL){
+        line+=buf;
+        if(line.back()!='\n'){
+            continue;//symbol longer than the buffer
+        }
+        line.pop_back();
+        std::istringstream stream(line);
+        std::string address,size,type,symbol;
+        stream>>address>>size>>type;
+        std::getline(stream,symbol);
+        line="";
+        if(symbol.size()>0 && symbol[0]==' '){
+            symbol=symbol.substr(1);
+        }
+        if(symbol==""){
+            continue;
+        }
+        add(symbol,std::stoull(size,nullptr,16));
+    }
+    std::sort(m_entries.begin(),m_entries.end(),[](const SizeEntry& a,const SizeEntry& b){
+        return a.size>b.size;
+    });
+    return pclose(pipe)==0;
+}
+std::vector<SizeEntry> SizeReport::entries() const{
+    return m_entries;
+}
+size_t SizeReport::total() const{
+    return m_total;
+}
+void SizeReport::print() const{
+    std::cout<<"Size report for "<<m_module<<" ("<<m_total<<" bytes in sized symbols)\n";
+    std::cout<<std::setw(10)<<"bytes"<<std::setw(8)<<"%"<<std::setw(9)<<"symbols"<<"  "
+             <<std::left<<std::setw(15)<<"kind"<<"name"<<std::right<<"\n";
+    for(auto& x:m_entries){
+        double percent=m_total?(100.0*x.size/m_total):0;
+        std::cout<<std::setw(10)<<x.size<<std::setw(8)<<std::fixed<<std::setprecision(1)<<percent
+                 <<std::setw(9)<<x.symbols<<"  "<<std::left<<std::setw(15)<<x.kind<<x.name<<std::right<<"\n";
+    }
+}
+std::string SizeReport::json() const{
+    std::string res="{\n  \"module\": \""+json_escape(m_module)+"\",\n";
+    res+="  \"total\": "+std::to_string(m_total)+",\n";
+    res+="  \"entries\": [";
+    for(size_t i=0;i<m_entries.size();++i){
+        auto& x=m_entries[i];
+        res+=(i?",\n":"\n");
+        res+="    {\"name\": \""+json_escape(x.name)+"\", \"kind\": \""+x.kind+"\", ";
+        res+="\"size\": "+std::to_string(x.size)+", \"symbols\": "+std::to_string(x.symbols)+"}";
+    }
+    res+="\n  ]\n}\n";
+    return res;
+}
+}
@@ -0,0 +1,33 @@
+#ifndef PEREGRINE_SIZE_REPORT_HPP
+#define PEREGRINE_SIZE_REPORT_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+namespace Utils{
+//size of the code and data a single peregrine declaration ended up as
+struct SizeEntry{
+    std::string name;//peregrine name, Class.method for methods
+    std::string kind;//function, method, global, lambda, std::function or runtime
+    size_t size=0;
+    size_t symbols=0;
+};
+
+class SizeReport{
+    std::string m_module;
+    std::map<std::string, std::string> m_origins;//mangled name -> peregrine name
+    std::vector<SizeEntry> m_entries;
+    size_t m_total=0;
+    void add(std::string symbol,size_t size);
+    public:
+    SizeReport(std::string module,std::map<std::string, std::string> origins);
+    //reads the symbol table of the binary with nm, returns false if it could not
+    bool collect(std::string binary);
+    std::vector<SizeEntry> entries() const;
+    size_t total() const;
+    void print() const;
+    std::string json() const;
+};
+}
+#endif
@@ -32,6 +32,37 @@ std::string MangleName::operator[](std::string name){
         return name;
     }
 }
+std::map<std::string, std::string> MangleName::reverse_map(){
+    std::map<std::string, std::string> res;
+    for(auto const &p:m_global_names){
+        res[p.second]=p.first;
+    }
+    return res;
+}
+std::string find_origin(const std::map<std::string, std::string>& origins,std::string symbol,size_t& pos){
+    //the longest mangled name wins so that nested names are not
+    //attributed to their parents
+    std::string mangled;
+    pos=std::string::npos;
+    for(auto const &p:origins){
+        size_t found;
+        if(p.first.rfind("____P____P____",0)==0){
+            found=symbol.find(p.first);
+        }
+        else if(symbol==p.first||symbol.rfind(p.first+"(",0)==0){
+            //exported and builtin names are not mangled
+            found=0;
+        }
+        else{
+            continue;
+        }
+        if(found!=std::string::npos && p.first.size()>mangled.size()){
+            mangled=p.first;
+            pos=found;
+        }
+    }
+    return mangled;
+}
 void MangleName::print(){
     std::cout<<"Local{\n";
     for(auto const &p:m_local_names){
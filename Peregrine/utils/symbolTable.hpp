@@ -122,8 +122,13 @@ class MangleName{
     
     bool contains(std::string name);
     std::string operator[](std::string name);
+    std::map<std::string, std::string> reverse_map();//mangled global name -> original
     void print();
 };
+
+//finds the global in a reverse_map() that a backend symbol was generated from.
+//returns the mangled name (empty if none) and sets pos to where it starts in symbol
+std::string find_origin(const std::map<std::string, std::string>& origins,std::string symbol,size_t& pos);
 }
 
 #endif
\ No newline at end of file
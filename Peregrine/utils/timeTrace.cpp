@@ -0,0 +1,317 @@
+#include "timeTrace.hpp"
+#include "symbolTable.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+namespace Utils{
+//just enough json to read a trace file
+struct JsonValue{
+    enum{Null,Bool,Number,String,Array,Object} kind=Null;
+    double number=0;
+    std::string str;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string,JsonValue>> members;
+    const JsonValue* get(std::string key) const{
+        for(auto& x:members){
+            if(x.first==key){
+                return &x.second;
+            }
+        }
+        return nullptr;
+    }
+};
+static void skip_space(const std::string& in,size_t& i){
+    while(i<in.size() && isspace((unsigned char)in[i])){
+        i++;
+    }
+}
+static std::string parse_string(const std::string& in,size_t& i){
+    std::string res;
+    i++;//opening quote
+    while(i<in.size() && in[i]!='"'){
+        if(in[i]=='\\' && i+1<in.size()){
+            i++;
+            switch(in[i]){
+                case 'n':res+='\n';break;
+                case 't':res+='\t';break;
+                case 'u':{
+                    //non ascii characters are not needed for attribution
+                    res+='?';
+                    i+=4;
+                    break;
+                }
+                default:res+=in[i];
+            }
+        }
+        else{
+            res+=in[i];
+        }
+        i++;
+    }
+    i++;//closing quote
+    return res;
+}
+static bool parse_value(const std::string& in,size_t& i,JsonValue& value){
+    skip_space(in,i);
+    if(i>=in.size()){
+        return false;
+    }
+    switch(in[i]){
+        case '{':{
+            value.kind=JsonValue::Object;
+            i++;
+            skip_space(in,i);
+            while(i<in.size() && in[i]!='}'){
+                skip_space(in,i);
+                if(in[i]!='"'){
+                    return false;
+                }
+                std::string key=parse_string(in,i);
+                skip_space(in,i);
+                if(i>=in.size()||in[i]!=':'){
+                    return false;
+                }
+                i++;
+                JsonValue member;
+                if(!parse_value(in,i,member)){
+                    return false;
+                }
+                value.members.push_back({key,member});
+                skip_space(in,i);
+                if(i<in.size() && in[i]==','){
+                    i++;
+                }
+                skip_space(in,i);
+            }
+            i++;
+            return true;
+        }
+        case '[':{
+            value.kind=JsonValue::Array;
+            i++;
+            skip_space(in,i);
+            while(i<in.size() && in[i]!=']'){
+                JsonValue item;
+                if(!parse_value(in,i,item)){
+                    return false;
+                }
+                value.items.push_back(item);
+                skip_space(in,i);
+                if(i<in.size() && in[i]==','){
+                    i++;
+                }
+                skip_space(in,i);
+            }
+            i++;
+            return true;
+        }
+        case '"':{
+            value.kind=JsonValue::String;
+            value.str=parse_string(in,i);
+            return true;
+        }
+        case 't':
+        case 'f':
+        case 'n':{
+            value.kind=in[i]=='n'?JsonValue::Null:JsonValue::Bool;
+            value.number=in[i]=='t';
+            while(i<in.size() && isalpha((unsigned char)in[i])){
+                i++;
+            }
+            return true;
+        }
+        default:{
+            size_t end;
+            try{
+                value.number=std::stod(in.substr(i,32),&end);
+            }
+            catch(...){
+                return false;
+            }
+            value.kind=JsonValue::Number;
+            i+=end;
+            return true;
+        }
+    }
+}
+static std::string declaration_name(ast::AstNodePtr stmt){
+    switch(stmt->type()){
+        case ast::KAstFunctionDef:
+            return std::dynamic_pointer_cast<ast::FunctionDefinition>(stmt)->name()->stringify();
+        case ast::KAstClassDef:
+            return std::dynamic_pointer_cast<ast::ClassDefinition>(stmt)->name()->stringify();
+        case ast::KAstVariableStmt:
+            return std::dynamic_pointer_cast<ast::VariableStatement>(stmt)->name()->stringify();
+        case ast::KAstConstDecl:
+            return std::dynamic_pointer_cast<ast::ConstDeclaration>(stmt)->name()->stringify();
+        case ast::KAstUnion:
+            return std::dynamic_pointer_cast<ast::UnionLiteral>(stmt)->name()->stringify();
+        case ast::KAstEnum:
+            return std::dynamic_pointer_cast<ast::EnumLiteral>(stmt)->name()->stringify();
+        case ast::KAstTypeDefinition:
+            return std::dynamic_pointer_cast<ast::TypeDefinition>(stmt)->name()->stringify();
+        case ast::KAstDecorator:
+            return declaration_name(std::dynamic_pointer_cast<ast::DecoratorStatement>(stmt)->body());
+        case ast::KAstStatic:
+            return declaration_name(std::dynamic_pointer_cast<ast::StaticStatement>(stmt)->body());
+        case ast::KAstInline:
+            return declaration_name(std::dynamic_pointer_cast<ast::InlineStatement>(stmt)->body());
+        case ast::KAstExport:
+            return declaration_name(std::dynamic_pointer_cast<ast::ExportStatement>(stmt)->body());
+        case ast::KAstAsync:
+            return declaration_name(std::dynamic_pointer_cast<ast::AsyncStatement>(stmt)->body());
+        case ast::KAstPrivate:
+            return declaration_name(std::dynamic_pointer_cast<ast::PrivateDef>(stmt)->definition());
+        default:{
+            return "";
+        }
+    }
+}
+TimeTrace::TimeTrace(std::string module,ast::AstNodePtr program,std::map<std::string, std::string> origins){
+    m_module=module;
+    m_origins=origins;
+    auto statements=std::dynamic_pointer_cast<ast::Program>(program)->statements();
+    for(auto& stmt:statements){
+        std::string name=declaration_name(stmt);
+        if(name!=""){
+            m_decls.push_back({stmt->token().line,name});
+        }
+    }
+    std::sort(m_decls.begin(),m_decls.end());
+}
+std::string TimeTrace::declaration_at(size_t line){
+    std::string res;
+    for(auto& x:m_decls){
+        if(x.first>line){
+            break;
+        }
+        res=x.second;
+    }
+    return res;
+}
+std::string TimeTrace::attribute(std::string event,std::string detail){
+    //locations look like file:line:col, the #line directives make the file
+    //the peregrine module instead of the generated c++
+    if(detail.rfind(m_module+":",0)==0){
+        std::string rest=detail.substr(m_module.size()+1);
+        size_t line=std::strtoull(rest.c_str(),nullptr,10);
+        std::string name=declaration_at(line);
+        if(name!=""){
+            return name;
+        }
+    }
+    size_t pos;
+    std::string mangled=find_origin(m_origins,detail,pos);
+    if(mangled!=""){
+        return m_origins[mangled];
+    }
+    if(event=="Source"){
+        return "<headers>";
+    }
+    return "<runtime and libraries>";
+}
+bool TimeTrace::load(std::string trace_file){
+    std::ifstream file(trace_file);
+    if(!file){
+        return false;
+    }
+    std::stringstream buf;
+    buf<<file.rdbuf();
+    std::string in=buf.str();
+    size_t i=0;
+    JsonValue root;
+    if(!parse_value(in,i,root)){
+        return false;
+    }
+    auto events=root.get("traceEvents");
+    if(events==nullptr){
+        return false;
+    }
+    struct Event{
+        double ts;
+        double dur;
+        int phase;//0 parse, 1 instantiate, 2 codegen
+        std::string name;
+    };
+    std::vector<Event> complete;
+    for(auto& ev:events->items){
+        auto ph=ev.get("ph");
+        auto name=ev.get("name");
+        auto ts=ev.get("ts");
+        auto dur=ev.get("dur");
+        if(ph==nullptr||ph->str!="X"||name==nullptr||ts==nullptr||dur==nullptr){
+            continue;
+        }
+        if(name->str=="ExecuteCompiler"||name->str=="Total ExecuteCompiler"){
+            m_backend_total=std::max(m_backend_total,dur->number/1000);
+            continue;
+        }
+        int phase;
+        if(name->str.rfind("Parse",0)==0||name->str=="Source"){
+            phase=0;
+        }
+        else if(name->str.rfind("Instantiate",0)==0){
+            phase=1;
+        }
+        else if(name->str.rfind("CodeGen Function",0)==0||name->str=="OptFunction"){
+            phase=2;
+        }
+        else{
+            continue;
+        }
+        std::string detail;
+        auto args=ev.get("args");
+        if(args!=nullptr && args->get("detail")!=nullptr){
+            detail=args->get("detail")->str;
+        }
+        complete.push_back({ts->number,dur->number,phase,attribute(name->str,detail)});
+    }
+    //events of the same phase nest (a class contains its methods), only
+    //the outermost one is counted so that nothing is counted twice
+    std::sort(complete.begin(),complete.end(),[](const Event& a,const Event& b){
+        return a.ts<b.ts||(a.ts==b.ts && a.dur>b.dur);
+    });
+    double counted_until[3]={-1,-1,-1};
+    for(auto& ev:complete){
+        if(ev.ts<counted_until[ev.phase]){
+            continue;
+        }
+        counted_until[ev.phase]=ev.ts+ev.dur;
+        auto entry=std::find_if(m_entries.begin(),m_entries.end(),[&](const TraceEntry& x){
+            return x.name==ev.name;
+        });
+        if(entry==m_entries.end()){
+            m_entries.push_back(TraceEntry{ev.name});
+            entry=m_entries.end()-1;
+        }
+        double ms=ev.dur/1000;
+        switch(ev.phase){
+            case 0:entry->parse+=ms;break;
+            case 1:entry->instantiate+=ms;break;
+            default:entry->codegen+=ms;
+        }
+    }
+    std::sort(m_entries.begin(),m_entries.end(),[](const TraceEntry& a,const TraceEntry& b){
+        return a.total()>b.total();
+    });
+    return true;
+}
+std::vector<TraceEntry> TimeTrace::entries() const{
+    return m_entries;
+}
+void TimeTrace::print(size_t top) const{
+    std::cout<<"Backend compile time for "<<m_module;
+    if(m_backend_total>0){
+        std::cout<<" ("<<std::fixed<<std::setprecision(1)<<m_backend_total<<" ms in the c++ compiler)";
+    }
+    std::cout<<"\n"<<std::setw(10)<<"total ms"<<std::setw(10)<<"parse"<<std::setw(13)<<"instantiate"
+             <<std::setw(10)<<"codegen"<<"  name\n";
+    for(size_t i=0;i<m_entries.size() && i<top;++i){
+        auto& x=m_entries[i];
+        std::cout<<std::fixed<<std::setprecision(1)<<std::setw(10)<<x.total()<<std::setw(10)<<x.parse
+                 <<std::setw(13)<<x.instantiate<<std::setw(10)<<x.codegen<<"  "<<x.name<<"\n";
+    }
+}
+}
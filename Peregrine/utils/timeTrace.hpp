@@ -0,0 +1,38 @@
+#ifndef PEREGRINE_TIME_TRACE_HPP
+#define PEREGRINE_TIME_TRACE_HPP
+
+#include "ast/ast.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+namespace Utils{
+//backend time spent on code generated from a single peregrine declaration
+struct TraceEntry{
+    std::string name;
+    double parse=0;//milliseconds
+    double instantiate=0;
+    double codegen=0;
+    double total() const{return parse+instantiate+codegen;}
+};
+
+//reads the json written by clang -ftime-trace and attributes it to the
+//peregrine declarations, either through the mangled names in the event
+//details or through the #line directives the codegen emitted
+class TimeTrace{
+    std::string m_module;
+    std::map<std::string, std::string> m_origins;//mangled name -> peregrine name
+    std::vector<std::pair<size_t,std::string>> m_decls;//first line -> declaration
+    std::vector<TraceEntry> m_entries;
+    double m_backend_total=0;
+    std::string declaration_at(size_t line);
+    std::string attribute(std::string event,std::string detail);
+    public:
+    TimeTrace(std::string module,ast::AstNodePtr program,std::map<std::string, std::string> origins);
+    bool load(std::string trace_file);
+    std::vector<TraceEntry> entries() const;
+    void print(size_t top=15) const;
+};
+}
+#endif
@@ -0,0 +1,462 @@
+// Builds every program in benchmarks/programs three ways (hand written c++,
+// peregrine through the c++ backend and peregrine through the js backend),
+// runs them, checks their output against <name>.out and records the time and
+// peak memory of every run. With --counters the hardware performance counters
+// of every build and run are recorded as well.
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+struct options {
+    std::string peregrine = "peregrine.elf";
+    std::string programs = "benchmarks/programs";
+    std::string work = "benchmark_work";
+    std::string json = "";
+    std::string cxx = "c++";
+    std::string node = "node";
+    std::string filter = "";
+    int repeat = 3;
+    bool counters = false;
+};
+
+struct run_result {
+    bool started = false; // false if the program could not be executed
+    int status = -1;
+    double wall_ms = 0;
+    double user_ms = 0;
+    double sys_ms = 0;
+    long max_rss_kb = 0;
+    std::string output;
+    counter_values counters;
+    std::string counter_error; // why the counters are missing
+};
+
+struct variant_result {
+    std::string variant;
+    std::string error; // empty if it built, ran and printed the expected output
+    bool skipped = false;
+    double compile_ms = 0;
+    counter_values compile_counters;
+    std::string counter_error;
+    std::vector<run_result> runs;
+    const run_result* fastest() const {
+        const run_result* best = nullptr;
+        for (auto& run : runs) {
+            if (best == nullptr || run.wall_ms < best->wall_ms) {
+                best = &run;
+            }
+        }
+        return best;
+    }
+    double best_wall_ms() const {
+        return runs.empty() ? 0 : fastest()->wall_ms;
+    }
+    long max_rss_kb() const {
+        long res = 0;
+        for (auto& run : runs) {
+            res = std::max(res, run.max_rss_kb);
+        }
+        return res;
+    }
+};
+
+struct benchmark_result {
+    std::string name;
+    std::vector<variant_result> variants;
+};
+
+static double to_ms(const timeval& tv) {
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// runs args in cwd, stdout is captured and stderr is passed through
+static run_result run(const std::vector<std::string>& args, const std::string& cwd, bool capture, bool count) {
+    run_result res;
+    int out[2];
+    if (pipe(out) != 0) {
+        return res;
+    }
+    int exec_error[2]; // tells the parent if execvp failed
+    if (pipe(exec_error) != 0) {
+        close(out[0]);
+        close(out[1]);
+        return res;
+    }
+    int go[2]; // holds the child back until the counters are attached to it
+    if (pipe(go) != 0) {
+        close(out[0]);
+        close(out[1]);
+        close(exec_error[0]);
+        close(exec_error[1]);
+        return res;
+    }
+    fcntl(exec_error[1], F_SETFD, FD_CLOEXEC);
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(out[0]);
+        close(exec_error[0]);
+        close(go[1]);
+        char ready;
+        if (read(go[0], &ready, 1) != 1) {
+            _exit(127);
+        }
+        close(go[0]);
+        if (capture) {
+            dup2(out[1], STDOUT_FILENO);
+        } else {
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+        }
+        close(out[1]);
+        if (chdir(cwd.c_str()) != 0) {
+            _exit(127);
+        }
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        char failed = 1;
+        ssize_t ignored = write(exec_error[1], &failed, 1);
+        (void)ignored;
+        _exit(127);
+    }
+    close(out[1]);
+    close(exec_error[1]);
+    close(go[0]);
+    if (pid < 0) {
+        close(out[0]);
+        close(exec_error[0]);
+        close(go[1]);
+        return res;
+    }
+    perf_counters counters;
+    if (count && !counters.open(pid)) {
+        res.counter_error = counters.error();
+    }
+    char ready = 1;
+    ssize_t ignored = write(go[1], &ready, 1);
+    (void)ignored;
+    close(go[1]);
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(out[0], buf, sizeof(buf))) > 0) {
+        res.output.append(buf, n);
+    }
+    close(out[0]);
+    char failed;
+    res.started = read(exec_error[0], &failed, 1) == 0;
+    close(exec_error[0]);
+    int status;
+    rusage usage;
+    wait4(pid, &status, 0, &usage);
+    res.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    res.user_ms = to_ms(usage.ru_utime);
+    res.sys_ms = to_ms(usage.ru_stime);
+    res.max_rss_kb = usage.ru_maxrss;
+    res.counters = counters.read();
+    return res;
+}
+
+static std::string read_file(const fs::path& path) {
+    std::ifstream file(path);
+    std::stringstream buf;
+    buf << file.rdbuf();
+    return buf.str();
+}
+
+static std::string json_escape(const std::string& str) {
+    std::string res;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res;
+}
+
+// builds with the given command, then runs the result opts.repeat times
+static variant_result measure(const std::string& variant, const std::vector<std::string>& build,
+                              const std::vector<std::string>& exe, const std::string& expected,
+                              const fs::path& work, const options& opts) {
+    variant_result res;
+    res.variant = variant;
+    auto built = run(build, work, false, opts.counters);
+    res.compile_ms = built.wall_ms;
+    res.compile_counters = built.counters;
+    res.counter_error = built.counter_error;
+    if (!built.started) {
+        res.skipped = true;
+        res.error = build[0] + " not found";
+        return res;
+    }
+    if (built.status != 0) {
+        res.error = "build failed";
+        return res;
+    }
+    for (int i = 0; i < opts.repeat; ++i) {
+        auto ran = run(exe, work, true, opts.counters);
+        if (!ran.started) {
+            res.skipped = true;
+            res.error = exe[0] + " not found";
+            return res;
+        }
+        if (ran.status != 0) {
+            res.error = "exited with status " + std::to_string(ran.status);
+            return res;
+        }
+        if (ran.output != expected) {
+            res.error = "wrong output";
+            return res;
+        }
+        res.runs.push_back(ran);
+    }
+    return res;
+}
+
+static benchmark_result run_benchmark(const fs::path& source, const options& opts) {
+    benchmark_result res;
+    res.name = source.stem().string();
+    fs::path dir = source.parent_path();
+    fs::path work = fs::absolute(opts.work) / res.name;
+    fs::create_directories(work);
+    std::string expected = read_file(dir / (res.name + ".out"));
+
+    fs::path reference = dir / (res.name + ".cpp");
+    if (fs::exists(reference)) {
+        res.variants.push_back(measure("c++ reference",
+                                       {opts.cxx, "-O2", "-std=c++17", fs::absolute(reference).string(), "-o", "reference"},
+                                       {"./reference"}, expected, work, opts));
+    }
+    res.variants.push_back(measure("peregrine",
+                                   {opts.peregrine, "compile", fs::absolute(source).string(), "-release",
+                                    "-cc", opts.cxx, "-o", "peregrine"},
+                                   {"./peregrine"}, expected, work, opts));
+    // the js backend supports less of the language, programs that work with
+    // it have a <name>.js.pe next to them
+    fs::path js = dir / (res.name + ".js.pe");
+    if (fs::exists(js)) {
+        res.variants.push_back(measure("peregrine js",
+                                       {opts.peregrine, "compile", fs::absolute(js).string(), "-js", "-o", "peregrine.js"},
+                                       {opts.node, "peregrine.js"}, expected, work, opts));
+    }
+    return res;
+}
+
+static void print(const std::vector<benchmark_result>& results) {
+    std::cout << std::left << std::setw(16) << "benchmark" << std::setw(16) << "variant" << std::right
+              << std::setw(12) << "compile ms" << std::setw(12) << "run ms" << std::setw(10) << "vs c++"
+              << std::setw(12) << "max rss kb" << "  status\n";
+    for (auto& bench : results) {
+        double reference = 0;
+        for (auto& variant : bench.variants) {
+            if (variant.variant == "c++ reference" && variant.error == "") {
+                reference = variant.best_wall_ms();
+            }
+        }
+        for (auto& variant : bench.variants) {
+            std::cout << std::left << std::setw(16) << bench.name << std::setw(16) << variant.variant << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(12) << variant.compile_ms;
+            if (variant.error == "") {
+                std::cout << std::setw(12) << variant.best_wall_ms();
+                if (reference > 0) {
+                    std::cout << std::setw(9) << std::setprecision(2) << variant.best_wall_ms() / reference << "x";
+                } else {
+                    std::cout << std::setw(10) << "-";
+                }
+                std::cout << std::setw(12) << variant.max_rss_kb() << "  ok\n";
+            } else {
+                std::cout << std::setw(12) << "-" << std::setw(10) << "-" << std::setw(12) << "-" << "  "
+                          << (variant.skipped ? "skipped: " : "FAILED: ") << variant.error << "\n";
+            }
+        }
+    }
+}
+
+// ipc and miss rates of the fastest run, only printed with --counters
+static void print_counters(const std::vector<benchmark_result>& results) {
+    auto rate = [](double value, bool percent) {
+        std::ostringstream res;
+        if (value < 0) {
+            res << "-";
+        } else {
+            res << std::fixed << std::setprecision(2) << (percent ? value * 100 : value) << (percent ? "%" : "");
+        }
+        return res.str();
+    };
+    std::cout << "\n" << std::left << std::setw(16) << "benchmark" << std::setw(16) << "variant" << std::right
+              << std::setw(14) << "instructions" << std::setw(8) << "ipc" << std::setw(14) << "cache miss"
+              << std::setw(14) << "branch miss" << std::setw(14) << "compile ipc" << "\n";
+    for (auto& bench : results) {
+        for (auto& variant : bench.variants) {
+            if (variant.runs.empty()) {
+                continue;
+            }
+            auto& counters = variant.fastest()->counters;
+            std::cout << std::left << std::setw(16) << bench.name << std::setw(16) << variant.variant << std::right
+                      << std::setw(14) << (counters.has("instructions") ? std::to_string(counters.get("instructions")) : "-")
+                      << std::setw(8) << rate(counters.ipc(), false) << std::setw(14) << rate(counters.cache_miss_rate(), true)
+                      << std::setw(14) << rate(counters.branch_miss_rate(), true)
+                      << std::setw(14) << rate(variant.compile_counters.ipc(), false) << "\n";
+        }
+    }
+}
+
+static void counters_json(std::ostringstream& res, const counter_values& counters) {
+    if (counters.values.empty()) {
+        res << "null";
+        return;
+    }
+    res << "{";
+    for (auto& value : counters.values) {
+        res << "\"" << value.first << "\": " << value.second << ", ";
+    }
+    // rates are -1 when the counters they need are missing
+    res << "\"ipc\": " << counters.ipc() << ", \"cache_miss_rate\": " << counters.cache_miss_rate()
+        << ", \"branch_miss_rate\": " << counters.branch_miss_rate() << "}";
+}
+
+static std::string to_json(const std::vector<benchmark_result>& results, const std::string& counter_error) {
+    std::ostringstream res;
+    res << std::fixed << std::setprecision(3);
+    res << "{\n  \"counters_error\": \"" << json_escape(counter_error) << "\",\n";
+    res << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto& bench = results[i];
+        res << (i ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(bench.name) << "\", \"variants\": [";
+        for (size_t j = 0; j < bench.variants.size(); ++j) {
+            auto& variant = bench.variants[j];
+            res << (j ? ",\n" : "\n") << "      {\"variant\": \"" << variant.variant << "\", ";
+            res << "\"ok\": " << (variant.error == "" ? "true" : "false") << ", ";
+            res << "\"skipped\": " << (variant.skipped ? "true" : "false") << ", ";
+            res << "\"error\": \"" << json_escape(variant.error) << "\", ";
+            res << "\"compile_ms\": " << variant.compile_ms << ", \"compile_counters\": ";
+            counters_json(res, variant.compile_counters);
+            res << ", \"runs\": [";
+            for (size_t k = 0; k < variant.runs.size(); ++k) {
+                auto& run = variant.runs[k];
+                res << (k ? ", " : "") << "{\"wall_ms\": " << run.wall_ms << ", \"user_ms\": " << run.user_ms
+                    << ", \"sys_ms\": " << run.sys_ms << ", \"max_rss_kb\": " << run.max_rss_kb << ", \"counters\": ";
+                counters_json(res, run.counters);
+                res << "}";
+            }
+            res << "]}";
+        }
+        res << "\n    ]}";
+    }
+    res << "\n  ]\n}\n";
+    return res.str();
+}
+
+static void usage() {
+    std::cout << "Usage: benchmark_harness [options]\n"
+                 "\t--peregrine <path> - the compiler to benchmark\n"
+                 "\t--programs <dir>   - directory with the benchmark programs\n"
+                 "\t--work <dir>       - where the programs are built\n"
+                 "\t--json <file>      - also write the results as json\n"
+                 "\t--cxx <compiler>   - c++ compiler for the references and the peregrine backend\n"
+                 "\t--node <path>      - javascript runtime for the js backend\n"
+                 "\t--repeat <n>       - runs per program, the fastest one is reported\n"
+                 "\t--filter <name>    - only run benchmarks whose name contains name\n"
+                 "\t--counters         - record cycles, instructions, cache and branch misses (linux only)\n";
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        if (arg == "--counters") {
+            opts.counters = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cout << "Missing value for " << arg << "\n";
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--peregrine") {
+            opts.peregrine = fs::absolute(value).string();
+        } else if (arg == "--programs") {
+            opts.programs = value;
+        } else if (arg == "--work") {
+            opts.work = value;
+        } else if (arg == "--json") {
+            opts.json = value;
+        } else if (arg == "--cxx") {
+            opts.cxx = value;
+        } else if (arg == "--node") {
+            opts.node = value;
+        } else if (arg == "--repeat") {
+            opts.repeat = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--filter") {
+            opts.filter = value;
+        } else {
+            std::cout << "Invalid argument: " << arg << "\n";
+            usage();
+            return 1;
+        }
+    }
+    std::vector<fs::path> sources;
+    for (auto& entry : fs::directory_iterator(opts.programs)) {
+        std::string name = entry.path().filename().string();
+        if (entry.path().extension() == ".pe" && name.find(".js.pe") == std::string::npos &&
+            name.find(opts.filter) != std::string::npos) {
+            sources.push_back(entry.path());
+        }
+    }
+    std::sort(sources.begin(), sources.end());
+    std::vector<benchmark_result> results;
+    bool failed = false;
+    for (auto& source : sources) {
+        std::cerr << "running " << source.stem().string() << "\n";
+        results.push_back(run_benchmark(source, opts));
+        for (auto& variant : results.back().variants) {
+            failed |= variant.error != "" && !variant.skipped;
+        }
+    }
+    print(results);
+    std::string counter_error;
+    for (auto& bench : results) {
+        for (auto& variant : bench.variants) {
+            if (counter_error == "") {
+                counter_error = variant.counter_error;
+            }
+        }
+    }
+    if (opts.counters) {
+        if (counter_error != "") {
+            // still worth reporting the rest, the json says why the counters are missing
+            std::cout << "\nsome hardware counters are unavailable (" << counter_error
+                      << "), check kernel.perf_event_paranoid\n";
+        }
+        print_counters(results);
+    }
+    if (opts.json != "") {
+        std::ofstream json(opts.json);
+        json << to_json(results, counter_error);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+#ifndef PEREGRINE_BENCHMARK_PERF_COUNTERS_HPP
+#define PEREGRINE_BENCHMARK_PERF_COUNTERS_HPP
+// Hardware performance counters of a child process through perf_event_open.
+// Counters that the kernel or the cpu dont provide are simply missing from
+// the result, so the harness keeps working inside containers and vms.
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct counter_values {
+    std::vector<std::pair<std::string, uint64_t>> values; // only the counters that could be read
+
+    bool has(const std::string& name) const {
+        for (auto& value : values) {
+            if (value.first == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+    uint64_t get(const std::string& name) const {
+        for (auto& value : values) {
+            if (value.first == name) {
+                return value.second;
+            }
+        }
+        return 0;
+    }
+    // a/b if both counters exist, -1 otherwise
+    double ratio(const std::string& a, const std::string& b) const {
+        if (!has(a) || !has(b) || get(b) == 0) {
+            return -1;
+        }
+        return double(get(a)) / get(b);
+    }
+    double ipc() const { return ratio("instructions", "cycles"); }
+    double cache_miss_rate() const { return ratio("cache_misses", "cache_references"); }
+    double branch_miss_rate() const { return ratio("branch_misses", "branches"); }
+};
+
+class perf_counters {
+    struct counter {
+        std::string name;
+        int fd;
+    };
+    std::vector<counter> m_counters;
+    std::string m_error;
+
+  public:
+    perf_counters() = default;
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+    ~perf_counters() { close_all(); }
+
+    // starts counting pid (and the processes it creates) once it calls exec.
+    // returns false if none of the counters is available, see error()
+    bool open(pid_t pid) {
+#ifdef __linux__
+        static const std::pair<const char*, uint64_t> events[] = {
+            {"cycles", PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+            {"cache_references", PERF_COUNT_HW_CACHE_REFERENCES},
+            {"cache_misses", PERF_COUNT_HW_CACHE_MISSES},
+            {"branches", PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+            {"branch_misses", PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        for (auto& event : events) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = event.second;
+            attr.disabled = 1;
+            attr.enable_on_exec = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // the counters are multiplexed if the cpu has less of them than we ask for
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+            if (fd < 0) {
+                if (m_error == "") {
+                    m_error = std::string(event.first) + ": " + strerror(errno);
+                }
+                continue;
+            }
+            m_counters.push_back({event.first, fd});
+        }
+        if (m_counters.empty() && m_error == "") {
+            m_error = "no counters";
+        }
+        return !m_counters.empty();
+#else
+        (void)pid;
+        m_error = "perf_event_open is only available on linux";
+        return false;
+#endif
+    }
+
+    // call after the process exited so that the counts of its children are included
+    counter_values read() const {
+        counter_values res;
+#ifdef __linux__
+        for (auto& counter : m_counters) {
+            uint64_t data[3]; // value, time enabled, time running
+            if (::read(counter.fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                continue;
+            }
+            uint64_t value = data[0];
+            if (data[2] < data[1]) {
+                value = uint64_t(double(value) * data[1] / data[2]);
+            }
+            res.values.push_back({counter.name, value});
+        }
+#endif
+        return res;
+    }
+
+    std::string error() const { return m_error; }
+
+    void close_all() {
+#ifdef __linux__
+        for (auto& counter : m_counters) {
+            close(counter.fd);
+        }
+#endif
+        m_counters.clear();
+    }
+};
+#endif
@@ -0,0 +1,53 @@
+// reference implementation of binary_trees.pe
+#include <cstdio>
+
+struct Node {
+    Node* left = nullptr;
+    Node* right = nullptr;
+};
+
+static Node* bottom_up(int depth) {
+    Node* node = new Node;
+    if (depth > 0) {
+        node->left = bottom_up(depth - 1);
+        node->right = bottom_up(depth - 1);
+    }
+    return node;
+}
+
+static long check(const Node* node) {
+    if (node->left == nullptr) {
+        return 1;
+    }
+    return 1 + check(node->left) + check(node->right);
+}
+
+static void destroy(Node* node) {
+    if (node->left != nullptr) {
+        destroy(node->left);
+        destroy(node->right);
+    }
+    delete node;
+}
+
+int main() {
+    const int min_depth = 4;
+    const int max_depth = 16;
+    Node* stretch = bottom_up(max_depth + 1);
+    printf("stretch tree of depth %d\t check: %ld\n", max_depth + 1, check(stretch));
+    destroy(stretch);
+    Node* long_lived = bottom_up(max_depth);
+    for (int depth = min_depth; depth <= max_depth; depth += 2) {
+        long iterations = 1L << (max_depth - depth + min_depth);
+        long total = 0;
+        for (long i = 0; i < iterations; ++i) {
+            Node* tree = bottom_up(depth);
+            total += check(tree);
+            destroy(tree);
+        }
+        printf("%ld\t trees of depth %d\t check: %ld\n", iterations, depth, total);
+    }
+    printf("long lived tree of depth %d\t check: %ld\n", max_depth, check(long_lived));
+    destroy(long_lived);
+    return 0;
+}
@@ -0,0 +1,53 @@
+// reference implementation of fannkuch.pe
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+static void fannkuch(int n) {
+    std::vector<int> perm(n), perm1(n), count(n);
+    for (int i = 0; i < n; ++i) {
+        perm1[i] = i;
+    }
+    int max_flips = 0;
+    long checksum = 0;
+    long perm_count = 0;
+    int r = n;
+    while (true) {
+        for (; r != 1; --r) {
+            count[r - 1] = r;
+        }
+        perm = perm1;
+        int flips = 0;
+        for (int k = perm[0]; k != 0; k = perm[0]) {
+            for (int lo = 0, hi = k; lo < hi; ++lo, --hi) {
+                std::swap(perm[lo], perm[hi]);
+            }
+            flips++;
+        }
+        if (flips > max_flips) {
+            max_flips = flips;
+        }
+        checksum += perm_count % 2 == 0 ? flips : -flips;
+        while (true) {
+            if (r == n) {
+                printf("%ld\nPfannkuchen(%d) = %d\n", checksum, n, max_flips);
+                return;
+            }
+            int perm0 = perm1[0];
+            for (int i = 0; i < r; ++i) {
+                perm1[i] = perm1[i + 1];
+            }
+            perm1[r] = perm0;
+            if (--count[r] > 0) {
+                break;
+            }
+            r++;
+        }
+        perm_count++;
+    }
+}
+
+int main() {
+    fannkuch(10);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// reference implementation of knucleotide.pe
+#include <cstdio>
+#include <vector>
+
+static long table_find(const std::vector<long>& keys, long key) {
+    long size = keys.size();
+    long slot = key % size;
+    while (keys[slot] != -1 && keys[slot] != key) {
+        slot = slot + 1 == size ? 0 : slot + 1;
+    }
+    return slot;
+}
+
+static void count_kmers(const std::vector<long>& seq, int k, std::vector<long>& keys, std::vector<long>& counts) {
+    std::fill(keys.begin(), keys.end(), -1);
+    std::fill(counts.begin(), counts.end(), 0);
+    long modulo = 1;
+    for (int i = 0; i < k; ++i) {
+        modulo *= 4;
+    }
+    long code = 0;
+    for (long i = 0; i < (long)seq.size(); ++i) {
+        code = (code * 4 + seq[i]) % modulo;
+        if (i >= k - 1) {
+            long slot = table_find(keys, code);
+            keys[slot] = code;
+            counts[slot]++;
+        }
+    }
+}
+
+static long lookup(const std::vector<long>& keys, const std::vector<long>& counts, long key) {
+    long slot = table_find(keys, key);
+    return keys[slot] == -1 ? 0 : counts[slot];
+}
+
+int main() {
+    const long n = 1000000;
+    const long size = 2097152;
+    std::vector<long> seq(n);
+    long seed = 42;
+    for (long i = 0; i < n; ++i) {
+        seed = (seed * 3877 + 29573) % 139968;
+        seq[i] = seed < 42404 ? 0 : seed < 70116 ? 1 : seed < 97766 ? 2 : 3;
+    }
+    std::vector<long> keys(size), counts(size);
+    for (int k = 1; k <= 2; ++k) {
+        count_kmers(seq, k, keys, counts);
+        long kmers = k == 2 ? 16 : 4;
+        for (long code = 0; code < kmers; ++code) {
+            printf("k=%d code=%ld count=%ld\n", k, code, lookup(keys, counts, code));
+        }
+    }
+    // GGTATTTTAATTTATAGT, the shorter fragments are its prefixes
+    const int fragment[18] = {2, 2, 3, 0, 3, 3, 3, 3, 0, 0, 3, 3, 3, 0, 3, 0, 2, 3};
+    for (int k : {3, 4, 6, 12, 18}) {
+        count_kmers(seq, k, keys, counts);
+        long code = 0;
+        for (int i = 0; i < k; ++i) {
+            code = code * 4 + fragment[i];
+        }
+        printf("k=%d fragment=%ld count=%ld\n", k, code, lookup(keys, counts, code));
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+// reference implementation of mandelbrot.pe
+#include <cstdio>
+
+int main() {
+    const long size = 1600;
+    long count = 0;
+    for (long y = 0; y < size; ++y) {
+        double ci = 2.0 * y / size - 1.0;
+        for (long x = 0; x < size; ++x) {
+            double cr = 2.0 * x / size - 1.5;
+            double zr = 0.0, zi = 0.0;
+            bool escaped = false;
+            for (int i = 0; i < 50; ++i) {
+                double tr = zr * zr - zi * zi + cr;
+                zi = 2.0 * zr * zi + ci;
+                zr = tr;
+                if (zr * zr + zi * zi > 4.0) {
+                    escaped = true;
+                    break;
+                }
+            }
+            if (!escaped) {
+                count++;
+            }
+        }
+    }
+    printf("%ld points of %ld are in the set\n", count, size * size);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// reference implementation of nbody.pe
+#include <cmath>
+#include <cstdio>
+
+struct Body {
+    double x, y, z, vx, vy, vz, mass;
+};
+
+static const double pi = 3.141592653589793;
+static const double solar_mass = 4.0 * pi * pi;
+static const double days = 365.24;
+
+static double energy(const Body* bodies, int n) {
+    double e = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const Body& a = bodies[i];
+        e += 0.5 * a.mass * (a.vx * a.vx + a.vy * a.vy + a.vz * a.vz);
+        for (int j = i + 1; j < n; ++j) {
+            const Body& b = bodies[j];
+            double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+            e -= a.mass * b.mass / std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+    return e;
+}
+
+static void advance(Body* bodies, int n, double dt) {
+    for (int i = 0; i < n; ++i) {
+        Body& a = bodies[i];
+        for (int j = i + 1; j < n; ++j) {
+            Body& b = bodies[j];
+            double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+            double d2 = dx * dx + dy * dy + dz * dz;
+            double mag = dt / (d2 * std::sqrt(d2));
+            a.vx -= dx * b.mass * mag;
+            a.vy -= dy * b.mass * mag;
+            a.vz -= dz * b.mass * mag;
+            b.vx += dx * a.mass * mag;
+            b.vy += dy * a.mass * mag;
+            b.vz += dz * a.mass * mag;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        bodies[i].x += dt * bodies[i].vx;
+        bodies[i].y += dt * bodies[i].vy;
+        bodies[i].z += dt * bodies[i].vz;
+    }
+}
+
+int main() {
+    Body bodies[5] = {
+        {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, solar_mass},
+        {4.84143144246472090, -1.16032004402742839, -0.103622044471123109,
+         0.00166007664274403694 * days, 0.00769901118419740425 * days, -0.0000690460016972063023 * days,
+         0.000954791938424326609 * solar_mass},
+        {8.34336671824457987, 4.12479856412430479, -0.403523417114321381,
+         -0.00276742510726862411 * days, 0.00499852801234917238 * days, 0.0000230417297573763929 * days,
+         0.000285885980666130812 * solar_mass},
+        {12.8943695621391310, -15.1111514016986312, -0.223307578892655734,
+         0.00296460137564761618 * days, 0.00237847173959480950 * days, -0.0000296589568540237556 * days,
+         0.0000436624404335156298 * solar_mass},
+        {15.3796971148509165, -25.9193146099879641, 0.179258772950371181,
+         0.00268067772490389322 * days, 0.00162824170038242295 * days, -0.0000951592254519715870 * days,
+         0.0000515138902046611451 * solar_mass},
+    };
+    const int n = 5;
+    double px = 0.0, py = 0.0, pz = 0.0;
+    for (int i = 0; i < n; ++i) {
+        px += bodies[i].vx * bodies[i].mass;
+        py += bodies[i].vy * bodies[i].mass;
+        pz += bodies[i].vz * bodies[i].mass;
+    }
+    bodies[0].vx = -px / solar_mass;
+    bodies[0].vy = -py / solar_mass;
+    bodies[0].vz = -pz / solar_mass;
+    printf("%ld\n", (long)(-energy(bodies, n) * 1000000000.0));
+    for (int i = 0; i < 5000000; ++i) {
+        advance(bodies, n, 0.01);
+    }
+    printf("%ld\n", (long)(-energy(bodies, n) * 1000000000.0));
+    return 0;
+}
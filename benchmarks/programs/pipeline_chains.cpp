@@ -0,0 +1,52 @@
+// reference implementation of pipeline_chains.pe
+#include <cstdio>
+#include <vector>
+
+static long scale(long x) { return x * 3 + 1; }
+static bool keep(long x) { return x % 5 != 0; }
+static long shrink(long x) { return x % 1000; }
+
+int main() {
+    const long n = 10000000;
+    std::vector<long> data(n);
+    long seed = 42;
+    for (long i = 0; i < n; ++i) {
+        seed = (seed * 1103515245 + 12345) % 2147483648;
+        data[i] = seed % 100000;
+    }
+    long total = 0;
+    for (long round = 0; round < 10; ++round) {
+        long acc = round;
+        long index = 0;
+        for (long x : data) {
+            long y = scale(x);
+            if (!keep(y)) {
+                continue;
+            }
+            acc = (acc + (index++ % 7) * shrink(y)) % 1000000007;
+        }
+        total = (total + acc) % 1000000007;
+
+        acc = 0;
+        long taken = 0;
+        for (long x : data) {
+            if (!keep(x)) {
+                continue;
+            }
+            if (taken >= n / 2) {
+                break;
+            }
+            acc = (acc + x * taken++) % 1000000007;
+        }
+        total = (total + acc) % 1000000007;
+
+        long count = 0;
+        for (long x : data) {
+            if (keep(shrink(x))) {
+                ++count;
+            }
+        }
+        total += count;
+    }
+    printf("%ld\n", total);
+}
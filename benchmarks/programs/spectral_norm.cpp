@@ -0,0 +1,40 @@
+// reference implementation of spectral_norm.pe
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static double eval_a(long i, long j) {
+    return 1.0 / double((i + j) * (i + j + 1) / 2 + i + 1);
+}
+
+static void times(std::vector<double>& v, const std::vector<double>& u, bool transposed) {
+    const long n = u.size();
+    for (long i = 0; i < n; ++i) {
+        double sum = 0.0;
+        for (long j = 0; j < n; ++j) {
+            sum += (transposed ? eval_a(j, i) : eval_a(i, j)) * u[j];
+        }
+        v[i] = sum;
+    }
+}
+
+static void times_ata(std::vector<double>& v, const std::vector<double>& u, std::vector<double>& tmp) {
+    times(tmp, u, false);
+    times(v, tmp, true);
+}
+
+int main() {
+    const long n = 2000;
+    std::vector<double> u(n, 1.0), v(n), tmp(n);
+    for (int i = 0; i < 10; ++i) {
+        times_ata(v, u, tmp);
+        times_ata(u, v, tmp);
+    }
+    double vbv = 0.0, vv = 0.0;
+    for (long i = 0; i < n; ++i) {
+        vbv += u[i] * v[i];
+        vv += v[i] * v[i];
+    }
+    printf("%ld\n", (long)(std::sqrt(vbv / vv) * 1000000000.0));
+    return 0;
+}
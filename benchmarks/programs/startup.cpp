@@ -0,0 +1,44 @@
+// reference implementation of startup.pe, the tables are function statics so
+// only the one that is used is built
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+
+static int64_t table(int64_t seed) {
+    int64_t acc = seed;
+    for (int64_t i = 0; i < 1000000; ++i) {
+        acc = (acc * 6364136223846793005 + 1442695040888963407) % 1000000007;
+    }
+    return acc;
+}
+
+constexpr int64_t version = 3;
+constexpr int64_t flags = version << 8 | 1;
+static int64_t max_args = flags * 4;
+
+#define TABLE(name, seed)             \
+    static int64_t& name() {          \
+        static int64_t value = table(seed); \
+        return value;                 \
+    }
+TABLE(scores, 1)
+TABLE(ranks, 2)
+TABLE(weights, 3)
+TABLE(offsets, 4)
+TABLE(colours, 5)
+TABLE(widths, 6)
+TABLE(heights, 7)
+TABLE(depths, 8)
+TABLE(layers, 9)
+TABLE(masks, 10)
+TABLE(shifts, 11)
+TABLE(names, 12)
+
+int main() {
+    if (isatty(1) != 0) {
+        std::printf("%lld\n", (long long)(scores() + ranks() + offsets() + colours() + widths() + heights() +
+                                           depths() + layers() + masks() + shifts() + names()));
+    }
+    std::printf("%lld %lld\n", (long long)max_args, (long long)weights());
+    return 0;
+}
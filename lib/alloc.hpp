@@ -0,0 +1,126 @@
+#ifndef __PEREGRINE__ALLOC__
+#define __PEREGRINE__ALLOC__
+//Every heap allocation made by the runtime containers goes through here:
+//soa_list, the tables of @cache and the buffers of channels (and list and str
+//of lib/, which generated code does not use yet). Compiling with
+//PEREGRINE_PROFILE_ALLOC (peregrine -profile-alloc) records the traffic per
+//allocation site and prints a table when the program exits. The unused
+//capacity of a block is only known once it is freed, the blocks that are
+//still allocated at exit are counted as live bytes instead.
+#include <cstddef>
+#include <cstdint>
+#ifdef PEREGRINE_PROFILE_ALLOC
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#ifndef PEREGRINE_PROFILE_ALLOC_FILE
+#define PEREGRINE_PROFILE_ALLOC_FILE "<unknown>"
+#endif
+#endif
+namespace Peregrine{
+#ifdef PEREGRINE_PROFILE_ALLOC
+//site id of the statement being executed, the codegen sets it to the
+//peregrine source line before every statement. 0 means global scope
+inline thread_local uint32_t alloc_site=0;
+
+struct alloc_stats{
+    uint64_t count=0;
+    uint64_t bytes=0;
+    uint64_t growths=0;
+    uint64_t wasted=0;
+    uint64_t live=0;//bytes of the blocks that are not freed yet
+};
+
+class alloc_profiler{
+    std::mutex m_lock;
+    std::unordered_map<uint32_t,alloc_stats> m_sites;
+    //which site allocated a block and its size
+    std::unordered_map<const void*,std::pair<uint32_t,size_t>> m_owner;
+    public:
+    void record(const void* ptr,size_t bytes,bool growth){
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto& stats=m_sites[alloc_site];
+        stats.count++;
+        stats.bytes+=bytes;
+        stats.live+=bytes;
+        if(growth){
+            stats.growths++;
+        }
+        m_owner[ptr]={alloc_site,bytes};
+    }
+    void release(const void* ptr,size_t unused_bytes){
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto owner=m_owner.find(ptr);
+        if(owner==m_owner.end()){
+            return;
+        }
+        auto& stats=m_sites[owner->second.first];
+        stats.wasted+=unused_bytes;
+        stats.live-=owner->second.second;
+        m_owner.erase(owner);
+    }
+    alloc_stats stats(uint32_t site){
+        std::lock_guard<std::mutex> guard(m_lock);
+        return m_sites.count(site)?m_sites[site]:alloc_stats{};
+    }
+    //the sites that allocated the most bytes first
+    void report(FILE* out){
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::vector<std::pair<uint32_t,alloc_stats>> sites(m_sites.begin(),m_sites.end());
+        std::sort(sites.begin(),sites.end(),[](auto& a,auto& b){
+            return a.second.bytes>b.second.bytes;
+        });
+        fprintf(out,"\nPeregrine allocation profile (%s)\n",PEREGRINE_PROFILE_ALLOC_FILE);
+        fprintf(out,"wasted bytes are the unused capacity of freed blocks, live bytes are still allocated\n");
+        fprintf(out,"%-12s %12s %14s %10s %14s %14s\n","line","allocs","bytes","growths","wasted bytes","live bytes");
+        for(auto& site:sites){
+            if(site.first==0){
+                fprintf(out,"%-12s","<global>");
+            }
+            else{
+                fprintf(out,"%-12u",site.first);
+            }
+            fprintf(out," %12llu %14llu %10llu %14llu %14llu\n",
+                    (unsigned long long)site.second.count,
+                    (unsigned long long)site.second.bytes,
+                    (unsigned long long)site.second.growths,
+                    (unsigned long long)site.second.wasted,
+                    (unsigned long long)site.second.live);
+        }
+    }
+    ~alloc_profiler(){
+        report(stderr);
+    }
+};
+
+inline alloc_profiler& profiler(){
+    static alloc_profiler instance;
+    return instance;
+}
+#endif
+
+//growth is true when the block replaces a smaller one of the same container
+template<typename T>
+inline T* allocate(size_t count,[[maybe_unused]] bool growth=false){
+    T* data=new T[count];
+#ifdef PEREGRINE_PROFILE_ALLOC
+    profiler().record(data,count*sizeof(T),growth);
+#endif
+    return data;
+}
+
+//capacity-size is the part of the block that was never used
+template<typename T>
+inline void deallocate(T* data,[[maybe_unused]] size_t capacity,[[maybe_unused]] size_t size){
+    if(data==nullptr){
+        return;
+    }
+#ifdef PEREGRINE_PROFILE_ALLOC
+    profiler().release(data,capacity>size?(capacity-size)*sizeof(T):0);
+#endif
+    delete[] data;
+}
+}
+#endif
@@ -0,0 +1,510 @@
+#ifndef __PEREGRINE__ASYNC__
+#define __PEREGRINE__ASYNC__
+//Runtime of async functions. They are compiled to c++20 coroutines that
+//return a task, awaiting a task starts it and resumes the awaiting coroutine
+//once it is done. A single threaded event loop per thread resumes the
+//coroutines that wait for a timer or for a file descriptor with epoll.
+//
+//The functions that peregrine code calls directly take a trailing pointer
+//that receives the exception handlers every peregrine call passes.
+#include <coroutine>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace Peregrine{
+class event_loop{
+    struct timer{
+        int64_t deadline;//nanoseconds on the steady clock
+        uint64_t order;//timers with the same deadline fire in the order they were added
+        std::coroutine_handle<> handle;
+        bool operator>(const timer& other) const{
+            return deadline>other.deadline||(deadline==other.deadline && order>other.order);
+        }
+    };
+    struct waiters{
+        std::coroutine_handle<> reader;
+        std::coroutine_handle<> writer;
+    };
+    int m_epoll;
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::priority_queue<timer,std::vector<timer>,std::greater<timer>> m_timers;
+    uint64_t m_timer_count=0;
+    std::unordered_map<int,waiters> m_waiters;
+    size_t m_waiting=0;//coroutines blocked on a file descriptor
+
+    static int64_t now(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    void update(int fd,bool registered){
+        auto& w=m_waiters[fd];
+        epoll_event ev;
+        memset(&ev,0,sizeof(ev));
+        ev.data.fd=fd;
+        ev.events=(w.reader?EPOLLIN:0)|(w.writer?EPOLLOUT:0);
+        if(ev.events==0){
+            epoll_ctl(m_epoll,EPOLL_CTL_DEL,fd,nullptr);
+            m_waiters.erase(fd);
+        }
+        else if(registered){
+            epoll_ctl(m_epoll,EPOLL_CTL_MOD,fd,&ev);
+        }
+        else if(epoll_ctl(m_epoll,EPOLL_CTL_ADD,fd,&ev)<0){
+            //regular files can't be polled, they are always ready
+            if(w.reader){
+                schedule(w.reader);
+            }
+            if(w.writer){
+                schedule(w.writer);
+            }
+            m_waiting-=(w.reader?1:0)+(w.writer?1:0);
+            m_waiters.erase(fd);
+        }
+    }
+
+  public:
+    event_loop(){
+        m_epoll=epoll_create1(EPOLL_CLOEXEC);
+        if(m_epoll<0){
+            perror("epoll_create1");
+            exit(1);
+        }
+    }
+    event_loop(const event_loop&)=delete;
+    event_loop& operator=(const event_loop&)=delete;
+    ~event_loop(){
+        ::close(m_epoll);
+    }
+    static event_loop& current(){
+        static thread_local event_loop loop;
+        return loop;
+    }
+
+    void schedule(std::coroutine_handle<> handle){
+        m_ready.push_back(handle);
+    }
+    void add_timer(int64_t ms,std::coroutine_handle<> handle){
+        m_timers.push({now()+ms*1000000,m_timer_count++,handle});
+    }
+    //resumes handle once fd can be read (or written), one coroutine per direction
+    void wait_fd(int fd,bool write,std::coroutine_handle<> handle){
+        bool registered=m_waiters.count(fd)>0;
+        auto& w=m_waiters[fd];
+        auto& slot=write?w.writer:w.reader;
+        if(slot){
+            fprintf(stderr,"Error: two coroutines are waiting to %s file descriptor %d\n",write?"write to":"read from",fd);
+            exit(1);
+        }
+        slot=handle;
+        m_waiting++;
+        update(fd,registered);
+    }
+    //drops the interest in fd before it is closed
+    void forget(int fd){
+        auto it=m_waiters.find(fd);
+        if(it==m_waiters.end()){
+            return;
+        }
+        //the waiting coroutines see the error of the closed descriptor
+        if(it->second.reader){
+            schedule(it->second.reader);
+            m_waiting--;
+        }
+        if(it->second.writer){
+            schedule(it->second.writer);
+            m_waiting--;
+        }
+        epoll_ctl(m_epoll,EPOLL_CTL_DEL,fd,nullptr);
+        m_waiters.erase(it);
+    }
+
+    //resumes everything that is ready and waits for the next timer or io.
+    //returns false if there is nothing left that could make progress
+    bool run_once(){
+        while(!m_ready.empty()){
+            auto handle=m_ready.front();
+            m_ready.pop_front();
+            handle.resume();
+        }
+        if(m_timers.empty() && m_waiting==0){
+            return false;
+        }
+        int timeout=-1;
+        if(!m_timers.empty()){
+            int64_t wait=m_timers.top().deadline-now();
+            timeout=wait<=0?0:int((wait+999999)/1000000);
+        }
+        epoll_event events[64];
+        int n=epoll_wait(m_epoll,events,64,timeout);
+        for(int i=0;i<n;++i){
+            int fd=events[i].data.fd;
+            auto it=m_waiters.find(fd);
+            if(it==m_waiters.end()){
+                continue;
+            }
+            auto& w=it->second;
+            //errors and hang ups wake both directions so that the next read or write reports them
+            bool failed=events[i].events&(EPOLLERR|EPOLLHUP);
+            if(w.reader && (events[i].events&EPOLLIN||failed)){
+                schedule(w.reader);
+                w.reader=nullptr;
+                m_waiting--;
+            }
+            if(w.writer && (events[i].events&EPOLLOUT||failed)){
+                schedule(w.writer);
+                w.writer=nullptr;
+                m_waiting--;
+            }
+            update(fd,true);
+        }
+        int64_t time=now();
+        while(!m_timers.empty() && m_timers.top().deadline<=time){
+            schedule(m_timers.top().handle);
+            m_timers.pop();
+        }
+        return true;
+    }
+};
+
+template<typename T>
+class task;
+
+namespace detail{
+struct promise_base{
+    std::coroutine_handle<> continuation;
+    bool detached=false;//started with spawn, nobody awaits it
+
+    struct final_awaiter{
+        bool await_ready() noexcept{
+            return false;
+        }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept{
+            auto& promise=handle.promise();
+            if(promise.continuation){
+                return promise.continuation;
+            }
+            if(promise.detached){
+                handle.destroy();
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() noexcept{}
+    };
+    std::suspend_always initial_suspend() noexcept{
+        return {};
+    }
+    final_awaiter final_suspend() noexcept{
+        return {};
+    }
+    void unhandled_exception(){
+        std::terminate();
+    }
+};
+
+template<typename T>
+struct promise:promise_base{
+    std::optional<T> value;
+    task<T> get_return_object() noexcept;
+    void return_value(T v){
+        value=std::move(v);
+    }
+    T result(){
+        return std::move(*value);
+    }
+};
+
+template<>
+struct promise<void>:promise_base{
+    task<void> get_return_object() noexcept;
+    void return_void(){}
+    void result(){}
+};
+}
+
+//lazily started coroutine, it runs once it is awaited, spawned or run
+template<typename T>
+class task{
+  public:
+    using promise_type=detail::promise<T>;
+
+    explicit task(std::coroutine_handle<promise_type> handle):m_handle(handle){}
+    task(task&& other) noexcept:m_handle(std::exchange(other.m_handle,nullptr)){}
+    task& operator=(task&& other) noexcept{
+        if(this!=&other){
+            reset();
+            m_handle=std::exchange(other.m_handle,nullptr);
+        }
+        return *this;
+    }
+    task(const task&)=delete;
+    task& operator=(const task&)=delete;
+    ~task(){
+        reset();
+    }
+
+    bool done() const{
+        return !m_handle||m_handle.done();
+    }
+    std::coroutine_handle<promise_type> release(){
+        return std::exchange(m_handle,nullptr);
+    }
+    std::coroutine_handle<promise_type> handle() const{
+        return m_handle;
+    }
+
+    auto operator co_await() && noexcept{
+        struct awaiter{
+            std::coroutine_handle<promise_type> handle;
+            bool await_ready() noexcept{
+                return false;
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+                handle.promise().continuation=awaiting;
+                return handle;
+            }
+            T await_resume(){
+                return handle.promise().result();
+            }
+        };
+        return awaiter{m_handle};
+    }
+
+  private:
+    std::coroutine_handle<promise_type> m_handle;
+    void reset(){
+        if(m_handle){
+            m_handle.destroy();
+            m_handle=nullptr;
+        }
+    }
+};
+
+namespace detail{
+template<typename T>
+task<T> promise<T>::get_return_object() noexcept{
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+inline task<void> promise<void>::get_return_object() noexcept{
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+struct timer_awaiter{
+    int64_t ms;
+    bool await_ready() noexcept{
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle){
+        event_loop::current().add_timer(ms<0?0:ms,handle);
+    }
+    void await_resume() noexcept{}
+};
+
+struct fd_awaiter{
+    int fd;
+    bool write;
+    bool await_ready() noexcept{
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle){
+        event_loop::current().wait_fd(fd,write,handle);
+    }
+    void await_resume() noexcept{}
+};
+
+inline bool set_nonblocking(int fd){
+    int flags=fcntl(fd,F_GETFL,0);
+    return flags>=0 && (flags&O_NONBLOCK || fcntl(fd,F_SETFL,flags|O_NONBLOCK)==0);
+}
+
+inline bool would_block(){
+    return errno==EAGAIN||errno==EWOULDBLOCK;
+}
+}
+
+//starts a task next to the current one, it runs until it is done even if
+//nobody waits for it
+template<typename T>
+void spawn(task<T> t,void* =nullptr){
+    auto handle=t.release();
+    handle.promise().detached=true;
+    event_loop::current().schedule(handle);
+}
+
+//runs the event loop of this thread until t is done
+template<typename T>
+T run(task<T> t,void* =nullptr){
+    auto& loop=event_loop::current();
+    loop.schedule(t.handle());
+    while(!t.done()){
+        if(!loop.run_once() && !t.done()){
+            fprintf(stderr,"Error: the async function is waiting for something that will never happen\n");
+            exit(1);
+        }
+    }
+    return t.handle().promise().result();
+}
+
+inline task<void> sleep(int64_t ms,void* =nullptr){
+    co_await detail::timer_awaiter{ms};
+}
+
+//waits for the next turn of the event loop so that other tasks can run
+inline task<void> yield_now(void* =nullptr){
+    co_await detail::timer_awaiter{0};
+}
+
+//reads up to n bytes, returns how many were read, 0 at the end of the input
+//and -1 on errors
+inline task<int64_t> read(int64_t fd,void* buf,int64_t n,void* =nullptr){
+    detail::set_nonblocking(fd);
+    while(true){
+        ssize_t res=::read(fd,buf,n);
+        if(res>=0){
+            co_return res;
+        }
+        if(errno==EINTR){
+            continue;
+        }
+        if(!detail::would_block()){
+            co_return -1;
+        }
+        co_await detail::fd_awaiter{int(fd),false};
+    }
+}
+
+//writes all n bytes, returns n or -1 on errors
+inline task<int64_t> write(int64_t fd,const void* buf,int64_t n,void* =nullptr){
+    detail::set_nonblocking(fd);
+    int64_t done=0;
+    while(done<n){
+        ssize_t res=::write(fd,(const char*)buf+done,n-done);
+        if(res>=0){
+            done+=res;
+            continue;
+        }
+        if(errno==EINTR){
+            continue;
+        }
+        if(!detail::would_block()){
+            co_return -1;
+        }
+        co_await detail::fd_awaiter{int(fd),true};
+    }
+    co_return n;
+}
+
+inline int64_t close(int64_t fd,void* =nullptr){
+    event_loop::current().forget(fd);
+    return ::close(fd);
+}
+
+//creates a non blocking pipe, returns -1 on errors
+inline int64_t pipe(int64_t* read_end,int64_t* write_end,void* =nullptr){
+    int fds[2];
+    if(::pipe2(fds,O_NONBLOCK|O_CLOEXEC)<0){
+        return -1;
+    }
+    *read_end=fds[0];
+    *write_end=fds[1];
+    return 0;
+}
+
+//non blocking tcp socket listening on an ipv4 address, port 0 picks a free port
+inline int64_t listen(const char* host,int64_t port,void* =nullptr){
+    int fd=socket(AF_INET,SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC,0);
+    if(fd<0){
+        return -1;
+    }
+    int yes=1;
+    setsockopt(fd,SOL_SOCKET,SO_REUSEADDR,&yes,sizeof(yes));
+    sockaddr_in addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family=AF_INET;
+    addr.sin_port=htons(uint16_t(port));
+    if(inet_pton(AF_INET,host,&addr.sin_addr)!=1||
+        bind(fd,(sockaddr*)&addr,sizeof(addr))<0||::listen(fd,SOMAXCONN)<0){
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//port that a socket is bound to
+inline int64_t local_port(int64_t fd,void* =nullptr){
+    sockaddr_in addr;
+    socklen_t len=sizeof(addr);
+    if(getsockname(fd,(sockaddr*)&addr,&len)<0){
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+//waits for a connection on a listening socket, returns the connected socket
+inline task<int64_t> accept(int64_t fd,void* =nullptr){
+    while(true){
+        int res=::accept4(fd,nullptr,nullptr,SOCK_NONBLOCK|SOCK_CLOEXEC);
+        if(res>=0){
+            int yes=1;
+            setsockopt(res,IPPROTO_TCP,TCP_NODELAY,&yes,sizeof(yes));
+            co_return res;
+        }
+        if(errno==EINTR||errno==ECONNABORTED){
+            continue;
+        }
+        if(!detail::would_block()){
+            co_return -1;
+        }
+        co_await detail::fd_awaiter{int(fd),false};
+    }
+}
+
+//connects to an ipv4 address, returns the socket or -1
+inline task<int64_t> connect(const char* host,int64_t port,void* =nullptr){
+    sockaddr_in addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family=AF_INET;
+    addr.sin_port=htons(uint16_t(port));
+    if(inet_pton(AF_INET,host,&addr.sin_addr)!=1){
+        co_return -1;
+    }
+    int fd=socket(AF_INET,SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC,0);
+    if(fd<0){
+        co_return -1;
+    }
+    int yes=1;
+    setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&yes,sizeof(yes));
+    if(::connect(fd,(sockaddr*)&addr,sizeof(addr))<0){
+        if(errno!=EINPROGRESS){
+            ::close(fd);
+            co_return -1;
+        }
+        co_await detail::fd_awaiter{fd,true};
+        int err=0;
+        socklen_t len=sizeof(err);
+        if(getsockopt(fd,SOL_SOCKET,SO_ERROR,&err,&len)<0||err!=0){
+            ::close(fd);
+            co_return -1;
+        }
+    }
+    co_return fd;
+}
+}
+#endif
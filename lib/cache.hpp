@@ -0,0 +1,194 @@
+#ifndef __PEREGRINE__CACHE__
+#define __PEREGRINE__CACHE__
+//Runtime of @cache and @cache(maxsize=N). A cached function keeps what it
+//returned for each tuple of arguments in a hash table of its own, one per
+//thread so that calls from @parallel loops and spawned tasks need no lock.
+//The keys are stored as they are, the table is open addressing with linear
+//probing over the indices of the entries. With a maxsize the entries are
+//also kept in a list by when they were last used and the oldest one is
+//replaced once the cache is full.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "alloc.hpp"
+namespace Peregrine{
+namespace cache_key{
+template<typename T>
+uint64_t bits(const T& value){
+    if constexpr(std::is_floating_point_v<T>){
+        //the bits, so that a nan finds itself and -0.0 is not 0.0
+        uint64_t res=0;
+        std::memcpy(&res,&value,sizeof(T)<sizeof(res)?sizeof(T):sizeof(res));
+        return res;
+    }
+    else if constexpr(std::is_enum_v<T>){
+        return uint64_t(static_cast<std::underlying_type_t<T>>(value));
+    }
+    else{
+        return uint64_t(value);
+    }
+}
+template<typename... T>
+uint64_t hash(const std::tuple<T...>& key){
+    uint64_t h=0x9E3779B97F4A7C15ull;
+    std::apply([&](const T&... values){
+        ((h=(h^bits(values))*0xBF58476D1CE4E5B9ull,h^=h>>31),...);
+    },key);
+    return h;
+}
+template<typename... T>
+bool equal(const std::tuple<T...>& a,const std::tuple<T...>& b){
+    return std::apply([&](const T&... x){
+        return std::apply([&](const T&... y){
+            return ((bits(x)==bits(y))&&...&&true);
+        },b);
+    },a);
+}
+}
+
+template<typename Signature>
+class cache;
+
+template<typename R,typename... A>
+class cache<R(A...)>{
+    using key_type=std::tuple<A...>;
+    static constexpr uint32_t none=UINT32_MAX;
+    struct entry{
+        key_type key;
+        R value;
+        uint32_t newer=none;
+        uint32_t older=none;
+    };
+    entry* m_entries=nullptr;
+    size_t m_size=0;
+    size_t m_capacity=0;
+    //index of an entry plus one, 0 is an empty slot
+    uint32_t* m_slots=nullptr;
+    size_t m_mask=0;
+    size_t m_maxsize;//0 when the cache grows without a limit
+    uint32_t m_newest=none;
+    uint32_t m_oldest=none;
+
+    //slot of key, or the empty one where it would go
+    size_t slot(const key_type& key,uint64_t h) const{
+        size_t i=h&m_mask;
+        while(m_slots[i]!=0&&!cache_key::equal(m_entries[m_slots[i]-1].key,key)){
+            i=(i+1)&m_mask;
+        }
+        return i;
+    }
+    void rehash(size_t count){
+        deallocate(m_slots,m_mask+1,m_size);
+        m_slots=allocate<uint32_t>(count,m_mask!=0);
+        std::memset(m_slots,0,count*sizeof(uint32_t));
+        m_mask=count-1;
+        for(size_t i=0;i<m_size;++i){
+            m_slots[slot(m_entries[i].key,cache_key::hash(m_entries[i].key))]=i+1;
+        }
+    }
+    //removes the slot of an entry, moving back the ones after it that
+    //would not be found past the hole otherwise
+    void erase(size_t i){
+        size_t j=i;
+        while(true){
+            j=(j+1)&m_mask;
+            if(m_slots[j]==0){
+                break;
+            }
+            size_t home=cache_key::hash(m_entries[m_slots[j]-1].key)&m_mask;
+            if(((j-home)&m_mask)>=((j-i)&m_mask)){
+                m_slots[i]=m_slots[j];
+                i=j;
+            }
+        }
+        m_slots[i]=0;
+    }
+    void unlink(uint32_t index){
+        entry& e=m_entries[index];
+        (e.newer==none?m_newest:m_entries[e.newer].older)=e.older;
+        (e.older==none?m_oldest:m_entries[e.older].newer)=e.newer;
+    }
+    void make_newest(uint32_t index){
+        entry& e=m_entries[index];
+        e.older=m_newest;
+        e.newer=none;
+        if(m_newest!=none){
+            m_entries[m_newest].newer=index;
+        }
+        m_newest=index;
+        if(m_oldest==none){
+            m_oldest=index;
+        }
+    }
+    void insert(key_type key,const R& value,uint64_t h){
+        uint32_t index;
+        if(m_maxsize!=0&&m_size==m_maxsize){
+            //the least recently used entry makes room
+            index=m_oldest;
+            unlink(index);
+            erase(slot(m_entries[index].key,cache_key::hash(m_entries[index].key)));
+        }
+        else{
+            if(m_size==m_capacity){
+                size_t capacity=m_capacity?m_capacity*2:16;
+                if(m_maxsize!=0&&capacity>m_maxsize){
+                    capacity=m_maxsize;
+                }
+                entry* entries=allocate<entry>(capacity,m_capacity!=0);
+                for(size_t i=0;i<m_size;++i){
+                    entries[i]=std::move(m_entries[i]);
+                }
+                deallocate(m_entries,m_capacity,m_size);
+                m_entries=entries;
+                m_capacity=capacity;
+            }
+            //at most half of the slots are used
+            if((m_size+1)*2>m_mask+1){
+                rehash((m_mask+1)*2);
+            }
+            index=m_size++;
+        }
+        m_entries[index].key=std::move(key);
+        m_entries[index].value=value;
+        m_slots[slot(m_entries[index].key,h)]=index+1;
+        if(m_maxsize!=0){
+            make_newest(index);
+        }
+    }
+
+    public:
+    explicit cache(int64_t maxsize=0):m_maxsize(maxsize>0?size_t(maxsize):0){
+        rehash(16);
+    }
+    cache(const cache&)=delete;
+    cache& operator=(const cache&)=delete;
+    ~cache(){
+        deallocate(m_entries,m_capacity,m_size);
+        deallocate(m_slots,m_mask+1,m_size);
+    }
+    size_t size() const{
+        return m_size;
+    }
+    //the value for key, compute() gives it when it is not cached yet. compute
+    //may call the function again, so no slot is held on to while it runs
+    template<typename F>
+    R get(const key_type& key,F compute){
+        uint64_t h=cache_key::hash(key);
+        uint32_t index=m_slots[slot(key,h)];
+        if(index!=0){
+            if(m_maxsize!=0&&index-1!=m_newest){
+                unlink(index-1);
+                make_newest(index-1);
+            }
+            return m_entries[index-1].value;
+        }
+        R value=compute();
+        insert(key,value,h);
+        return value;
+    }
+};
+}
+#endif
@@ -0,0 +1,350 @@
+#ifndef __PEREGRINE__CHANNEL__
+#define __PEREGRINE__CHANNEL__
+//Channels and atomics for threads that hand values to each other. A channel
+//is a bounded lock free queue, threads only sleep (on a futex) when it is
+//empty or full and are woken by the thread that changes that.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "alloc.hpp"
+#include "layout.hpp"
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+namespace Peregrine{
+inline size_t queue_capacity(int64_t capacity){
+    size_t res=2;
+    while(int64_t(res)<capacity){
+        res<<=1;
+    }
+    return res;
+}
+
+//sleeps as long as word is still expected, may return early
+inline void futex_wait(std::atomic<uint32_t>& word,uint32_t expected){
+#ifdef __linux__
+    syscall(SYS_futex,reinterpret_cast<uint32_t*>(&word),FUTEX_WAIT_PRIVATE,expected,nullptr,nullptr,0);
+#else
+    word.wait(expected);
+#endif
+}
+
+inline void futex_wake_all(std::atomic<uint32_t>& word){
+#ifdef __linux__
+    syscall(SYS_futex,reinterpret_cast<uint32_t*>(&word),FUTEX_WAKE_PRIVATE,INT32_MAX,nullptr,nullptr,0);
+#else
+    word.notify_all();
+#endif
+}
+
+//any number of producers and consumers (Dmitry Vyukov's bounded queue). every
+//cell has a sequence number that tells whose turn it is, so a push or a pop is
+//one compare and swap on the position and no lock
+template<typename T>
+class mpmc_queue{
+    struct cell{
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    cell* m_cells;
+    size_t m_mask;
+    //producers and consumers write their positions on their own cache lines
+    alignas(cache_line) std::atomic<size_t> m_enqueue{0};
+    alignas(cache_line) std::atomic<size_t> m_dequeue{0};
+
+    public:
+    explicit mpmc_queue(int64_t capacity){
+        size_t size=queue_capacity(capacity);
+        m_cells=allocate<cell>(size);
+        m_mask=size-1;
+        for(size_t i=0;i<size;++i){
+            m_cells[i].sequence.store(i,std::memory_order_relaxed);
+        }
+    }
+    ~mpmc_queue(){
+        deallocate(m_cells,m_mask+1,m_mask+1);
+    }
+    size_t capacity() const{
+        return m_mask+1;
+    }
+    //value is only moved from when this returns true
+    bool push(T& value){
+        size_t pos=m_enqueue.load(std::memory_order_relaxed);
+        while(true){
+            cell& c=m_cells[pos&m_mask];
+            size_t seq=c.sequence.load(std::memory_order_acquire);
+            intptr_t diff=intptr_t(seq)-intptr_t(pos);
+            if(diff==0){
+                if(m_enqueue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)){
+                    c.value=std::move(value);
+                    c.sequence.store(pos+1,std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff<0){
+                return false;//full
+            }
+            else{
+                pos=m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    bool pop(T& out){
+        size_t pos=m_dequeue.load(std::memory_order_relaxed);
+        while(true){
+            cell& c=m_cells[pos&m_mask];
+            size_t seq=c.sequence.load(std::memory_order_acquire);
+            intptr_t diff=intptr_t(seq)-intptr_t(pos+1);
+            if(diff==0){
+                if(m_dequeue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)){
+                    out=std::move(c.value);
+                    c.sequence.store(pos+m_mask+1,std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff<0){
+                return false;//empty
+            }
+            else{
+                pos=m_dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+//one producer and one consumer. each side owns one position and keeps a copy
+//of the other one, which it only reloads when the queue looks full or empty
+template<typename T>
+class spsc_queue{
+    T* m_items;
+    size_t m_mask;
+    alignas(cache_line) std::atomic<size_t> m_head{0};//next to pop
+    size_t m_tail_cache=0;
+    alignas(cache_line) std::atomic<size_t> m_tail{0};//next to push
+    size_t m_head_cache=0;
+
+    public:
+    explicit spsc_queue(int64_t capacity){
+        size_t size=queue_capacity(capacity);
+        m_items=allocate<T>(size);
+        m_mask=size-1;
+    }
+    ~spsc_queue(){
+        deallocate(m_items,m_mask+1,m_mask+1);
+    }
+    size_t capacity() const{
+        return m_mask+1;
+    }
+    bool push(T& value){
+        size_t tail=m_tail.load(std::memory_order_relaxed);
+        if(tail-m_head_cache>m_mask){
+            m_head_cache=m_head.load(std::memory_order_acquire);
+            if(tail-m_head_cache>m_mask){
+                return false;
+            }
+        }
+        m_items[tail&m_mask]=std::move(value);
+        m_tail.store(tail+1,std::memory_order_release);
+        return true;
+    }
+    bool pop(T& out){
+        size_t head=m_head.load(std::memory_order_relaxed);
+        if(head==m_tail_cache){
+            m_tail_cache=m_tail.load(std::memory_order_acquire);
+            if(head==m_tail_cache){
+                return false;
+            }
+        }
+        out=std::move(m_items[head&m_mask]);
+        m_head.store(head+1,std::memory_order_release);
+        return true;
+    }
+};
+
+//a queue plus blocking. a thread that has to wait reads the epoch of what it
+//waits for, registers as a waiter and tries once more before it sleeps. the
+//other side bumps the epoch and wakes it only if someone is registered, so
+//a send or receive that does not have to wake anybody makes no syscall
+template<typename Queue,typename T>
+class basic_channel{
+    Queue m_queue;
+    struct alignas(cache_line) event{
+        std::atomic<uint32_t> epoch{0};
+        std::atomic<uint32_t> waiters{0};
+    };
+    event m_not_empty;
+    event m_not_full;
+    std::atomic<bool> m_closed{false};
+
+    static constexpr int spins=64;
+
+    static void notify(event& e){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(e.waiters.load(std::memory_order_relaxed)>0){
+            e.epoch.fetch_add(1,std::memory_order_release);
+            futex_wake_all(e.epoch);
+        }
+    }
+    //calls attempt until it succeeds or the channel is closed
+    template<typename F>
+    bool wait_for(event& e,F attempt){
+        for(int i=0;i<spins;++i){
+            if(attempt()){
+                return true;
+            }
+            if(m_closed.load(std::memory_order_acquire)){
+                return attempt();
+            }
+        }
+        while(true){
+            uint32_t epoch=e.epoch.load(std::memory_order_acquire);
+            e.waiters.fetch_add(1,std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool done=attempt();
+            if(!done&&!m_closed.load(std::memory_order_acquire)){
+                futex_wait(e.epoch,epoch);
+                done=attempt();
+            }
+            e.waiters.fetch_sub(1,std::memory_order_relaxed);
+            if(done){
+                return true;
+            }
+            if(m_closed.load(std::memory_order_acquire)){
+                return attempt();
+            }
+        }
+    }
+
+    //value handed out by __iterate__ right after __iter__ received it. it is
+    //per thread because several threads may loop over the same channel
+    static inline thread_local T t_current{};
+
+    public:
+    template<typename H=std::nullptr_t>
+    explicit basic_channel(int64_t capacity,H=nullptr):m_queue(capacity){}
+    basic_channel(const basic_channel&)=delete;
+    basic_channel& operator=(const basic_channel&)=delete;
+
+    //false if the channel is full
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____try_send(T value,H=nullptr){
+        if(m_closed.load(std::memory_order_acquire)||!m_queue.push(value)){
+            return false;
+        }
+        notify(m_not_empty);
+        return true;
+    }
+    //false if the channel is empty
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____try_receive(T* out,H=nullptr){
+        if(!m_queue.pop(*out)){
+            return false;
+        }
+        notify(m_not_full);
+        return true;
+    }
+    //waits while the channel is full, false if it is closed
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____send(T value,H=nullptr){
+        bool sent=wait_for(m_not_full,[&]{
+            return !m_closed.load(std::memory_order_relaxed)&&m_queue.push(value);
+        });
+        if(sent){
+            notify(m_not_empty);
+        }
+        return sent;
+    }
+    //waits while the channel is empty. once it is closed and empty the
+    //default value of T is returned
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P____receive(H=nullptr){
+        T res{};
+        if(wait_for(m_not_empty,[&]{return m_queue.pop(res);})){
+            notify(m_not_full);
+        }
+        return res;
+    }
+    //senders fail from now on, receivers get what is left in the channel
+    template<typename H=std::nullptr_t>
+    void ____mem____P____P____close(H=nullptr){
+        m_closed.store(true,std::memory_order_seq_cst);
+        for(event* e:{&m_not_empty,&m_not_full}){
+            e->epoch.fetch_add(1,std::memory_order_release);
+            futex_wake_all(e->epoch);
+        }
+    }
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____closed(H=nullptr){
+        return m_closed.load(std::memory_order_acquire);
+    }
+    template<typename H=std::nullptr_t>
+    int64_t ____mem____P____P____capacity(H=nullptr){
+        return m_queue.capacity();
+    }
+
+    //for x in ch: receives until the channel is closed and empty
+    template<typename H=std::nullptr_t>
+    size_t ____mem____P____P______iter__(H=nullptr){
+        bool received=wait_for(m_not_empty,[&]{return m_queue.pop(t_current);});
+        if(!received){
+            return 0;
+        }
+        notify(m_not_full);
+        return SIZE_MAX;
+    }
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P______iterate__(H=nullptr){
+        return std::move(t_current);
+    }
+};
+
+template<typename T>
+using channel=basic_channel<mpmc_queue<T>,T>;
+template<typename T>
+using spsc_channel=basic_channel<spsc_queue<T>,T>;
+
+//atomic{int} and atomic{*T}
+template<typename T>
+class atomic{
+    std::atomic<T> m_value;
+
+    public:
+    template<typename H=std::nullptr_t>
+    explicit atomic(T value=T(),H=nullptr):m_value(value){}
+    atomic(const atomic&)=delete;
+    atomic& operator=(const atomic&)=delete;
+
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P____load(H=nullptr){
+        return m_value.load();
+    }
+    template<typename H=std::nullptr_t>
+    void ____mem____P____P____store(T value,H=nullptr){
+        m_value.store(value);
+    }
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P____exchange(T value,H=nullptr){
+        return m_value.exchange(value);
+    }
+    //stores desired if the value is expected, returns whether it did
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____compare_exchange(T expected,T desired,H=nullptr){
+        return m_value.compare_exchange_strong(expected,desired);
+    }
+    //these return the value from before the change
+    template<typename D,typename H=std::nullptr_t>
+    T ____mem____P____P____fetch_add(D delta,H=nullptr){
+        return m_value.fetch_add(delta);
+    }
+    template<typename D,typename H=std::nullptr_t>
+    T ____mem____P____P____fetch_sub(D delta,H=nullptr){
+        return m_value.fetch_sub(delta);
+    }
+};
+}
+#endif
@@ -0,0 +1,11 @@
+#ifndef __PEREGRINE__DISPATCH__
+#define __PEREGRINE__DISPATCH__
+//@target_clones compiles a function once for every instruction set it names,
+//the loader picks the best one for the cpu it runs on (through an ifunc).
+//Targets without ifuncs or with other instruction sets get the default one
+#if (defined(__x86_64__)||defined(__i386__))&&defined(__ELF__)&&(!defined(__clang__)||__clang_major__>=14)
+#define PEREGRINE_TARGET_CLONES(...) __attribute__((target_clones(__VA_ARGS__)))
+#else
+#define PEREGRINE_TARGET_CLONES(...)
+#endif
+#endif
@@ -0,0 +1,47 @@
+#ifndef __PEREGRINE__GENERATOR__
+#define __PEREGRINE__GENERATOR__
+//Functions that yield are compiled to structs with a switch based next(), this
+//has the types their for loops need to keep the loop variables as members.
+//Every for loop walks its sequence with loop_end and loop_item
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+namespace Peregrine{
+//a sequence with __iter__/__iterate__ moves a cursor of its own, anything
+//else is walked by index with __len__ and __getitem__ (soa_list and column),
+//so every loop over it keeps its own position
+template<typename S>
+concept has_cursor=requires(S& sequence){sequence.____mem____P____P______iter__(nullptr);};
+
+//the loop goes on while its index is below this
+template<typename S,typename H>
+size_t loop_end(S& sequence,H handlers){
+    if constexpr(has_cursor<S>){
+        return sequence.____mem____P____P______iter__(handlers);
+    }
+    else{
+        return sequence.____mem____P____P______len__(handlers);
+    }
+}
+
+template<typename S,typename H>
+decltype(auto) loop_item(S& sequence,size_t index,H handlers){
+    if constexpr(has_cursor<S>){
+        return sequence.____mem____P____P______iterate__(handlers);
+    }
+    else{
+        return sequence.____mem____P____P______getitem__(index,handlers);
+    }
+}
+
+//what for x in sequence assigns to x
+template<typename S>
+using iterate_t=std::decay_t<decltype(loop_item(std::declval<S&>(),0,nullptr))>;
+
+//what for x,y in sequence assigns to x and y
+template<typename T>
+using getitem_t=std::decay_t<decltype(std::declval<T&>().____mem____P____P______getitem__(0,nullptr))>;
+}
+#endif
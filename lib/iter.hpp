@@ -0,0 +1,288 @@
+#ifndef __PEREGRINE__ITER__
+#define __PEREGRINE__ITER__
+//Lazy iterators for |> pipelines. Every stage pulls one value at a time from
+//the stage before it, so a chain never builds an intermediate list. Chains
+//that end in sum, count or reduce are fused into a single loop by the
+//compiler, these are used for everything else (and can be iterated by for).
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "generator.hpp"
+namespace Peregrine{
+namespace iter{
+//NULL is passed as the exception handlers outside of functions
+template<typename H>
+auto handlers(H h){
+    if constexpr(std::is_pointer_v<H>){
+        return h;
+    }
+    else{
+        return nullptr;
+    }
+}
+
+template<typename T>
+struct is_tuple:std::false_type{};
+template<typename... T>
+struct is_tuple<std::tuple<T...>>:std::true_type{};
+
+//values of enumerate and zip are spread over the parameters of the next stage
+template<typename F,typename T,typename H>
+decltype(auto) call(F& fn,T&& value,H h){
+    if constexpr(is_tuple<std::decay_t<T>>::value){
+        return std::apply([&](auto&&... items){return fn(items...,h);},std::forward<T>(value));
+    }
+    else{
+        return fn(std::forward<T>(value),h);
+    }
+}
+
+template<typename T,typename... V>
+auto append(T&& value,V&&... more){
+    if constexpr(is_tuple<std::decay_t<T>>::value){
+        return std::tuple_cat(std::forward<T>(value),std::make_tuple(std::forward<V>(more)...));
+    }
+    else{
+        return std::make_tuple(std::forward<T>(value),std::forward<V>(more)...);
+    }
+}
+
+//next() moves to the next value and returns false at the end, value() is the
+//current one. __iter__/__iterate__ make every stage usable in a for loop
+template<typename D>
+struct view{
+    template<typename H=std::nullptr_t>
+    size_t ____mem____P____P______iter__(H=nullptr){
+        return static_cast<D*>(this)->next()?SIZE_MAX:0;
+    }
+    template<typename H=std::nullptr_t>
+    auto ____mem____P____P______iterate__(H=nullptr){
+        return static_cast<D*>(this)->value();
+    }
+};
+
+struct range_view:view<range_view>{
+    int64_t current;
+    int64_t stop;
+    bool started=false;
+    range_view(int64_t start,int64_t stop):current(start),stop(stop){}
+    bool next(){
+        if(started){
+            ++current;
+        }
+        started=true;
+        return current<stop;
+    }
+    int64_t value() const{
+        return current;
+    }
+};
+
+template<typename T>
+struct span_view:view<span_view<T>>{
+    T* data;
+    size_t size;
+    size_t index=0;
+    bool started=false;
+    span_view(T* data,size_t size):data(data),size(size){}
+    bool next(){
+        if(started){
+            ++index;
+        }
+        started=true;
+        return index<size;
+    }
+    T value() const{
+        return data[index];
+    }
+};
+
+//anything a for loop can walk, like generators or the stages below
+template<typename S,typename H>
+struct source_view:view<source_view<S,H>>{
+    S seq;
+    H h;
+    size_t index=0;
+    std::optional<iterate_t<S>> current;
+    source_view(S seq,H h):seq(std::move(seq)),h(h){}
+    bool next(){
+        if(index<loop_end(seq,h)){
+            current.emplace(loop_item(seq,index,h));
+            ++index;
+            return true;
+        }
+        return false;
+    }
+    iterate_t<S> value() const{
+        return *current;
+    }
+};
+
+template<typename S,typename H>
+auto source(S&& seq,H h){
+    using T=std::decay_t<S>;
+    if constexpr(std::is_base_of_v<view<T>,T>){
+        return T(std::forward<S>(seq));
+    }
+    else{
+        return source_view<T,decltype(handlers(h))>(std::forward<S>(seq),handlers(h));
+    }
+}
+
+template<typename S,typename F,typename H>
+struct map_view:view<map_view<S,F,H>>{
+    S src;
+    F fn;
+    H h;
+    map_view(S src,F fn,H h):src(std::move(src)),fn(std::move(fn)),h(h){}
+    bool next(){
+        return src.next();
+    }
+    auto value(){
+        return call(fn,src.value(),h);
+    }
+};
+
+template<typename S,typename F,typename H>
+struct filter_view:view<filter_view<S,F,H>>{
+    S src;
+    F fn;
+    H h;
+    filter_view(S src,F fn,H h):src(std::move(src)),fn(std::move(fn)),h(h){}
+    bool next(){
+        while(src.next()){
+            if(call(fn,src.value(),h)){
+                return true;
+            }
+        }
+        return false;
+    }
+    auto value(){
+        return src.value();
+    }
+};
+
+template<typename S>
+struct take_view:view<take_view<S>>{
+    S src;
+    int64_t left;
+    take_view(S src,int64_t count):src(std::move(src)),left(count){}
+    bool next(){
+        if(left<=0){
+            return false;
+        }
+        --left;
+        return src.next();
+    }
+    auto value(){
+        return src.value();
+    }
+};
+
+template<typename S>
+struct enumerate_view:view<enumerate_view<S>>{
+    S src;
+    int64_t index=-1;
+    explicit enumerate_view(S src):src(std::move(src)){}
+    bool next(){
+        ++index;
+        return src.next();
+    }
+    auto value(){
+        return append(index,src.value());
+    }
+};
+
+template<typename A,typename B>
+struct zip_view:view<zip_view<A,B>>{
+    A first;
+    B second;
+    zip_view(A first,B second):first(std::move(first)),second(std::move(second)){}
+    bool next(){
+        return first.next()&&second.next();
+    }
+    auto value(){
+        return append(first.value(),second.value());
+    }
+};
+
+template<typename H>
+range_view range(int64_t stop,H){
+    return range_view(0,stop);
+}
+
+template<typename H>
+range_view range(int64_t start,int64_t stop,H){
+    return range_view(start,stop);
+}
+
+template<typename T,typename H>
+span_view<T> span(T* data,int64_t size,H){
+    return span_view<T>(data,size);
+}
+
+template<typename S,typename F,typename H>
+auto map(S&& seq,F fn,H h){
+    auto src=source(std::forward<S>(seq),h);
+    return map_view<decltype(src),F,decltype(handlers(h))>(std::move(src),std::move(fn),handlers(h));
+}
+
+template<typename S,typename F,typename H>
+auto filter(S&& seq,F fn,H h){
+    auto src=source(std::forward<S>(seq),h);
+    return filter_view<decltype(src),F,decltype(handlers(h))>(std::move(src),std::move(fn),handlers(h));
+}
+
+template<typename S,typename H>
+auto take(S&& seq,int64_t count,H h){
+    auto src=source(std::forward<S>(seq),h);
+    return take_view<decltype(src)>(std::move(src),count);
+}
+
+template<typename S,typename H>
+auto enumerate(S&& seq,H h){
+    auto src=source(std::forward<S>(seq),h);
+    return enumerate_view<decltype(src)>(std::move(src));
+}
+
+template<typename A,typename B,typename H>
+auto zip(A&& first,B&& second,H h){
+    auto a=source(std::forward<A>(first),h);
+    auto b=source(std::forward<B>(second),h);
+    return zip_view<decltype(a),decltype(b)>(std::move(a),std::move(b));
+}
+
+template<typename S,typename F,typename T,typename H>
+T reduce(S&& seq,F fn,T init,H h){
+    auto src=source(std::forward<S>(seq),h);
+    while(src.next()){
+        init=std::apply([&](auto&&... items){return fn(init,items...,handlers(h));},append(src.value()));
+    }
+    return init;
+}
+
+template<typename S,typename H>
+auto sum(S&& seq,H h){
+    auto src=source(std::forward<S>(seq),h);
+    std::decay_t<decltype(src.value())> total{};
+    while(src.next()){
+        total+=src.value();
+    }
+    return total;
+}
+
+template<typename S,typename H>
+int64_t count(S&& seq,H h){
+    auto src=source(std::forward<S>(seq),h);
+    int64_t res=0;
+    while(src.next()){
+        ++res;
+    }
+    return res;
+}
+}
+}
+#endif
@@ -0,0 +1,19 @@
+#ifndef __PEREGRINE__LAYOUT__
+#define __PEREGRINE__LAYOUT__
+//Size of the block that two threads must not both write to, @padded aligns
+//to it. It is 64 bytes where the standard library doesnt know better
+#include <cstddef>
+#include <new>
+namespace Peregrine{
+#ifdef __cpp_lib_hardware_interference_size
+//gcc warns that the value depends on -mtune, peregrine classes have no abi to keep
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Winterference-size"
+inline constexpr size_t cache_line=std::hardware_destructive_interference_size;
+#pragma GCC diagnostic pop
+#else
+inline constexpr size_t cache_line=64;
+#endif
+}
+#endif
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include "alloc.hpp"
 namespace Peregrine{
 template<typename T>
 class list{
@@ -16,11 +17,11 @@ class list{
         m_data=nullptr;
     }
     list(size_t size){
-        m_data=new T[size];
+        m_data=allocate<T>(size);
         this->m_capacity=size;
     }
     list(const list<T>& other){
-        m_data=new T[other.m_size];
+        m_data=allocate<T>(other.m_capacity);
         this->m_size=other.m_size;
         this->m_capacity=other.m_capacity;
         for(size_t i=0;i<m_size;i++){
@@ -34,18 +35,13 @@ class list{
         this->m_capacity=other.m_capacity;
     }
     ~list(){
-        if(m_data!=nullptr){
-            delete [] m_data;
-            m_data=nullptr;
-        }
+        deallocate(m_data,m_capacity,m_size);
+        m_data=nullptr;
     }
     list<T>& operator=(const list<T>& other){
         if(this!=&other){
-            if(m_data!=nullptr){
-                delete[] m_data;
-                m_data=nullptr;
-            }
-            m_data=new T[other.m_size];
+            deallocate(m_data,m_capacity,m_size);
+            m_data=allocate<T>(other.m_capacity);
             this->m_size=other.m_size;
             this->m_capacity=other.m_capacity;
             for(size_t i=0;i<m_size;i++){
@@ -56,20 +52,15 @@ class list{
     }
     list<T>& operator=(list<T>&& other){
         if(this!=&other){
-            if(m_data!=nullptr){
-                delete[] m_data;
-                m_data=nullptr;
-            }
-            m_data=new T[other.m_size];
+            deallocate(m_data,m_capacity,m_size);
+            m_data=allocate<T>(other.m_capacity);
             this->m_size=other.m_size;
             this->m_capacity=other.m_capacity;
             for(size_t i=0;i<m_size;i++){
                 m_data[i]=other.m_data[i];
             }
-            if(m_data!=nullptr){
-                delete[] other.m_data;
-                other.m_data=nullptr;
-            }
+            deallocate(other.m_data,other.m_capacity,other.m_size);
+            other.m_data=nullptr;
         }
         return *this;
     }
@@ -113,15 +104,13 @@ class list{
     //TODO: __reverse__
     void extend(const list<T>& other){
         if(m_capacity<=(m_size+other.m_size)){
+            size_t old_capacity=m_capacity;
             m_capacity+=other.m_capacity;
-            T* new_data=new T[m_capacity];
+            T* new_data=allocate<T>(m_capacity,old_capacity!=0);
             for(size_t i=0;i<m_size;i++){
                 new_data[i]=m_data[i];
             }
-            if(m_data!=nullptr){
-                delete[] m_data;
-                m_data=nullptr;
-            }
+            deallocate(m_data,old_capacity,m_size);
             m_data=new_data;
         }
         for (size_t i = 0; i < other.m_size; i++)
@@ -133,28 +122,26 @@ class list{
     }
     void append(T value){
         if(m_size==m_capacity){
+            size_t old_capacity=m_capacity;
             if(m_capacity==0){
                 m_capacity=1;
             }
             else{
                 m_capacity*=2;
             }
-            T* new_data=new T[m_capacity];
+            T* new_data=allocate<T>(m_capacity,old_capacity!=0);
             for(size_t i=0;i<m_size;i++){
                 new_data[i]=m_data[i];
             }
-            if(m_data!=nullptr){
-                delete[] m_data;
-                m_data=nullptr;
-            }
+            deallocate(m_data,old_capacity,m_size);
             m_data=new_data;
         }
         m_size++;
         m_data[m_size-1]=value;
     }
     void clear(){
+        deallocate(m_data,m_capacity,m_size);
         m_size=0;
-        delete[] m_data;
         m_data=nullptr;
         m_capacity=0;
     }
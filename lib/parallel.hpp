@@ -0,0 +1,251 @@
+#ifndef __PEREGRINE__PARALLEL__
+#define __PEREGRINE__PARALLEL__
+//Runtime of @parallel for loops and spawn. The iterations are cut into chunks
+//that are spread over the queues of a work stealing thread pool, a worker
+//takes chunks from the front of its own queue and steals from the back of the
+//others once it runs out. The thread that started the loop works on its
+//chunks too. A spawned task is a chunk of its own.
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+namespace Peregrine{
+class work_stealing_pool{
+    struct job{
+        std::mutex lock;
+        std::condition_variable done;
+        int64_t remaining=0;//chunks that have not finished yet
+    };
+    struct chunk{
+        job* owner=nullptr;
+        const std::function<void(int64_t,int64_t)>* body=nullptr;
+        int64_t begin=0;
+        int64_t end=0;
+    };
+    struct queue{
+        std::mutex lock;
+        std::deque<chunk> chunks;
+    };
+    //one queue per worker and the last one for the threads that start loops
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    size_t m_threads;
+    std::once_flag m_spawn_worker;
+    std::atomic<int64_t> m_queued{0};
+    std::mutex m_sleep;
+    std::condition_variable m_wake;
+    static inline thread_local bool in_worker=false;
+    static inline thread_local size_t worker_index=0;
+
+    bool pop(size_t index,chunk& res){
+        auto& q=*m_queues[index];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if(q.chunks.empty()){
+            return false;
+        }
+        res=q.chunks.front();
+        q.chunks.pop_front();
+        m_queued--;
+        return true;
+    }
+    bool steal(size_t thief,chunk& res){
+        for(size_t i=1;i<m_queues.size();++i){
+            auto& q=*m_queues[(thief+i)%m_queues.size()];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if(!q.chunks.empty()){
+                res=q.chunks.back();
+                q.chunks.pop_back();
+                m_queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+    void run(chunk& c){
+        (*c.body)(c.begin,c.end);
+        std::lock_guard<std::mutex> guard(c.owner->lock);
+        if(--c.owner->remaining==0){
+            c.owner->done.notify_all();
+        }
+    }
+    void push(size_t index,chunk c){
+        auto& q=*m_queues[index];
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.chunks.push_back(c);
+        m_queued++;
+    }
+    void wake(){
+        {
+            std::lock_guard<std::mutex> guard(m_sleep);
+        }
+        m_wake.notify_all();
+    }
+    //works on queued chunks until every chunk of j is done, so waiting never
+    //blocks a thread that could run them
+    void help(job& j,size_t own){
+        while(true){
+            chunk c;
+            if(pop(own,c)||steal(own,c)){
+                run(c);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(j.lock);
+            j.done.wait(guard,[&]{return j.remaining==0;});
+            return;
+        }
+    }
+    size_t own_queue() const{
+        return in_worker?worker_index:m_queues.size()-1;
+    }
+    void start_worker(size_t index){
+        m_workers.emplace_back([this,index]{work(index);});
+        //the workers live as long as the program, they may be blocked in
+        //a loop when exit() is called from a raise
+        m_workers.back().detach();
+    }
+    void work(size_t index){
+        in_worker=true;
+        worker_index=index;
+        while(true){
+            chunk c;
+            if(pop(index,c)||steal(index,c)){
+                run(c);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(m_sleep);
+            m_wake.wait(guard,[&]{return m_queued.load()>0;});
+        }
+    }
+
+    public:
+    explicit work_stealing_pool(size_t threads){
+        m_threads=std::max<size_t>(threads,1);
+        //with one thread loops run on the thread that reaches them, the queue
+        //of the worker that spawn starts is there all the same
+        for(size_t i=0;i<std::max<size_t>(m_threads,2);++i){
+            m_queues.push_back(std::make_unique<queue>());
+        }
+        for(size_t i=0;i+1<m_threads;++i){
+            start_worker(i);
+        }
+    }
+    size_t size() const{
+        return m_threads;
+    }
+    //calls body(lo,hi) for consecutive ranges that together cover [begin,end).
+    //chunk is the number of iterations per range, 0 picks one from the size
+    //of the loop. returns once every range is done
+    void parallel_for(int64_t begin,int64_t end,int64_t chunk_size,const std::function<void(int64_t,int64_t)>& body){
+        if(end<=begin){
+            return;
+        }
+        int64_t count=end-begin;
+        if(chunk_size<=0){
+            //a few chunks per thread so that stealing can even out uneven iterations
+            chunk_size=std::max<int64_t>(1,count/int64_t(size()*4));
+        }
+        if(in_worker||size()==1||chunk_size>=count){
+            //nested loops run on the worker that reached them
+            body(begin,end);
+            return;
+        }
+        job j;
+        j.remaining=(count+chunk_size-1)/chunk_size;
+        size_t target=0;
+        for(int64_t lo=begin;lo<end;lo+=chunk_size){
+            push(target,{&j,&body,lo,std::min(end,lo+chunk_size)});
+            target=(target+1)%m_queues.size();
+        }
+        wake();
+        help(j,m_queues.size()-1);
+    }
+
+    //tasks that are waited for together. only the thread that created the
+    //group spawns into it
+    class group{
+        friend class work_stealing_pool;
+        job m_job;
+        std::deque<std::function<void(int64_t,int64_t)>> m_tasks;//a deque keeps them in place
+    };
+    void spawn(group& g,std::function<void()> task){
+        //a task may wait for the thread that spawned it, say on a channel, so
+        //it can not be left until the group is waited for
+        if(m_threads==1){
+            std::call_once(m_spawn_worker,[this]{start_worker(0);});
+        }
+        g.m_tasks.emplace_back([task=std::move(task)](int64_t,int64_t){task();});
+        {
+            std::lock_guard<std::mutex> guard(g.m_job.lock);
+            g.m_job.remaining++;
+        }
+        //a worker queues its tasks on its own queue so it finds them first
+        push(own_queue(),{&g.m_job,&g.m_tasks.back(),0,1});
+        wake();
+    }
+    void wait(group& g){
+        help(g.m_job,own_queue());
+        g.m_tasks.clear();
+    }
+};
+
+//PEREGRINE_THREADS overrides the number of threads, the default is one per core
+inline work_stealing_pool& default_pool(){
+    static work_stealing_pool* pool=[]{
+        size_t threads=std::thread::hardware_concurrency();
+        if(const char* env=std::getenv("PEREGRINE_THREADS")){
+            threads=std::strtoull(env,nullptr,10);
+        }
+        return new work_stealing_pool(threads);
+    }();
+    return *pool;
+}
+
+inline void parallel_for(int64_t begin,int64_t end,int64_t chunk_size,const std::function<void(int64_t,int64_t)>& body){
+    default_pool().parallel_for(begin,end,chunk_size,body);
+}
+
+//reduction variables start from the identity of their operator in every chunk,
+//the partial results are combined once the chunk is done
+enum class reduce_op{sum,product,min,max};
+
+template<reduce_op op,typename T>
+T reduce_identity(){
+    if constexpr(op==reduce_op::sum){
+        return T(0);
+    }
+    else if constexpr(op==reduce_op::product){
+        return T(1);
+    }
+    else if constexpr(op==reduce_op::min){
+        return std::numeric_limits<T>::max();
+    }
+    else{
+        return std::numeric_limits<T>::lowest();
+    }
+}
+
+template<reduce_op op,typename T>
+void reduce_combine(T& into,const T& partial){
+    if constexpr(op==reduce_op::sum){
+        into+=partial;
+    }
+    else if constexpr(op==reduce_op::product){
+        into*=partial;
+    }
+    else if constexpr(op==reduce_op::min){
+        into=std::min(into,partial);
+    }
+    else{
+        into=std::max(into,partial);
+    }
+}
+}
+#endif
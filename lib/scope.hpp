@@ -0,0 +1,70 @@
+#ifndef __PEREGRINE__SCOPE__
+#define __PEREGRINE__SCOPE__
+//Runtime of spawn inside a scope block. The tasks run on the pool of
+//@parallel loops and the scope waits for all of them before it is left. A
+//task that raises is stopped with its own jmp_buf, the first of these errors
+//is raised again by the thread that owns the scope once every task is done.
+//A raise in the body of the scope is caught the same way by the generated
+//code, which joins the tasks before it passes the error on.
+#include <atomic>
+#include <functional>
+#include <setjmp.h>
+#include <type_traits>
+#include <utility>
+#include "parallel.hpp"
+namespace Peregrine{
+//arguments of a spawned call are evaluated when it is spawned and copied into
+//the task. things that can not be copied (channels, atomics) are shared
+template<typename T>
+auto spawn_arg(T&& value){
+    using D=std::decay_t<T>;
+    if constexpr(std::is_copy_constructible_v<D>||!std::is_lvalue_reference_v<T>){
+        return D(std::forward<T>(value));
+    }
+    else{
+        return std::ref(value);
+    }
+}
+
+//Handler is ____P____exception_handler, which the generated code defines
+//after the runtime headers
+template<typename Handler>
+class scope{
+    work_stealing_pool::group m_group;
+    std::atomic<bool> m_failed{false};
+    Handler m_error{};
+    bool m_joined=false;
+
+    public:
+    scope()=default;
+    scope(const scope&)=delete;
+    scope& operator=(const scope&)=delete;
+    //a return or break out of the scope still waits for its tasks
+    ~scope(){
+        if(!m_joined){
+            default_pool().wait(m_group);
+        }
+    }
+    //task is called with the handlers that catch its raise
+    template<typename F>
+    void spawn(F task){
+        default_pool().spawn(m_group,[this,task=std::move(task)]() mutable{
+            jmp_buf buf;
+            Handler handlers{&buf};
+            if(!setjmp(buf)){
+                task(&handlers);
+            }
+            else if(!m_failed.exchange(true)){
+                m_error=handlers;
+            }
+        });
+    }
+    //waits for every task, returns the first error or nullptr
+    Handler* join(){
+        default_pool().wait(m_group);
+        m_joined=true;
+        return m_failed.load()?&m_error:nullptr;
+    }
+};
+}
+#endif
@@ -0,0 +1,223 @@
+#ifndef __PEREGRINE__SIMD__
+#define __PEREGRINE__SIMD__
+//vec{T,N}, N lanes of T that are added, compared and so on all at once. It is
+//a GCC/Clang vector extension type, which the compiler maps to the widest
+//registers the target has (and splits up when N is wider than those).
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if !defined(__GNUC__)
+#error "vec{T,N} needs the vector extensions of GCC or Clang"
+#endif
+namespace Peregrine{
+//lanes of a comparison are -1 where it is true and 0 where it is not
+template<typename T>
+using mask_t=std::conditional_t<sizeof(T)==1,int8_t,
+             std::conditional_t<sizeof(T)==2,int16_t,
+             std::conditional_t<sizeof(T)==4,int32_t,int64_t>>>;
+
+template<typename T,int N>
+class vec{
+    static_assert(N>=2&&(N&(N-1))==0,"the number of lanes has to be a power of 2");
+    typedef T native __attribute__((vector_size(sizeof(T)*N)));
+    native v;
+
+    template<typename U,int M>
+    friend class vec;
+
+    //pointers, arrays and the columns of a soa_list are copied with one
+    //memcpy, anything else that can be indexed one lane at a time
+    template<typename S>
+    static constexpr bool contiguous=std::is_pointer_v<S>||std::is_array_v<S>||requires(S& s){s.data();};
+    template<typename S>
+    static T* elements(S& src,int64_t offset){
+        if constexpr(std::is_pointer_v<S>||std::is_array_v<S>){
+            return src+offset;
+        }
+        else{
+            return src.data()+offset;
+        }
+    }
+
+    public:
+    static vec from(const native& value){
+        vec res;
+        res.v=value;
+        return res;
+    }
+    vec():v{}{}
+    //vec{f32,4}(1.0) sets every lane, vec{f32,4}(1.0,2.0,3.0,4.0) each of
+    //them. the exception handlers passed by peregrine calls are left out
+    template<typename... A>
+    explicit vec(A... args):v{}{
+        constexpr int count=(int(std::is_arithmetic_v<A>)+...+0);
+        static_assert(count==1||count==N,"vec takes one value or one for every lane");
+        T lanes[N];
+        int i=0;
+        auto lane=[&](auto value){
+            if constexpr(std::is_arithmetic_v<decltype(value)>){
+                lanes[i++]=T(value);
+            }
+        };
+        (lane(args),...);
+        if constexpr(count==1){
+            for(int j=1;j<N;++j){
+                lanes[j]=lanes[0];
+            }
+        }
+        std::memcpy(&v,lanes,sizeof(v));
+    }
+
+    //vector types may alias their element type
+    template<typename H=std::nullptr_t>
+    T& ____mem____P____P______getitem__(int64_t index,H=nullptr){
+        return reinterpret_cast<T*>(&v)[index];
+    }
+    T operator[](int index)const{
+        return v[index];
+    }
+
+    //reductions
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P____sum(H=nullptr)const{
+        T res=v[0];
+        for(int i=1;i<N;++i){
+            res+=v[i];
+        }
+        return res;
+    }
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P____min(H=nullptr)const{
+        T res=v[0];
+        for(int i=1;i<N;++i){
+            res=v[i]<res?v[i]:res;
+        }
+        return res;
+    }
+    template<typename H=std::nullptr_t>
+    T ____mem____P____P____max(H=nullptr)const{
+        T res=v[0];
+        for(int i=1;i<N;++i){
+            res=v[i]>res?v[i]:res;
+        }
+        return res;
+    }
+
+    //masks are the vectors that comparisons return
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____any(H=nullptr)const{
+        for(int i=0;i<N;++i){
+            if(v[i]){
+                return true;
+            }
+        }
+        return false;
+    }
+    template<typename H=std::nullptr_t>
+    bool ____mem____P____P____all(H=nullptr)const{
+        for(int i=0;i<N;++i){
+            if(!v[i]){
+                return false;
+            }
+        }
+        return true;
+    }
+    //lanes of a where the mask is set and of b where it is not
+    template<typename U,typename H=std::nullptr_t>
+    vec<U,N> ____mem____P____P____select(const vec<U,N>& a,const vec<U,N>& b,H=nullptr)const{
+        static_assert(std::is_integral_v<T>&&sizeof(T)==sizeof(U),"select takes the mask of a comparison");
+        typedef mask_t<U> bits __attribute__((vector_size(sizeof(U)*N)));
+        bits mask=(bits)v;
+        return vec<U,N>::from((typename vec<U,N>::native)((mask&(bits)a.v)|(~mask&(bits)b.v)));
+    }
+
+    //lane i of the result is lane indices[i] of this one
+    template<typename I,typename H=std::nullptr_t>
+    vec ____mem____P____P____shuffle(const vec<I,N>& indices,H=nullptr)const{
+        static_assert(std::is_integral_v<I>,"the indices of a shuffle have to be integers");
+#if defined(__clang__)
+        vec res;
+        for(int i=0;i<N;++i){
+            res.v[i]=v[indices.v[i]&(N-1)];
+        }
+        return res;
+#else
+        typedef mask_t<T> bits __attribute__((vector_size(sizeof(T)*N)));
+        return from(__builtin_shuffle(v,__builtin_convertvector(indices.v,bits)));
+#endif
+    }
+    template<typename H=std::nullptr_t>
+    vec ____mem____P____P____reverse(H=nullptr)const{
+        vec res;
+        for(int i=0;i<N;++i){
+            res.v[i]=v[N-1-i];
+        }
+        return res;
+    }
+
+    //loads N values from src starting at offset, stores them back there
+    template<typename S,typename H=std::nullptr_t>
+    void ____mem____P____P____load(S&& src,int64_t offset,H=nullptr){
+        if constexpr(contiguous<std::remove_reference_t<S>>){
+            std::memcpy(&v,elements(src,offset),sizeof(v));
+        }
+        else{
+            for(int i=0;i<N;++i){
+                v[i]=src.____mem____P____P______getitem__(offset+i,nullptr);
+            }
+        }
+    }
+    template<typename S,typename H=std::nullptr_t>
+    void ____mem____P____P____store(S&& dst,int64_t offset,H=nullptr)const{
+        if constexpr(contiguous<std::remove_reference_t<S>>){
+            std::memcpy(elements(dst,offset),&v,sizeof(v));
+        }
+        else{
+            for(int i=0;i<N;++i){
+                dst.____mem____P____P______getitem__(offset+i,nullptr)=v[i];
+            }
+        }
+    }
+    template<typename H=std::nullptr_t>
+    int64_t ____mem____P____P____len(H=nullptr)const{
+        return N;
+    }
+
+#define PEREGRINE_VEC_OPERATOR(op)\
+    friend vec operator op(const vec& a,const vec& b){return from(a.v op b.v);}\
+    friend vec operator op(const vec& a,T b){return from(a.v op b);}\
+    friend vec operator op(T a,const vec& b){return from(a op b.v);}
+    PEREGRINE_VEC_OPERATOR(+)
+    PEREGRINE_VEC_OPERATOR(-)
+    PEREGRINE_VEC_OPERATOR(*)
+    PEREGRINE_VEC_OPERATOR(/)
+    PEREGRINE_VEC_OPERATOR(%)
+    PEREGRINE_VEC_OPERATOR(&)
+    PEREGRINE_VEC_OPERATOR(|)
+    PEREGRINE_VEC_OPERATOR(^)
+    PEREGRINE_VEC_OPERATOR(<<)
+    PEREGRINE_VEC_OPERATOR(>>)
+#undef PEREGRINE_VEC_OPERATOR
+
+#define PEREGRINE_VEC_COMPARISON(op)\
+    friend vec<mask_t<T>,N> operator op(const vec& a,const vec& b){return vec<mask_t<T>,N>::from(a.v op b.v);}\
+    friend vec<mask_t<T>,N> operator op(const vec& a,T b){return vec<mask_t<T>,N>::from(a.v op b);}\
+    friend vec<mask_t<T>,N> operator op(T a,const vec& b){return vec<mask_t<T>,N>::from(a op b.v);}
+    PEREGRINE_VEC_COMPARISON(==)
+    PEREGRINE_VEC_COMPARISON(!=)
+    PEREGRINE_VEC_COMPARISON(<)
+    PEREGRINE_VEC_COMPARISON(<=)
+    PEREGRINE_VEC_COMPARISON(>)
+    PEREGRINE_VEC_COMPARISON(>=)
+#undef PEREGRINE_VEC_COMPARISON
+
+    friend vec operator-(const vec& a){
+        return from(-a.v);
+    }
+    friend vec operator~(const vec& a){
+        return from(~a.v);
+    }
+};
+}
+#endif
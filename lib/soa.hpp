@@ -0,0 +1,132 @@
+#ifndef __PEREGRINE__SOA__
+#define __PEREGRINE__SOA__
+//soa_list{T} keeps each field of T in an array of its own. A loop that reads
+//one or two fields of every object only loads those, and the compiler can
+//vectorise a loop over a column. Every class gets a template ____P____SOA
+//from the backend which declares its fields as columns, it is only
+//instantiated by a soa_list of that class. There is no __iter__, a for loop
+//walks a soa_list or a column by index, so loops over one can be nested.
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "alloc.hpp"
+namespace Peregrine{
+//one field of every object in a soa_list, ps.x in peregrine
+template<typename T>
+class column{
+    T* m_data=nullptr;
+    size_t m_size=0;
+    size_t m_capacity=0;
+
+    public:
+    column()=default;
+    column(const column& other){
+        *this=other;
+    }
+    column(column&& other){
+        swap(other);
+    }
+    ~column(){
+        deallocate(m_data,m_capacity,m_size);
+    }
+    column& operator=(const column& other){
+        if(this!=&other){
+            deallocate(m_data,m_capacity,m_size);
+            m_data=other.m_capacity?allocate<T>(other.m_capacity):nullptr;
+            m_size=other.m_size;
+            m_capacity=other.m_capacity;
+            for(size_t i=0;i<m_size;i++){
+                m_data[i]=other.m_data[i];
+            }
+        }
+        return *this;
+    }
+    column& operator=(column&& other){
+        swap(other);
+        return *this;
+    }
+    void swap(column& other){
+        std::swap(m_data,other.m_data);
+        std::swap(m_size,other.m_size);
+        std::swap(m_capacity,other.m_capacity);
+    }
+    void reserve(size_t capacity){
+        if(capacity<=m_capacity){
+            return;
+        }
+        T* data=allocate<T>(capacity,m_capacity!=0);
+        for(size_t i=0;i<m_size;i++){
+            data[i]=std::move(m_data[i]);
+        }
+        deallocate(m_data,m_capacity,m_size);
+        m_data=data;
+        m_capacity=capacity;
+    }
+    void push(const T& value){
+        if(m_size==m_capacity){
+            reserve(m_capacity?m_capacity*2:8);
+        }
+        m_data[m_size++]=value;
+    }
+    void clear(){
+        m_size=0;
+    }
+    T& operator[](size_t index){
+        return m_data[index];
+    }
+    T* data(){
+        return m_data;
+    }
+
+    //not bounds checked, so that loops over a column can be vectorised
+    template<typename H=std::nullptr_t>
+    T& ____mem____P____P______getitem__(int64_t index,H=nullptr){
+        return m_data[index];
+    }
+    template<typename H=std::nullptr_t>
+    size_t ____mem____P____P______len__(H=nullptr)const{
+        return m_size;
+    }
+};
+
+//ps[i] and for p in ps give a ____P____ROW, which refers to the fields of
+//one object in the columns. ps.x is the column of the field x
+template<typename T>
+class soa_list:public T::template ____P____SOA<column>{
+    using columns=typename T::template ____P____SOA<column>;
+    size_t m_size=0;
+
+    public:
+    template<typename H=std::nullptr_t>
+    explicit soa_list(H=nullptr){}
+
+    template<typename H=std::nullptr_t>
+    void ____mem____P____P____append(const T& value,H=nullptr){
+        columns::____P____push(value);
+        ++m_size;
+    }
+    template<typename H=std::nullptr_t>
+    void ____mem____P____P____reserve(int64_t capacity,H=nullptr){
+        columns::____P____reserve(capacity);
+    }
+    template<typename H=std::nullptr_t>
+    void ____mem____P____P____clear(H=nullptr){
+        columns::____P____clear();
+        m_size=0;
+    }
+    template<typename H=std::nullptr_t>
+    int64_t ____mem____P____P____len(H=nullptr){
+        return m_size;
+    }
+
+    template<typename H=std::nullptr_t>
+    auto ____mem____P____P______getitem__(int64_t index,H=nullptr){
+        return columns::____P____row(index);
+    }
+    template<typename H=std::nullptr_t>
+    size_t ____mem____P____P______len__(H=nullptr)const{
+        return m_size;
+    }
+};
+}
+#endif
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include "alloc.hpp"
 namespace Peregrine{
 class str{
     char* m_data;
@@ -15,19 +16,19 @@ class str{
         m_data=nullptr;
     }
     str(const char* string,size_t size){
-        m_data=new char[size];
+        m_data=allocate<char>(size);
         for(size_t i=0;i<size;i++){
             m_data[i]=string[i];
         }
         this->m_capacity=size;
     }
     str(const char c){
-        m_data=new char[1];
+        m_data=allocate<char>(1);
         m_data[0]=c;
         this->m_capacity=1;
     }
     str(const str& other){
-        m_data=new char[other.m_size];
+        m_data=allocate<char>(other.m_capacity);
         this->m_size=other.m_size;
         this->m_capacity=other.m_capacity;
         for(size_t i=0;i<m_size;i++){
@@ -41,12 +42,12 @@ class str{
         this->m_capacity=other.m_capacity;
     }
     ~str(){
-        delete[] m_data;
+        deallocate(m_data,m_capacity,m_size);
     }
     str& operator=(const str& other){
         if(this!=&other){
-            delete[] m_data;
-            m_data=new char[other.m_size];
+            deallocate(m_data,m_capacity,m_size);
+            m_data=allocate<char>(other.m_capacity);
             this->m_size=other.m_size;
             this->m_capacity=other.m_capacity;
             for(size_t i=0;i<m_size;i++){
@@ -57,7 +58,7 @@ class str{
     }
     str& operator=(str&& other){
         if(this!=&other){
-            delete[] m_data;
+            deallocate(m_data,m_capacity,m_size);
             m_data=other.m_data;
             other.m_data=nullptr;
             this->m_size=other.m_size;
@@ -105,12 +106,13 @@ class str{
     //TODO: __reverse__
     void append(const str& other){
         if(m_capacity<=(m_size+other.m_size)){
+            size_t old_capacity=m_capacity;
             m_capacity+=other.m_capacity;
-            char* new_data=new char[m_capacity];
+            char* new_data=allocate<char>(m_capacity,old_capacity!=0);
             for(size_t i=0;i<m_size;i++){
                 new_data[i]=m_data[i];
             }
-            delete[] m_data;
+            deallocate(m_data,old_capacity,m_size);
             m_data=new_data;
         }
         for (size_t i = 0; i < other.m_size; i++)
@@ -122,25 +124,26 @@ class str{
     }
     void append(char value){
         if(m_size==m_capacity){
+            size_t old_capacity=m_capacity;
             if(m_capacity==0){
                 m_capacity=1;
             }
             else{
                 m_capacity*=2;
             }
-            char* new_data=new char[m_capacity];
+            char* new_data=allocate<char>(m_capacity,old_capacity!=0);
             for(size_t i=0;i<m_size;i++){
                 new_data[i]=m_data[i];
             }
-            delete[] m_data;
+            deallocate(m_data,old_capacity,m_size);
             m_data=new_data;
         }
         m_size++;
         m_data[m_size-1]=value;
     }
     void clear(){
+        deallocate(m_data,m_capacity,m_size);
         m_size=0;
-        delete[] m_data;
         m_data=nullptr;
         m_capacity=0;
     }
@@ -0,0 +1,72 @@
+#include "doctest.h"
+
+#include <api/peregrine.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Compile a module to C++ and javascript") {
+  std::string source = "def main():\n    x:int=4\n    printf(\"%lld\\n\", x*2)\n";
+  peregrine::Options options;
+  options.has_main = true;
+
+  auto res = peregrine::compile(source, options);
+  REQUIRE(res.ok);
+  CHECK(res.errors.size() == 0);
+  CHECK(res.output.find("int main ()") != std::string::npos);
+
+  options.target = peregrine::Target::Js;
+  res = peregrine::compile(source, options);
+  REQUIRE(res.ok);
+  CHECK(res.output.find("function main ()") != std::string::npos);
+}
+
+TEST_CASE("Errors are returned instead of exiting") {
+  SUBCASE("Lexer") {
+    auto res = peregrine::compile("def main():\n    x=(1\n");
+    CHECK_FALSE(res.ok);
+    CHECK(res.errors.size() > 0);
+    CHECK(res.output == "");
+  }
+
+  SUBCASE("Parser") {
+    auto res = peregrine::compile("def main()\n    pass\n");
+    CHECK_FALSE(res.ok);
+    REQUIRE(res.errors.size() == 1);
+    CHECK(res.errors[0].loc.line == 1);
+    CHECK(res.diagnostics().find("main.pe:1:9") != std::string::npos);
+  }
+
+  SUBCASE("Validator") {
+    peregrine::Options options;
+    options.filename = "lib.pe";
+    options.has_main = true;
+    auto res = peregrine::compile("def f()->int:\n    return 1\n", options);
+    CHECK_FALSE(res.ok);
+    CHECK(res.message == "lib.pe does not contain a main function");
+  }
+}
+
+TEST_CASE("Modules can be compiled concurrently") {
+  std::vector<std::thread> threads;
+  std::vector<int> ok(8, 0);
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&ok, i] {
+      for (int j = 0; j < 20; ++j) {
+        std::string source = "def f" + std::to_string(i) + "(x:int)->int:\n    return x+" +
+                             std::to_string(j) + "\ndef main():\n    printf(\"%lld\\n\", f" +
+                             std::to_string(i) + "(1))\n";
+        peregrine::Options options;
+        options.filename = "m" + std::to_string(i) + ".pe";
+        auto res = peregrine::compile(source, options);
+        ok[i] += res.ok && res.output.find("+ " + std::to_string(j)) != std::string::npos;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int i = 0; i < 8; ++i) {
+    CHECK(ok[i] == 20);
+  }
+}
@@ -0,0 +1,119 @@
+#include "doctest.h"
+
+#include <api/peregrine.hpp>
+#include <string>
+
+TEST_CASE("Calls through an extern owner are plain c calls") {
+  std::string source = "extern c=import(\"math.h\")\ndef c.sqrt(float)->float\n"
+                       "class Counter:\n    n:int=0\n    def bump(self)->int:\n        self.n+=1\n"
+                       "        return self.n\n";
+  auto res = peregrine::compile(source + "def main():\n    x:float=c.sqrt(16.0)\n");
+  REQUIRE(res.ok);
+  CHECK(res.output.find("sqrt(16.0)") != std::string::npos);
+
+  SUBCASE("Unless a local hides it") {
+    res = peregrine::compile(source + "def main():\n    c:Counter=Counter()\n    x:int=c.bump()\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("____P____P____c.____mem____P____P____bump(") != std::string::npos);
+  }
+
+  SUBCASE("Or a parameter") {
+    res = peregrine::compile(source + "def f(c:Counter)->int:\n    return c.bump()\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("____P____P____c.____mem____P____P____bump(") != std::string::npos);
+  }
+
+  SUBCASE("Before the owner is declared") {
+    res = peregrine::compile("def main():\n    x:float=c.sqrt(16.0)\n"
+                             "extern c=import(\"math.h\")\ndef c.sqrt(float)->float\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("sqrt(16.0)") != std::string::npos);
+    CHECK(res.output.find("____mem____P____P____sqrt") == std::string::npos);
+  }
+}
+
+TEST_CASE("#line names the file as a c string") {
+  peregrine::Options options;
+  options.line_directives = true;
+  options.filename = "C:\\src\\say \"hi\".pe";
+  auto res = peregrine::compile("def main():\n    x:int=1\n", options);
+  REQUIRE(res.ok);
+  CHECK(res.output.find("#line 1 \"C:\\\\src\\\\say \\\"hi\\\".pe\"\n") != std::string::npos);
+}
+
+TEST_CASE("A raise in a scope joins its tasks first") {
+  auto res = peregrine::compile("def work(n:int):\n    printf(\"%lld\\n\", n)\n"
+                                "def main():\n    scope:\n        spawn work(1)\n        raise\n");
+  REQUIRE(res.ok);
+  // the raise in the body goes to the handler of the scope
+  CHECK(res.output.find("if(!setjmp(____P____SCOPE_BUF)){\n"
+                        "____P____exception_handler* ____Pexception_handlers=&____P____SCOPE_RAISED;") !=
+        std::string::npos);
+  // which waits for the tasks before it raises again
+  CHECK(res.output.find("}else{\n____P____SCOPE.join();\nif(____Pexception_handlers!=NULL){\n"
+                        "____Pexception_handlers->err=____P____SCOPE_RAISED.err;") != std::string::npos);
+}
+
+TEST_CASE("A for loop walks a copy unless the sequence can't be copied") {
+  auto res = peregrine::compile("def f(ch:&channel{int}, r:range):\n    for x in ch:\n        printf(\"%lld\\n\", x)\n"
+                                "    for y in r:\n        printf(\"%lld\\n\", y)\n");
+  REQUIRE(res.ok);
+  CHECK(res.output.find("auto&& ____P____VALUE=") == std::string::npos);
+  CHECK(res.output.find("std::conditional_t<std::is_copy_constructible_v<____P____SEQUENCE_T>&&"
+                        "Peregrine::has_cursor<____P____SEQUENCE_T>,____P____SEQUENCE_T,decltype(____P____SEQUENCE)> "
+                        "____P____VALUE=") != std::string::npos);
+}
+
+TEST_CASE("A soa_list is walked by index") {
+  auto res = peregrine::compile("class P:\n    x:int=0\n    const k:int=7\n"
+                                "def f(ps:&soa_list{P})->int:\n    n:int=0\n"
+                                "    for a in ps:\n        for b in ps:\n            n+=a.k\n    return n\n");
+  REQUIRE(res.ok);
+  // a const field is part of every row
+  CHECK(res.output.find("struct ____P____ROW{\nint64_t& ____mem____P____P____x;\n"
+                        "const int64_t ____mem____P____P____k = 7;\n};") != std::string::npos);
+  CHECK(res.output.find("Peregrine::loop_item(____P____VALUE,____P____i,____Pexception_handlers)") !=
+        std::string::npos);
+}
+
+TEST_CASE("Types and functions of the program hide runtime names") {
+  auto res = peregrine::compile("class filter:\n    n:int=0\nenum count:\n    ONE,\n    TWO\n"
+                                "union zip:\n    a:int\n    b:float\ntype span=int\n"
+                                "@pure\ndef sum(a:int, b:int)->int:\n    return a+b\n"
+                                "def main():\n    f:filter=filter()\n    c:count=count.TWO\n    z:zip\n    s:span=sum(1, 2)\n");
+  REQUIRE(res.ok);
+  CHECK(res.output.find("Peregrine::iter") == std::string::npos);
+  CHECK(res.output.find("class ____P____P____main$$$$pefilter") != std::string::npos);
+}
+
+TEST_CASE("Javascript vectors are scoped like the variables") {
+  peregrine::Options options;
+  options.target = peregrine::Target::Js;
+  auto res = peregrine::compile("def f(v:vec{f32,4})->vec{f32,4}:\n    return v+v\n"
+                                "def g(v:int)->int:\n    return v+v\n"
+                                "def h(b:bool)->int:\n    if b:\n        v:vec{f32,4}=vec{f32,4}(1.0)\n"
+                                "    v:int=2\n    return v*v\n",
+                                options);
+  REQUIRE(res.ok);
+  size_t n = 0;
+  for (size_t i = res.output.find("____vec_op(\""); i != std::string::npos; i = res.output.find("____vec_op(\"", i + 1)) {
+    n++;
+  }
+  CHECK(n == 1);
+}
+
+TEST_CASE("Fields are not reordered past the fields their initialisers read") {
+  peregrine::Options options;
+  options.reorder_fields = true;
+  auto res = peregrine::compile("class rec:\n    a:i32=3\n    b:int=a*2\n    c:i8=1\n", options);
+  REQUIRE(res.ok);
+  auto a = res.output.find("____mem____P____P____a = 3");
+  auto b = res.output.find("____mem____P____P____b = ");
+  REQUIRE(a != std::string::npos);
+  REQUIRE(b != std::string::npos);
+  CHECK(a < b);
+
+  res = peregrine::compile("class rec:\n    a:i32=3\n    b:int=2\n    c:i8=1\n", options);
+  REQUIRE(res.ok);
+  CHECK(res.output.find("____mem____P____P____b = 2") < res.output.find("____mem____P____P____a = 3"));
+}
@@ -0,0 +1,89 @@
+#include "doctest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <lexer/lexer.hpp>
+#include <parser/parser.hpp>
+#include <string>
+#include <unistd.h>
+#include <utils/dependencies.hpp>
+
+namespace fs = std::filesystem;
+
+// a directory of modules, removed at the end of the test
+struct Modules {
+  fs::path dir;
+  Modules() {
+    dir = fs::temp_directory_path() / ("peregrine_deps_" + std::to_string(getpid()));
+    fs::create_directories(dir / "pkg");
+  }
+  ~Modules() { fs::remove_all(dir); }
+  void write(const std::string& name, const std::string& source) {
+    std::ofstream(dir / name) << source;
+  }
+  Utils::ImportGraph graph(const std::string& path) {
+    std::ifstream in(path);
+    std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    auto tokens = LEXER(source, path).result();
+    return Utils::ImportGraph(path, Parser::Parser(tokens, path).parse());
+  }
+};
+
+TEST_CASE("The import graph follows imports through other modules") {
+  Modules m;
+  m.write("main.pe", "import pkg.shapes\nimport missing\ndef main():\n    pass\n");
+  m.write("pkg/shapes.pe", "import util\ndef area()->int:\n    return 1\n");
+  m.write("pkg/util.pe", "def f()->int:\n    return 1\n");
+  auto main = (m.dir / "main.pe").string();
+  auto shapes = (m.dir / "pkg/shapes.pe").string();
+  // util is looked up next to shapes.pe
+  auto util = (m.dir / "pkg/util.pe").string();
+
+  auto graph = m.graph(main);
+  auto& modules = graph.modules();
+  REQUIRE(modules.size() == 3);
+  CHECK(modules[0].path == main);
+  CHECK(modules[0].imports == std::vector<std::string>{shapes});
+  CHECK(modules[0].unresolved == std::vector<std::string>{"missing"});
+  CHECK(modules[1].imports == std::vector<std::string>{util});
+  CHECK(modules[2].path == util);
+
+  CHECK(graph.json() == "{\n  \"root\": \"" + main + "\",\n  \"modules\": [\n"
+                        "    {\"path\": \"" + main + "\", \"imports\": [\"" + shapes + "\"], \"unresolved\": [\"missing\"]},\n"
+                        "    {\"path\": \"" + shapes + "\", \"imports\": [\"" + util + "\"], \"unresolved\": []},\n"
+                        "    {\"path\": \"" + util + "\", \"imports\": [], \"unresolved\": []}\n"
+                        "  ]\n}\n");
+  CHECK(graph.dot() == "digraph imports {\n"
+                       "  \"" + main + "\";\n"
+                       "  \"" + main + "\" -> \"" + shapes + "\";\n"
+                       "  \"" + main + "\" -> \"missing\" [style=dashed];\n"
+                       "  \"" + shapes + "\";\n"
+                       "  \"" + shapes + "\" -> \"" + util + "\";\n"
+                       "  \"" + util + "\";\n"
+                       "}\n");
+}
+
+TEST_CASE("A cycle back to the file is one node") {
+  Modules m;
+  m.write("main.pe", "import a\ndef main():\n    pass\n");
+  m.write("a.pe", "import main\n");
+  auto main = (m.dir / "main.pe").string();
+  auto a = (m.dir / "a.pe").string();
+
+  // written the way a user may pass it on the command line
+  auto graph = m.graph((m.dir / "." / "main.pe").string());
+  auto& modules = graph.modules();
+  REQUIRE(modules.size() == 2);
+  CHECK(modules[0].path == main);
+  CHECK(modules[0].imports == std::vector<std::string>{a});
+  CHECK(modules[1].path == a);
+  CHECK(modules[1].imports == std::vector<std::string>{main});
+}
+
+TEST_CASE("Make rules escape what make would read differently") {
+  CHECK(Utils::makeRule("out", {"main.pe"}) == "out: \\\n  main.pe\n");
+  CHECK(Utils::makeRule("my prog", {"a b.pe", "c#1.pe", "$x.pe"}) ==
+        "my\\ prog: \\\n  a\\ b.pe \\\n  c\\#1.pe \\\n  $$x.pe\n"
+        "\nc\\#1.pe:\n"
+        "\n$$x.pe:\n");
+}
@@ -57,3 +57,29 @@ TEST_CASE("Tokenize if-else statements") {
     CHECK(res[10].tkType == tk_colon);
   }
 }
+
+TEST_CASE("Tokenize async functions") {
+  std::vector<Token> res = LEXER("async def f():\n    await g()", "").result();
+
+  CHECK(res[0].tkType == tk_async);
+  CHECK(res[1].tkType == tk_def);
+  CHECK(res[6].tkType == tk_ident);
+  CHECK(res[7].tkType == tk_await);
+  CHECK(res[8].tkType == tk_identifier);
+}
+
+TEST_CASE("Tokenize generators") {
+  std::vector<Token> res = LEXER("def f()->int:\n    yield 1", "").result();
+
+  CHECK(res[7].tkType == tk_ident);
+  CHECK(res[8].tkType == tk_yield);
+  CHECK(res[9].tkType == tk_integer);
+}
+
+TEST_CASE("Tokenize spawn") {
+  std::vector<Token> res = LEXER("scope:\n    spawn f(1)", "").result();
+
+  CHECK(res[0].tkType == tk_scope);
+  CHECK(res[3].tkType == tk_spawn);
+  CHECK(res[4].tkType == tk_identifier);
+}
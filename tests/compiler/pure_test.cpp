@@ -0,0 +1,106 @@
+#include "doctest.h"
+
+#include <api/peregrine.hpp>
+#include <string>
+
+static std::string firstError(const std::string& source) {
+  auto res = peregrine::compile(source);
+  if (res.ok || res.errors.size() == 0) {
+    return "";
+  }
+  return res.errors[0].msg;
+}
+
+static size_t count(const std::string& text, const std::string& what) {
+  size_t n = 0;
+  for (size_t i = text.find(what); i != std::string::npos; i = text.find(what, i + 1)) {
+    n++;
+  }
+  return n;
+}
+
+TEST_CASE("Repeated pure calls are made once") {
+  std::string source = "@pure\ndef g(n:int)->int:\n    return n*2\n"
+                       "def main():\n    x:int=g(3)+g(3)\n    printf(\"%lld\\n\", x)\n";
+  auto res = peregrine::compile(source);
+  REQUIRE(res.ok);
+  CHECK(res.output.find("auto ____P____CSE0=") != std::string::npos);
+  CHECK(res.output.find("(____P____CSE0 + ____P____CSE0)") != std::string::npos);
+
+  SUBCASE("Not when the statement writes") {
+    res = peregrine::compile("@pure\ndef g(n:int)->int:\n    return n*2\n"
+                             "def main():\n    i:int=0\n    x:int=g(i++)+g(i++)\n    printf(\"%lld\\n\", x)\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("____P____CSE") == std::string::npos);
+  }
+
+  SUBCASE("Not when a call is on the right of and/or") {
+    // hoisting f(n-1) would make every call of f recurse
+    res = peregrine::compile("@pure\ndef f(n:int)->bool:\n    return n<=0 or (f(n-1) and f(n-1))\n"
+                             "def main():\n    x:bool=f(3) and f(3)\n    y:bool=f(3) or f(3)\n"
+                             "    printf(\"%d %d\\n\", x, y)\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("____P____CSE") == std::string::npos);
+  }
+
+  SUBCASE("Not in a ternary") {
+    res = peregrine::compile("@pure\ndef g(n:int)->int:\n    return n*2\n"
+                             "def main(b:bool):\n    x:int=g(1) if b else g(1)\n    printf(\"%lld\\n\", x)\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("____P____CSE") == std::string::npos);
+  }
+
+  SUBCASE("Calls on the left of and/or always run") {
+    res = peregrine::compile("@pure\ndef f(n:int)->bool:\n    return n<=0\n"
+                             "def main():\n    x:bool=f(3)==f(3) and f(4)\n    printf(\"%d\\n\", x)\n");
+    REQUIRE(res.ok);
+    CHECK(count(res.output, "auto ____P____CSE") == 1);
+  }
+}
+
+TEST_CASE("What a pure function may not do") {
+  std::string g = "x:int=1\n";
+  CHECK(firstError(g + "@pure\ndef f()->int:\n    x=2\n    return 1\n") ==
+        "Error: A @pure function can't change the global variable 'x'");
+  CHECK(firstError("@pure\ndef f(p:*int)->int:\n    *p=2\n    return 1\n") ==
+        "Error: A @pure function can't write through a pointer");
+  CHECK(firstError("@pure\ndef f()->int:\n    printf(\"hi\")\n    return 1\n") ==
+        "Error: A @pure function can't print");
+  CHECK(firstError("def h()->int:\n    return 1\n@pure\ndef f()->int:\n    return h()\n") ==
+        "Error: A @pure function can't call 'h'");
+  CHECK(firstError("@pure\ndef h()->int:\n    return 1\n@const\ndef f()->int:\n    return h()\n") ==
+        "Error: A @const function can't call 'h'");
+  CHECK(firstError(g + "@const\ndef f()->int:\n    return x\n") ==
+        "Error: A @const function can't read the global variable 'x'");
+  CHECK(firstError("@const\ndef f(p:*int)->int:\n    return 1\n") ==
+        "Error: A @const function can't take pointers");
+  CHECK(firstError("@pure\n@const\ndef f()->int:\n    return 1\n") ==
+        "Error: A function is either @pure or @const");
+
+  SUBCASE("Functions that are not known to be pure") {
+    std::string c = "extern c=import(\"stdlib.h\")\ndef c.rand()->int\n";
+    CHECK(firstError(c + "@pure\ndef f()->int:\n    return c.rand()\n") ==
+          "Error: A @pure function can't call the extern function 'c.rand()'");
+    CHECK(firstError("@pure\ndef f(x:float)->float:\n    return sqrt(x)\n") ==
+          "Error: A @pure function can't call 'sqrt'");
+    CHECK(firstError("import math\n@const\ndef f()->int:\n    return math.floor(2)\n") ==
+          "Error: A @const function can't call 'math.floor(2)'");
+    CHECK(firstError("import shapes as s\n@pure\ndef f()->int:\n    return s.area()\n") ==
+          "Error: A @pure function can't call 's.area()'");
+  }
+
+  SUBCASE("Its own locals and parameters are fine") {
+    CHECK(firstError(g + "@pure\ndef f(n:int)->int:\n    y:int=n\n    y+=x\n    n=y\n    return n\n") == "");
+    CHECK(firstError("@const\ndef f(n:int)->int:\n    return n*2\n@pure\ndef h()->int:\n    return f(2)\n") == "");
+    CHECK(firstError("class P:\n    x:int=0\n    def me(self)->P:\n        return self\n"
+                     "    def get(self)->int:\n        return self.x\n"
+                     "@pure\ndef f(n:int)->int:\n    def g(m:int)->int:\n        return m+1\n"
+                     "    p:P=P()\n    return g(p.me().get())+(range(n) |> sum)\n") == "");
+  }
+}
+
+TEST_CASE("Only pointer parameters can be @noalias") {
+  CHECK(firstError("def f(@noalias x:int)->int:\n    return x\n") ==
+        "Error: Only pointer parameters can be @noalias");
+  CHECK(firstError("def f(@noalias x:*int, @noalias y:*int):\n    *x=*y\n") == "");
+}
@@ -0,0 +1,112 @@
+#include "doctest.h"
+
+#include <algorithm>
+#include <api/peregrine.hpp>
+#include <string>
+#include <vector>
+
+// the definition of the function is one of them
+static size_t calls(const std::string& output, const std::string& function) {
+  auto name = "____P____P____main$$$$pe" + function + "(";
+  size_t n = 0;
+  for (size_t i = output.find(name); i != std::string::npos; i = output.find(name, i + 1)) {
+    n++;
+  }
+  return n;
+}
+
+static std::vector<std::string> errors(const std::string& source) {
+  std::vector<std::string> res;
+  for (auto& e : peregrine::compile(source).errors) {
+    res.push_back(e.msg);
+  }
+  return res;
+}
+
+TEST_CASE("Tail calls become a loop") {
+  SUBCASE("In every arm of an if") {
+    auto res = peregrine::compile("def gcd(a:int, b:int)->int:\n    if b==0:\n        return a\n"
+                                  "    elif a<b:\n        return gcd(b, a)\n    else:\n        return gcd(b, a%b)\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "gcd") == 1);
+    CHECK(res.output.find("while (true)") != std::string::npos);
+    // the arguments are evaluated before a parameter changes
+    CHECK(res.output.find("auto _____P____temp____0=____P____P____b;auto _____P____temp____1=____P____P____a;"
+                          "____P____P____a=_____P____temp____0;____P____P____b=_____P____temp____1;") !=
+          std::string::npos);
+  }
+
+  SUBCASE("A void function that calls itself last") {
+    auto res = peregrine::compile("def down(n:int):\n    if n<=0:\n        return\n    printf(\"%lld\\n\", n)\n"
+                                  "    down(n-1)\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "down") == 1);
+    CHECK(res.output.find("continue;") != std::string::npos);
+  }
+
+  SUBCASE("A void call followed by a bare return") {
+    auto res = peregrine::compile("def down(n:int):\n    if n>0:\n        down(n-1)\n        return\n"
+                                  "    printf(\"done\\n\")\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "down") == 1);
+  }
+
+  SUBCASE("Missing arguments take the default") {
+    auto res = peregrine::compile("def sum(n:int, acc:int=0)->int:\n    if n==0:\n        return acc\n"
+                                  "    return sum(n-1)\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "sum") == 1);
+    CHECK(res.output.find("auto _____P____temp____1=0;") != std::string::npos);
+  }
+}
+
+TEST_CASE("Calls that are left alone") {
+  SUBCASE("Not in a tail position") {
+    auto res = peregrine::compile("def fact(n:int)->int:\n    if n<2:\n        return 1\n    return n*fact(n-1)\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "fact") == 2);
+    CHECK(res.output.find("while (true)") == std::string::npos);
+  }
+
+  SUBCASE("Inside a loop") {
+    auto res = peregrine::compile("def f(n:int)->int:\n    while n>0:\n        return f(n-1)\n    return 0\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "f") == 2);
+  }
+
+  SUBCASE("A reference parameter") {
+    auto res = peregrine::compile("def f(n:&int)->int:\n    if n==0:\n        return 0\n    n-=1\n    return f(n)\n");
+    REQUIRE(res.ok);
+    CHECK(calls(res.output, "f") == 2);
+  }
+
+  SUBCASE("A @cache function") {
+    auto res = peregrine::compile("@cache\ndef f(n:int)->int:\n    if n==0:\n        return 0\n    return f(n-1)\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("while (true)") == std::string::npos);
+  }
+
+  SUBCASE("Functions that define functions") {
+    auto res = peregrine::compile("def f(n:int)->int:\n    def g()->int:\n        return n\n"
+                                  "    if n==0:\n        return g()\n    return f(n-1)\n");
+    REQUIRE(res.ok);
+    CHECK(res.output.find("while (true)") == std::string::npos);
+  }
+}
+
+TEST_CASE("@tailrec is checked") {
+  CHECK(errors("@tailrec\ndef f(n:int)->int:\n    if n==0:\n        return 0\n    return f(n-1)\n").empty());
+  CHECK(errors("@tailrec\ndef f(n:int)->int:\n    return n\n") ==
+        std::vector<std::string>{"Error: The @tailrec function f has no tail call of itself"});
+  auto none = errors("@tailrec\ndef f(n:int)->int:\n    if n<2:\n        return 1\n    return n*f(n-1)\n");
+  CHECK(std::count(none.begin(), none.end(), "Error: This call of the @tailrec function f is not a tail call") == 1);
+  CHECK(std::count(none.begin(), none.end(), "Error: The @tailrec function f has no tail call of itself") == 1);
+  CHECK(errors("@tailrec\ndef f(n:int)->int:\n    if n==0:\n        return 0\n    x:int=f(0)\n    return f(n-1)\n") ==
+        std::vector<std::string>{"Error: This call of the @tailrec function f is not a tail call"});
+  CHECK(errors("@tailrec\ndef f(n:&int)->int:\n    return f(n)\n") ==
+        std::vector<std::string>{"Error: The @tailrec function f can't become a loop because its parameter n is a reference"});
+  CHECK(errors("@tailrec\ndef f(*n)->int:\n    return f(n)\n") ==
+        std::vector<std::string>{"Error: The @tailrec function f can't become a loop because it takes a variable number of arguments"});
+  auto cached = errors("@tailrec\n@cache\ndef f(n:int)->int:\n    return f(n-1)\n");
+  CHECK(std::count(cached.begin(), cached.end(), "Error: A @cache function can't be @tailrec") == 1);
+}
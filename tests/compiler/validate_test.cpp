@@ -0,0 +1,84 @@
+#include "doctest.h"
+
+#include <algorithm>
+#include <api/peregrine.hpp>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> errors(const std::string& source) {
+  std::vector<std::string> res;
+  for (auto& e : peregrine::compile(source).errors) {
+    res.push_back(e.msg);
+  }
+  return res;
+}
+
+TEST_CASE("Channels and atomics are shared, not copied") {
+  CHECK(errors("def f(ch:channel{int}):\n    ch.close()\n") ==
+        std::vector<std::string>{"TypeError: The channel ch can't be passed by value"});
+  CHECK(errors("def f(a:atomic{int}):\n    a.store(1)\n") ==
+        std::vector<std::string>{"TypeError: The atomic a can't be passed by value"});
+  CHECK(errors("def f(ch:*channel{int}, r:&spsc_channel{int}, a:&atomic{int}):\n"
+               "    ch->close()\n    r.close()\n    a.store(1)\n")
+            .empty());
+}
+
+TEST_CASE("The methods of channels and atomics") {
+  std::string channel = "def main():\n    ch:channel{int}=channel{int}(16)\n";
+  CHECK(errors(channel + "    ch.send(1)\n    x:int=ch.receive()\n    ch.try_receive(&x)\n"
+                         "    ch.close()\n")
+            .empty());
+  CHECK(errors(channel + "    ch.push(1)\n") ==
+        std::vector<std::string>{"TypeError: push is not a method of channel{int}"});
+  CHECK(errors(channel + "    ch.send(\"x\")\n") ==
+        std::vector<std::string>{"TypeError: send of channel{int} can't take \"x\""});
+  CHECK(errors(channel + "    ch.try_receive(3)\n") ==
+        std::vector<std::string>{"TypeError: try_receive of channel{int} can't take 3"});
+  CHECK(errors(channel + "    ch.send(1, 2)\n") ==
+        std::vector<std::string>{"TypeError: send takes 1 arguments, 2 were given"});
+
+  SUBCASE("The type comes from the constructor too") {
+    CHECK(errors("def main():\n    a=atomic{int}(0)\n    a.fetch_add(1.5)\n") ==
+          std::vector<std::string>{"TypeError: fetch_add of atomic{int} can't take 1.5"});
+    CHECK(errors("def main():\n    a=atomic{f32}(0)\n") ==
+          std::vector<std::string>{"TypeError: atomic only holds integers and pointers"});
+  }
+
+  SUBCASE("Parameters") {
+    CHECK(errors("def f(ch:&channel{str}):\n    ch.send(1)\n") ==
+          std::vector<std::string>{"TypeError: send of channel{str} can't take 1"});
+    CHECK(errors("def f(ch:&channel{float}):\n    ch.send(1)\n").empty());
+  }
+
+  SUBCASE("A local hides a channel of the same name") {
+    std::string global = "ch:channel{int}=channel{int}(16)\n";
+    CHECK(errors(global + "def f(ch:Stack):\n    ch.push(1)\n").empty());
+    CHECK(errors(global + "def f():\n    ch:Stack=Stack()\n    ch.push(1)\n").empty());
+    CHECK(errors(global + "def f():\n    ch.push(1)\n") ==
+          std::vector<std::string>{"TypeError: push is not a method of channel{int}"});
+  }
+}
+
+TEST_CASE("Function attributes are only for global functions") {
+  for (std::string attribute : {"pure", "const", "hot", "cold", "tailrec", "cache", "target_clones(\"avx2\",\"default\")"}) {
+    auto error = "Error: @" + attribute.substr(0, attribute.find('(')) +
+                 " can only be used on functions defined at the global scope";
+    auto method = errors("class A:\n    x:int=0\n    @" + attribute + "\n    def f(self, n:int)->int:\n        return n\n");
+    CHECK(std::count(method.begin(), method.end(), error) == 1);
+    auto nested = errors("def g()->int:\n    @" + attribute + "\n    def f(n:int)->int:\n        return n\n    return f(1)\n");
+    CHECK(std::count(nested.begin(), nested.end(), error) == 1);
+  }
+  CHECK(errors("@hot\ndef f(n:int)->int:\n    return n\n").empty());
+}
+
+TEST_CASE("likely and unlikely take one condition") {
+  CHECK(errors("def f(x:int)->int:\n    if likely(x>0):\n        return 1\n    return 0\n").empty());
+  CHECK(errors("def f(x:int)->int:\n    if likely():\n        return 1\n    return 0\n") ==
+        std::vector<std::string>{"Error: likely takes exactly one argument, 0 were given"});
+  CHECK(errors("def f(x:int)->int:\n    if unlikely(x>0, x<9):\n        return 1\n    return 0\n") ==
+        std::vector<std::string>{"Error: unlikely takes exactly one argument, 2 were given"});
+  // unless a function of that name hides them
+  CHECK(errors("def likely(a:int, b:int)->bool:\n    return a<b\ndef f(x:int)->int:\n"
+               "    if likely(x, 9):\n        return 1\n    return 0\n")
+            .empty());
+}
@@ -0,0 +1,87 @@
+#include "doctest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <channel.hpp>
+
+TEST_SUITE_BEGIN("Alloc");
+
+TEST_CASE("Allocations are recorded at the site that made them") {
+    Peregrine::alloc_site = 10;
+    auto small = Peregrine::allocate<int64_t>(4);
+    Peregrine::alloc_site = 11;
+    auto grown = Peregrine::allocate<int64_t>(8, true);
+    Peregrine::deallocate(small, 4, 4);
+    Peregrine::deallocate(grown, 8, 5);
+
+    auto first = Peregrine::profiler().stats(10);
+    CHECK(first.count == 1);
+    CHECK(first.bytes == 32);
+    CHECK(first.growths == 0);
+    CHECK(first.wasted == 0);
+    // the block is charged to the site that made it, not the one that frees it
+    auto second = Peregrine::profiler().stats(11);
+    CHECK(second.count == 1);
+    CHECK(second.bytes == 64);
+    CHECK(second.growths == 1);
+    CHECK(second.wasted == 24);
+    CHECK(second.live == 0);
+}
+
+TEST_CASE("Blocks that are not freed are live") {
+    Peregrine::alloc_site = 30;
+    auto block = Peregrine::allocate<int32_t>(8);
+    auto stats = Peregrine::profiler().stats(30);
+    CHECK(stats.live == 32);
+    // nothing is known about how much of it is used
+    CHECK(stats.wasted == 0);
+    Peregrine::deallocate(block, 8, 2);
+    stats = Peregrine::profiler().stats(30);
+    CHECK(stats.live == 0);
+    CHECK(stats.wasted == 24);
+}
+
+TEST_CASE("The buffer of a channel is recorded") {
+    Peregrine::alloc_site = 20;
+    {
+        Peregrine::channel<int64_t> ch(16);
+        Peregrine::spsc_channel<int64_t> spsc(16);
+    }
+    auto stats = Peregrine::profiler().stats(20);
+    CHECK(stats.count == 2);
+    CHECK(stats.bytes >= 2 * 16 * sizeof(int64_t));
+    CHECK(stats.wasted == 0);
+}
+
+TEST_CASE("The report lists the sites with the most bytes first") {
+    char* text = nullptr;
+    size_t size = 0;
+    FILE* out = open_memstream(&text, &size);
+    Peregrine::profiler().report(out);
+    fclose(out);
+    std::string report(text, size);
+    free(text);
+
+    CHECK(report.find("Peregrine allocation profile") != std::string::npos);
+    CHECK(report.find("wasted bytes") != std::string::npos);
+    CHECK(report.find("live bytes") != std::string::npos);
+    auto channels = report.find("\n20 ");
+    auto grown = report.find("\n11 ");
+    auto small = report.find("\n10 ");
+    REQUIRE(channels != std::string::npos);
+    REQUIRE(grown != std::string::npos);
+    REQUIRE(small != std::string::npos);
+    CHECK(channels < grown);
+    CHECK(grown < small);
+    auto line = report.substr(grown + 1, report.find('\n', grown + 1) - grown - 1);
+    unsigned site;
+    unsigned long long count, bytes, growths, wasted, live;
+    REQUIRE(sscanf(line.c_str(), "%u %llu %llu %llu %llu %llu", &site, &count, &bytes, &growths, &wasted, &live) == 6);
+    CHECK(bytes == 64);
+    CHECK(growths == 1);
+    CHECK(wasted == 24);
+    CHECK(live == 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,126 @@
+#include "doctest.h"
+
+#include <string>
+#include <vector>
+#include <async.hpp>
+
+static Peregrine::task<int64_t> send_all(int64_t fd, std::string data) {
+    int64_t res = co_await Peregrine::write(fd, data.data(), data.size());
+    Peregrine::close(fd);
+    co_return res;
+}
+
+static Peregrine::task<std::string> receive_all(int64_t fd) {
+    std::string res;
+    char buf[7];
+    while (true) {
+        int64_t n = co_await Peregrine::read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        res.append(buf, n);
+    }
+    Peregrine::close(fd);
+    co_return res;
+}
+
+static Peregrine::task<void> sleeper(std::vector<int>& order, int id, int64_t ms) {
+    co_await Peregrine::sleep(ms);
+    order.push_back(id);
+}
+
+static Peregrine::task<void> echo(int64_t server) {
+    int64_t conn = co_await Peregrine::accept(server);
+    char buf[64];
+    int64_t n = co_await Peregrine::read(conn, buf, sizeof(buf));
+    co_await Peregrine::write(conn, buf, n);
+    Peregrine::close(conn);
+}
+
+static Peregrine::task<std::string> ask(int64_t port, std::string question) {
+    int64_t sock = co_await Peregrine::connect("127.0.0.1", port);
+    if (sock < 0) {
+        co_return "";
+    }
+    co_await Peregrine::write(sock, question.data(), question.size());
+    co_return co_await receive_all(sock);
+}
+
+TEST_SUITE_BEGIN("Async runtime");
+
+TEST_CASE("Tasks return their value") {
+    auto answer = []() -> Peregrine::task<int64_t> { co_return 42; };
+    CHECK(Peregrine::run(answer()) == 42);
+}
+
+TEST_CASE("Timers fire in the order of their deadlines") {
+    std::vector<int> order;
+    auto all = [&]() -> Peregrine::task<void> {
+        Peregrine::spawn(sleeper(order, 3, 30));
+        Peregrine::spawn(sleeper(order, 1, 10));
+        Peregrine::spawn(sleeper(order, 2, 20));
+        co_await Peregrine::sleep(50);
+    };
+    Peregrine::run(all());
+    CHECK((order == std::vector<int>{1, 2, 3}));
+}
+
+TEST_CASE("Data larger than the pipe buffer goes through a pipe") {
+    int64_t r, w;
+    REQUIRE(Peregrine::pipe(&r, &w) == 0);
+    std::string data(1 << 20, 'x');
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = 'a' + i % 26;
+    }
+    auto both = [&]() -> Peregrine::task<std::string> {
+        Peregrine::spawn(send_all(w, data));
+        co_return co_await receive_all(r);
+    };
+    CHECK(Peregrine::run(both()) == data);
+}
+
+TEST_CASE("Many pipes are served at the same time") {
+    const int count = 500;
+    std::vector<std::string> received(count);
+    auto all = [&]() -> Peregrine::task<void> {
+        std::vector<Peregrine::task<std::string>> readers;
+        for (int i = 0; i < count; i++) {
+            int64_t r, w;
+            if (Peregrine::pipe(&r, &w) != 0) {
+                co_return;
+            }
+            Peregrine::spawn(send_all(w, std::to_string(i)));
+            readers.push_back(receive_all(r));
+        }
+        for (int i = 0; i < count; i++) {
+            received[i] = co_await std::move(readers[i]);
+        }
+    };
+    Peregrine::run(all());
+    for (int i = 0; i < count; i++) {
+        CHECK(received[i] == std::to_string(i));
+    }
+}
+
+TEST_CASE("Echo over a loopback socket") {
+    int64_t server = Peregrine::listen("127.0.0.1", 0);
+    REQUIRE(server >= 0);
+    int64_t port = Peregrine::local_port(server);
+    REQUIRE(port > 0);
+    auto client = [&]() -> Peregrine::task<std::string> {
+        Peregrine::spawn(echo(server));
+        co_return co_await ask(port, "ping");
+    };
+    CHECK(Peregrine::run(client()) == "ping");
+    Peregrine::close(server);
+}
+
+TEST_CASE("Connecting to a closed port fails") {
+    int64_t server = Peregrine::listen("127.0.0.1", 0);
+    int64_t port = Peregrine::local_port(server);
+    Peregrine::close(server);
+    auto client = [&]() -> Peregrine::task<int64_t> { co_return co_await Peregrine::connect("127.0.0.1", port); };
+    CHECK(Peregrine::run(client()) == -1);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,73 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cache.hpp>
+
+TEST_SUITE_BEGIN("Cache");
+
+TEST_CASE("Values are computed once per key") {
+    Peregrine::cache<int64_t(int64_t, int64_t)> cache;
+    int64_t calls = 0;
+    for (int64_t round = 0; round < 2; ++round) {
+        for (int64_t i = 0; i < 1000; ++i) {
+            auto value = cache.get({i, i % 7}, [&] {
+                ++calls;
+                return i * 10 + i % 7;
+            });
+            CHECK(value == i * 10 + i % 7);
+        }
+    }
+    CHECK(calls == 1000);
+    CHECK(cache.size() == 1000);
+}
+
+TEST_CASE("Recursive calls can fill the cache while a value is computed") {
+    static Peregrine::cache<int64_t(int64_t)> cache;
+    struct fib {
+        static int64_t of(int64_t n) {
+            return cache.get({n}, [&]() -> int64_t {
+                return n < 2 ? n : of(n - 1) + of(n - 2);
+            });
+        }
+    };
+    CHECK(fib::of(90) == 2880067194370816120);
+    CHECK(cache.size() == 91);
+}
+
+TEST_CASE("Floats are compared by their bits") {
+    Peregrine::cache<double(double)> cache;
+    int64_t calls = 0;
+    auto f = [&](double x) { return cache.get({x}, [&] { ++calls; return x; }); };
+    f(NAN);
+    f(NAN);
+    f(0.0);
+    f(-0.0);
+    CHECK(calls == 3);
+}
+
+TEST_CASE("The least recently used entry is replaced") {
+    Peregrine::cache<int64_t(int64_t)> cache(3);
+    int64_t calls = 0;
+    auto f = [&](int64_t x) { return cache.get({x}, [&] { ++calls; return x * x; }); };
+    f(1);
+    f(2);
+    f(3);
+    f(1);  // 2 is now the oldest
+    f(4);
+    CHECK(calls == 4);
+    CHECK(cache.size() == 3);
+    f(1);
+    f(3);
+    f(4);
+    CHECK(calls == 4);
+    CHECK(f(2) == 4);
+    CHECK(calls == 5);
+
+    for (int64_t i = 0; i < 10000; ++i) {
+        CHECK(f(i % 5) == (i % 5) * (i % 5));
+    }
+    CHECK(cache.size() == 3);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,102 @@
+#include "doctest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <channel.hpp>
+
+TEST_SUITE_BEGIN("Channels");
+
+TEST_CASE("Single producer channel keeps the order") {
+    Peregrine::spsc_channel<int64_t> ch(16);
+    const int64_t n = 200000;
+    std::thread producer([&] {
+        for (int64_t i = 0; i < n; ++i) {
+            ch.____mem____P____P____send(i);
+        }
+        ch.____mem____P____P____close();
+    });
+    int64_t expected = 0;
+    bool ordered = true;
+    while (ch.____mem____P____P______iter__()) {
+        ordered = ordered && ch.____mem____P____P______iterate__() == expected;
+        ++expected;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(expected == n);
+    CHECK_FALSE(ch.____mem____P____P____send(1));
+}
+
+TEST_CASE("Many producers and consumers") {
+    Peregrine::channel<int64_t> ch(64);
+    Peregrine::atomic<int64_t> total(0);
+    Peregrine::atomic<int64_t> received;
+    const int64_t per_producer = 100000;
+    std::vector<std::thread> producers, consumers;
+    for (int64_t p = 0; p < 4; ++p) {
+        producers.emplace_back([&] {
+            for (int64_t i = 1; i <= per_producer; ++i) {
+                ch.____mem____P____P____send(i);
+            }
+        });
+    }
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&] {
+            while (ch.____mem____P____P______iter__()) {
+                total.____mem____P____P____fetch_add(ch.____mem____P____P______iterate__());
+                received.____mem____P____P____fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    ch.____mem____P____P____close();
+    for (auto& t : consumers) {
+        t.join();
+    }
+    CHECK(received.____mem____P____P____load() == 4 * per_producer);
+    CHECK(total.____mem____P____P____load() == 4 * per_producer * (per_producer + 1) / 2);
+}
+
+TEST_CASE("Non blocking operations") {
+    Peregrine::channel<int64_t> ch(2);
+    CHECK(ch.____mem____P____P____capacity() == 2);
+    CHECK(ch.____mem____P____P____try_send(1));
+    CHECK(ch.____mem____P____P____try_send(2));
+    CHECK_FALSE(ch.____mem____P____P____try_send(3));
+    int64_t value = 0;
+    CHECK(ch.____mem____P____P____try_receive(&value));
+    CHECK(value == 1);
+    ch.____mem____P____P____close();
+    CHECK(ch.____mem____P____P____receive() == 2);
+    CHECK(ch.____mem____P____P____receive() == 0);
+    CHECK_FALSE(ch.____mem____P____P____try_receive(&value));
+}
+
+TEST_CASE("Close wakes blocked receivers") {
+    Peregrine::channel<int64_t> ch(4);
+    std::thread receiver([&] { ch.____mem____P____P____receive(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ch.____mem____P____P____close();
+    receiver.join();
+    CHECK(ch.____mem____P____P____closed());
+}
+
+TEST_CASE("Atomics") {
+    int64_t a = 1, b = 2;
+    Peregrine::atomic<int64_t*> ptr(&a);
+    CHECK_FALSE(ptr.____mem____P____P____compare_exchange(&b, &a));
+    CHECK(ptr.____mem____P____P____compare_exchange(&a, &b));
+    CHECK(ptr.____mem____P____P____load() == &b);
+
+    Peregrine::atomic<int64_t> n(5);
+    CHECK(n.____mem____P____P____exchange(7) == 5);
+    CHECK(n.____mem____P____P____fetch_sub(2) == 7);
+    n.____mem____P____P____store(1);
+    CHECK(n.____mem____P____P____load() == 1);
+}
+
+TEST_SUITE_END();
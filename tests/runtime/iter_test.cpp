@@ -0,0 +1,44 @@
+#include "doctest.h"
+
+#include <cstdint>
+#include <vector>
+#include <iter.hpp>
+
+static int64_t square(int64_t x, std::nullptr_t) { return x * x; }
+static bool odd(int64_t x, std::nullptr_t) { return x % 2 == 1; }
+static int64_t weighted(int64_t acc, int64_t i, int64_t x, std::nullptr_t) { return acc + i * x; }
+
+// counts to n through the for loop protocol, like a compiled generator
+struct counter {
+    int64_t n;
+    int64_t current = -1;
+    size_t ____mem____P____P______iter__(std::nullptr_t) { return ++current < n ? SIZE_MAX : 0; }
+    int64_t ____mem____P____P______iterate__(std::nullptr_t) { return current; }
+};
+
+TEST_SUITE_BEGIN("Iterators");
+
+TEST_CASE("Iterator stages are lazy views") {
+    using namespace Peregrine::iter;
+    auto squares = map(range(10, nullptr), square, nullptr);
+    CHECK(sum(squares, nullptr) == 285);
+    CHECK(sum(filter(range(10, nullptr), odd, nullptr), nullptr) == 25);
+    CHECK(count(take(range(3, 1000000000, nullptr), 4, nullptr), nullptr) == 4);
+    CHECK(count(take(range(2, nullptr), 4, nullptr), nullptr) == 2);
+
+    std::vector<int64_t> data = {5, 6, 7};
+    CHECK(reduce(enumerate(span(data.data(), 3, nullptr), nullptr), weighted, int64_t(0), nullptr) == 20);
+    CHECK(reduce(zip(counter{3}, range(10, 20, nullptr), nullptr), weighted, int64_t(1), nullptr) == 1 + 11 + 24);
+}
+
+TEST_CASE("Iterator stages can be used by for loops") {
+    using namespace Peregrine::iter;
+    auto odds = filter(counter{10}, odd, nullptr);
+    std::vector<int64_t> seen;
+    for (size_t i = 0; i < odds.____mem____P____P______iter__(nullptr); ++i) {
+        seen.push_back(odds.____mem____P____P______iterate__(nullptr));
+    }
+    CHECK((seen == std::vector<int64_t>{1, 3, 5, 7, 9}));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,74 @@
+#include "doctest.h"
+
+#include <cstdint>
+#include <functional>
+#include <setjmp.h>
+#include <channel.hpp>
+#include <scope.hpp>
+
+// what the generated code defines after the runtime headers
+struct handler {
+    jmp_buf* buf;
+    std::function<void(void)> handler;
+    int err;
+};
+
+static void add(int64_t i, Peregrine::atomic<int64_t>& total, handler* handlers) {
+    if (i == 3) {
+        handlers->err = 7;
+        longjmp(*handlers->buf, 1);
+    }
+    total.____mem____P____P____fetch_add(i);
+}
+
+TEST_SUITE_BEGIN("Scopes");
+
+TEST_CASE("A scope joins its tasks") {
+    Peregrine::atomic<int64_t> total(0);
+    handler* error;
+    {
+        Peregrine::scope<handler> scope;
+        for (int64_t i = 4; i < 100; ++i) {
+            scope.spawn([i, arg = Peregrine::spawn_arg(total)](handler* h) mutable { add(i, arg, h); });
+        }
+        error = scope.join();
+    }
+    CHECK(error == nullptr);
+    CHECK(total.____mem____P____P____load() == 4950 - 6);
+}
+
+TEST_CASE("The first error of a task is kept") {
+    Peregrine::atomic<int64_t> total(0);
+    Peregrine::scope<handler> scope;
+    for (int64_t i = 0; i < 10; ++i) {
+        scope.spawn([i, &total](handler* h) { add(i, total, h); });
+    }
+    handler* error = scope.join();
+    REQUIRE(error != nullptr);
+    CHECK(error->err == 7);
+    CHECK(total.____mem____P____P____load() == 45 - 3);
+}
+
+static void produce(Peregrine::channel<int64_t>& ch, int64_t n, handler*) {
+    for (int64_t i = 0; i < n; ++i) {
+        ch.____mem____P____P____send(i);
+    }
+    ch.____mem____P____P____close();
+}
+
+// also run with PEREGRINE_THREADS=1, where the pool has no worker for loops
+TEST_CASE("A task can feed a channel that the scope reads") {
+    Peregrine::channel<int64_t> ch(16);
+    int64_t total = 0;
+    {
+        Peregrine::scope<handler> scope;
+        scope.spawn([arg = Peregrine::spawn_arg(ch)](handler* h) mutable { produce(arg, 1000, h); });
+        while (ch.____mem____P____P______iter__()) {
+            total += ch.____mem____P____P______iterate__();
+        }
+        CHECK(scope.join() == nullptr);
+    }
+    CHECK(total == 499500);
+}
+
+TEST_SUITE_END();
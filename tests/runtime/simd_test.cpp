@@ -0,0 +1,73 @@
+#include "doctest.h"
+
+#include <cstdint>
+#include <simd.hpp>
+#include <soa.hpp>
+
+TEST_SUITE_BEGIN("Vectors");
+
+TEST_CASE("Element wise operators and reductions") {
+    Peregrine::vec<float, 8> a(1.0f);
+    Peregrine::vec<float, 8> b(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f);
+    auto c = a + b * 2.0f;
+    CHECK(c.____mem____P____P____sum() == 80.0f);
+    CHECK(c.____mem____P____P____min() == 3.0f);
+    CHECK(c.____mem____P____P____max() == 17.0f);
+    CHECK((-c)[7] == -17.0f);
+
+    Peregrine::vec<int32_t, 4> x(7), y(1, 2, 3, 4);
+    auto z = (x % y) << 1;
+    CHECK(z[2] == 2);
+    CHECK((~x)[0] == -8);
+    CHECK(x.____mem____P____P____len() == 4);
+}
+
+TEST_CASE("Comparisons give masks") {
+    Peregrine::vec<float, 8> b(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f);
+    auto m = b > 4.0f;
+    CHECK(m[0] == 0);
+    CHECK(m[7] == -1);
+    CHECK(m.____mem____P____P____any());
+    CHECK_FALSE(m.____mem____P____P____all());
+    auto s = m.____mem____P____P____select(b, -b);
+    CHECK(s[0] == -1.0f);
+    CHECK(s[7] == 8.0f);
+}
+
+TEST_CASE("Shuffles") {
+    Peregrine::vec<float, 8> b(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f);
+    Peregrine::vec<int32_t, 8> idx(7, 6, 5, 4, 3, 2, 1, 0);
+    auto r = b.____mem____P____P____shuffle(idx);
+    CHECK(r[0] == 8.0f);
+    CHECK(r.____mem____P____P____reverse()[0] == 1.0f);
+
+    Peregrine::vec<double, 4> d(1, 2, 3, 4);
+    Peregrine::vec<int64_t, 4> di(3, 3, 0, 0);
+    CHECK(d.____mem____P____P____shuffle(di)[1] == 4.0);
+}
+
+TEST_CASE("Loads and stores") {
+    float data[16];
+    for (int i = 0; i < 16; ++i) {
+        data[i] = float(i);
+    }
+    Peregrine::vec<float, 8> v;
+    v.____mem____P____P____load(data, 8);
+    CHECK(v.____mem____P____P____sum() == 92.0f);
+    v.____mem____P____P______getitem__(0) = 100.0f;
+    v.____mem____P____P____store(data, 0);
+    CHECK(data[0] == 100.0f);
+    CHECK(data[7] == 15.0f);
+
+    Peregrine::column<int32_t> column;
+    for (int32_t i = 0; i < 8; ++i) {
+        column.push(i);
+    }
+    Peregrine::vec<int32_t, 4> w;
+    w.____mem____P____P____load(column, 4);
+    CHECK(w[0] == 4);
+    (w * 2).____mem____P____P____store(column, 0);
+    CHECK(column[3] == 14);
+}
+
+TEST_SUITE_END();
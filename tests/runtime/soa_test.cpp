@@ -0,0 +1,93 @@
+#include "doctest.h"
+
+#include <cstdint>
+#include <generator.hpp>
+#include <soa.hpp>
+
+// what the backend emits for
+// class Particle:
+//     x:float
+//     alive:bool
+struct Particle {
+    double ____mem____P____P____x = 0.0;
+    bool ____mem____P____P____alive = true;
+    template <template <typename> class ____P____COLUMN>
+    struct ____P____SOA {
+        ____P____COLUMN<double> ____mem____P____P____x;
+        ____P____COLUMN<bool> ____mem____P____P____alive;
+        struct ____P____ROW {
+            double& ____mem____P____P____x;
+            bool& ____mem____P____P____alive;
+        };
+        void ____P____push(const Particle& value) {
+            ____mem____P____P____x.push(value.____mem____P____P____x);
+            ____mem____P____P____alive.push(value.____mem____P____P____alive);
+        }
+        void ____P____reserve(size_t capacity) {
+            ____mem____P____P____x.reserve(capacity);
+            ____mem____P____P____alive.reserve(capacity);
+        }
+        void ____P____clear() {
+            ____mem____P____P____x.clear();
+            ____mem____P____P____alive.clear();
+        }
+        ____P____ROW ____P____row(size_t index) {
+            return {____mem____P____P____x[index], ____mem____P____P____alive[index]};
+        }
+    };
+};
+
+TEST_SUITE_BEGIN("Struct of arrays");
+
+TEST_CASE("Fields are stored in columns") {
+    Peregrine::soa_list<Particle> ps;
+    for (int i = 0; i < 100; ++i) {
+        Particle p;
+        p.____mem____P____P____x = i;
+        ps.____mem____P____P____append(p);
+    }
+    CHECK(ps.____mem____P____P____len() == 100);
+    CHECK(ps.____mem____P____P____x.____mem____P____P______len__() == 100);
+    double* xs = ps.____mem____P____P____x.data();
+    CHECK(&xs[1] - &xs[0] == 1);
+    CHECK(xs[42] == 42.0);
+}
+
+TEST_CASE("Rows refer to the columns") {
+    Peregrine::soa_list<Particle> ps;
+    ps.____mem____P____P____append(Particle());
+    ps.____mem____P____P____append(Particle());
+    ps.____mem____P____P______getitem__(1).____mem____P____P____alive = false;
+    ps.____mem____P____P______getitem__(0).____mem____P____P____x = 3.5;
+    CHECK_FALSE(ps.____mem____P____P____alive.____mem____P____P______getitem__(1));
+    CHECK(ps.____mem____P____P____x.____mem____P____P______getitem__(0) == 3.5);
+}
+
+TEST_CASE("Loops over a list keep their own position") {
+    Peregrine::soa_list<Particle> ps;
+    for (int i = 1; i <= 4; ++i) {
+        Particle p;
+        p.____mem____P____P____x = i;
+        ps.____mem____P____P____append(p);
+    }
+    // what for a in ps: for b in ps: generates
+    int pairs = 0;
+    for (size_t i = 0; i < Peregrine::loop_end(ps, nullptr); ++i) {
+        auto a = Peregrine::loop_item(ps, i, nullptr);
+        for (size_t j = 0; j < Peregrine::loop_end(ps, nullptr); ++j) {
+            auto b = Peregrine::loop_item(ps, j, nullptr);
+            pairs += a.____mem____P____P____x <= b.____mem____P____P____x;
+        }
+    }
+    CHECK(pairs == 10);
+    double total = 0;
+    auto& xs = ps.____mem____P____P____x;
+    for (size_t i = 0; i < Peregrine::loop_end(xs, nullptr); ++i) {
+        total += Peregrine::loop_item(xs, i, nullptr);
+    }
+    CHECK(total == 10.0);
+    ps.____mem____P____P____clear();
+    CHECK(ps.____mem____P____P____len() == 0);
+}
+
+TEST_SUITE_END();